@@ -0,0 +1,120 @@
+# checkdelta.py - round trip test of --output-format=delta
+#
+# Runs the lambda outline with --output-format=binary and again with
+# --output-format=delta, and checks that readDelta() gives what
+# readBinary() does, bit for bit and row for row: the whole run, and
+# windows starting on, before and after the first row of a block.
+# The runs are checked to hold negative changes (the zig-zag), jumps
+# of more than two bytes in a count and of the full 64 bits of a
+# double, and many blocks.
+#
+# Usage: python checkdelta.py [simulac]   (make check in src runs it)
+
+import os
+import sys
+import shutil
+import tempfile
+import subprocess
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from simulac import readBinary, readDelta
+
+# The runs: options, and the rows between keyframes
+Runs = [
+    ("--moi=3 Outline.Lambda 600 1 3", 64),
+    ("--moi=5 --pops Outline.Lambda 300 1 5", 7),
+    ("--moi=2 Outline.Lambda 200 2 7", 1),
+    ("--moi=3 Outline.Lambda 3000 100 3", 4),
+    ("--moi=3 --stop=lyso:CI>6 Outline.Lambda 3000 10 3", 3),
+]
+
+# What the runs have held, between them
+Cover = {'negative': False, 'count past 2 bytes': False,
+         'double of 9 bytes or more': False, 'many blocks': False}
+
+# Bits of each column, in order of their offsets, as uint64
+def columnBits(data):
+    names = sorted(data.dtype.names, key=lambda c: data.dtype.fields[c][1])
+    cols = []
+    for c in names:
+        if (data.dtype[c].kind == 'f'):
+            cols.append(np.ascontiguousarray(data[c]).view(np.uint64))
+        else:
+            cols.append(data[c].astype(np.int64).view(np.uint64))
+    return np.column_stack(cols)
+
+# Bytes of the varint of each change from the row before, in blocks of
+# keyframe rows, and the changes themselves
+def varintBytes(bits, keyframe):
+    prev = np.zeros_like(bits)
+    prev[1:] = bits[:-1]
+    prev[::keyframe] = 0
+    delta = (bits - prev).view(np.int64)
+    z = (delta << 1) ^ (delta >> 63)
+    nbytes = np.ones(z.shape, dtype=int)
+    z = z.view(np.uint64) >> np.uint64(7)
+    while (z.any()):
+        nbytes += (z != 0)
+        z >>= np.uint64(7)
+    return (nbytes, delta)
+
+# The same columns, bit for bit (numpy leaves the padding of a record
+# as it finds it)
+def same(a, b):
+    return (a.dtype == b.dtype and a.shape == b.shape and
+            all([a[c].tobytes() == b[c].tobytes() for c in a.dtype.names]))
+
+def check(simulac, options, keyframe, dir):
+    binary = os.path.join(dir, "run.bin")
+    delta = os.path.join(dir, "run.delta")
+    for (format, file) in (("binary", binary), ("delta", delta)):
+        subprocess.check_call([simulac, "-d", "0", "--output-format=" + format,
+                               "--keyframe=%d" % keyframe, "-o", file] +
+                              options.split(), stderr=open(os.devnull, 'w'))
+    (b, bmeta) = readBinary(binary)
+    (d, dmeta) = readDelta(delta)
+    n = b.shape[0]
+    ok = same(np.array(b), d) and bmeta == dmeta
+
+    # Windows about the first rows of the blocks, and past the end
+    for start in sorted(set([0, 1, n - 1, n, n + 5] +
+                            [k * keyframe + o for k in range(1, 6)
+                             for o in (-1, 0, 1)])):
+        if (start < 0): continue
+        for count in (1, keyframe, keyframe + 1, None):
+            (w, meta) = readDelta(delta, start, count)
+            end = n if count == None else min(n, start + count)
+            ok = ok and same(np.array(b[start:end]), w)
+
+    # What the run held
+    (nbytes, change) = varintBytes(columnBits(np.array(b)), keyframe)
+    names = sorted(b.dtype.names, key=lambda c: b.dtype.fields[c][1])
+    ints = [i for (i, c) in enumerate(names) if b.dtype[c].kind == 'i']
+    doubles = [i for (i, c) in enumerate(names) if b.dtype[c].kind == 'f']
+    later = np.arange(n) % keyframe != 0
+    Cover['negative'] |= bool((change[later][:, ints] < 0).any())
+    Cover['count past 2 bytes'] |= bool((nbytes[:, ints] > 2).any())
+    Cover['double of 9 bytes or more'] |= bool((nbytes[:, doubles] >= 9).any())
+    Cover['many blocks'] |= n > 4 * keyframe
+
+    print("%s %s, keyframe %d: %d rows, %d columns" %
+          ("ok    " if ok else "FAILED", options, keyframe, n,
+           len(b.dtype.names)))
+    return ok
+
+simulac = os.path.abspath(sys.argv[1] if len(sys.argv) > 1 else
+                          os.path.join(os.path.dirname(__file__),
+                                       "../../../src/Simulac"))
+os.chdir(os.path.join(os.path.dirname(os.path.abspath(__file__)), "../config"))
+dir = tempfile.mkdtemp()
+try:
+    ok = all([check(simulac, options, keyframe, dir)
+              for (options, keyframe) in Runs])
+finally:
+    shutil.rmtree(dir)
+for case in sorted(Cover):
+    if (not Cover[case]):
+        print("FAILED no run had a case of: %s" % case)
+        ok = False
+sys.exit(0 if ok else 1)
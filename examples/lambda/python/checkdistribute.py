@@ -0,0 +1,108 @@
+# checkdistribute.py - check of --coordinator and --worker on localhost
+#
+# Starts a coordinator on a free local port with the runs below and a
+# worker, kills the worker once the first run is done, with more of
+# its runs in flight, and then starts three others.  The coordinator
+# must say that it gave the runs of the lost worker to the others,
+# answer every run "done", and every output file must be the same,
+# byte for byte, as that of the run made directly.  A coordinator
+# still waiting after Timeout seconds has lost runs, and is killed.
+#
+# Usage: python checkdistribute.py [simulac]   (make check in src runs it)
+
+import os
+import sys
+import socket
+import shutil
+import tempfile
+import threading
+import subprocess
+
+# Options of the coordinator, the workers and the direct runs
+Common = ["-d", "0", "--moi=3", "--pops"]
+Outline = ["Outline.Lambda", "600", "10"]
+Timeout = 300
+
+# The runs: seed, then the settings of the spec (as options)
+Runs = [(3 + i // 4,
+         ["--trajectory=%d" % (i % 4)] +
+         (["--volume=0.8"] if i % 3 == 1 else []) +
+         (["--rate=k3=0.37"] if i % 5 == 2 else []) +
+         (["--init=CI=20"] if i % 7 == 3 else []))
+        for i in range(16)]
+
+# A local port that is free, as far as can be told
+def freePort():
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.bind(("127.0.0.1", 0))
+    port = s.getsockname()[1]
+    s.close()
+    return port
+
+def worker(simulac, port, log):
+    return subprocess.Popen([simulac] + Common +
+                            ["--worker=127.0.0.1:%d" % port,
+                             "--threads=1", "-l", log] + Outline,
+                            stdout=open(os.devnull, 'w'))
+
+def same(a, b):
+    return open(a, 'rb').read() == open(b, 'rb').read()
+
+def check(simulac, dir):
+    port = freePort()
+    coordinator = subprocess.Popen([simulac] + Common +
+                                   ["--coordinator=127.0.0.1:%d" % port,
+                                    "-l", os.path.join(dir, "coordinator.log")] +
+                                   Outline,
+                                   stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                   universal_newlines=True)
+    for (i, (seed, options)) in enumerate(Runs):
+        coordinator.stdin.write(" ".join(["output=" + os.path.join(dir, "net.%d" % i),
+                                          "seed=%d" % seed] + options) + "\n")
+    coordinator.stdin.close()
+    watchdog = threading.Timer(Timeout, coordinator.kill)
+    watchdog.start()
+
+    # The first worker goes away with runs in flight
+    workers = [worker(simulac, port, os.path.join(dir, "worker0.log"))]
+    answers = [coordinator.stdout.readline().strip()]
+    workers[0].kill()
+    workers[0].wait()
+    workers += [worker(simulac, port, os.path.join(dir, "worker%d.log" % k))
+                for k in range(1, 4)]
+    answers += [line.strip() for line in coordinator.stdout]
+    ok = coordinator.wait() == 0
+    watchdog.cancel()
+    for w in workers[1:]:
+        if (not ok): w.kill()
+        ok = w.wait() == 0 and ok
+
+    log = open(os.path.join(dir, "coordinator.log")).read()
+    lost = "lost worker" in log
+    print("%s a lost worker's runs were given to the others" %
+          ("ok    " if lost else "FAILED"))
+    ok = ok and lost
+
+    for (i, (seed, options)) in enumerate(Runs):
+        net = os.path.join(dir, "net.%d" % i)
+        direct = os.path.join(dir, "direct.%d" % i)
+        subprocess.check_call([simulac] + Common + options + ["-o", direct] +
+                              Outline + [str(seed)],
+                              stderr=open(os.devnull, 'w'))
+        good = ("done " + net in answers and os.path.exists(net) and
+                same(net, direct))
+        print("%s seed %d %s" % ("ok    " if good else "FAILED", seed,
+                                 " ".join(options)))
+        ok = ok and good
+    return ok
+
+simulac = os.path.abspath(sys.argv[1] if len(sys.argv) > 1 else
+                          os.path.join(os.path.dirname(__file__),
+                                       "../../../src/Simulac"))
+os.chdir(os.path.join(os.path.dirname(os.path.abspath(__file__)), "../config"))
+dir = tempfile.mkdtemp()
+try:
+    ok = check(simulac, dir)
+finally:
+    shutil.rmtree(dir)
+sys.exit(0 if ok else 1)
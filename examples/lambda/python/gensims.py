@@ -19,6 +19,11 @@ Trial0 = 0
 Volumes = linspace(0.4, 1.8, Nvolumes)
 Labels = ['a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j']
 Subdir = "."
+Ensemble = 0            # run the trials of a volume as one ensemble
+Threads = 0             # threads per ensemble (0 = one per processor)
+Target = None           # run an ensemble until this statistic is known
+HalfWidth = 0.05        #   to within this (Ntrials is then the most to run)
+Stats = 0               # keep only the statistics of an ensemble
 
 #
 # Read command line arguments for additional information
@@ -26,12 +31,15 @@ Subdir = "."
 
 # Define a function to print out usage information
 def usage():
-    print "Usage: python gensims.py"
+    print "Usage: python gensims.py [-s subdir] [-e] [-t threads]",
+    print "[-T target] [-w half-width] [-S]"
     return;
 
 # Command line processing using getopt
 try:                                
-    opts, args = getopt.getopt(sys.argv[1:], "hs:", ["help", "subdir="]) 
+    opts, args = getopt.getopt(sys.argv[1:], "hs:et:T:w:S",
+                               ["help", "subdir=", "ensemble", "threads=",
+                                "target=", "half-width=", "stats"]) 
 except getopt.GetoptError, err:
     print(err); usage();
     sys.exit(2)   
@@ -43,6 +51,16 @@ for opt, arg in opts:
         sys.exit()                  
     elif opt in ("-s", "--subdir"): 
         Subdir = arg
+    elif opt in ("-e", "--ensemble"):
+        Ensemble = 1
+    elif opt in ("-t", "--threads"):
+        Threads = int(arg)
+    elif opt in ("-T", "--target"):
+        Ensemble = 1; Target = arg
+    elif opt in ("-w", "--half-width"):
+        HalfWidth = float(arg)
+    elif opt in ("-S", "--stats"):
+        Ensemble = 1; Stats = 1
 
 # Generate a log file indicating what we are doing
 logfp = open(Subdir + "/gensims.log", "a");
@@ -52,6 +70,34 @@ logfp.write("%s: Nvolumes=%d, Ntrials=%d, Trial0=%d\n" %
 
 # Run a bunch of simulations for different cell volumes
 for i in range(Volumes.size):
+    if (Ensemble):
+        # Parse the model once and run all the trials of this volume
+        prefix = Subdir + "/lambda-" + Labels[i]
+        logfp.write("%s:   volume=%g, trials=%d -> %s.N\n" % 
+                    (time.asctime(), Volumes[i], Ntrials, prefix));
+        logfp.flush();
+
+        options = ""
+        if (Target != None):
+            options = " --target=" + Target + " --half-width=" + str(HalfWidth)
+        if (Stats):
+            # Statistics go to prefix.mean, prefix.var, ... (see readStats())
+            options += " --stats --stats-only"
+
+        system("Simulac -v " + str(Volumes[i]) +
+               " --config-file=" + Subdir + "/lambda.cfg" + 
+               " --python-setup=" + Subdir + "/" + "lambda_setup.py" +
+               " --ensemble=" + str(Ntrials) + " --threads=" + str(Threads) +
+               " --trajectory=" + str(Trial0) + options +
+               " -o " + prefix + " -d 3 -l " + prefix + ".log");
+
+        # Give the files the names of separate runs (fewer with a target)
+        for trial in range(Ntrials):
+            if (not os.path.exists(prefix + "." + str(trial))): break
+            os.rename(prefix + "." + str(trial),
+                      prefix + str(trial+Trial0) + ".dat")
+        continue
+
     for trial in range(Ntrials):
 
         # Create the file name for the simulation
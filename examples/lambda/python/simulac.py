@@ -6,9 +6,12 @@ import os                       # operating system calls
 import re                       # regular expressions library
 import numpy as np              # numerical library
 
-# Functions to import
-from matplotlib.pyplot import plot, errorbar, axis, hold, legend
-from ciplot import ciplot       # confidence interval plot
+# Functions to import; the readers work without them (see checkdelta.py)
+try:
+    from matplotlib.pyplot import plot, errorbar, axis, hold, legend
+    from ciplot import ciplot   # confidence interval plot
+except ImportError:
+    pass
 
 #
 # Functions for reading simulac data sets
@@ -74,37 +77,189 @@ def readSetConfiguration(path=None, setupFile="simulac_setup.py"):
 # Load the data from a directory
 def readSetData(path=".", datafile_regexp=".*\.dat"):
     # Load each of the data files in the directory
-    nfiles = 0; runlength = 0; varcount = 0; setdata = None;
+    runs = []; runlength = 0; varcount = 0;
     for file in os.listdir(path):
         # Skip files that are not of the right form
         if (re.search(datafile_regexp, file) == None):
             continue;
 
-        # Load the results of the simulation and store as 3-dim array
+        # Load the results of the simulation
         simdata = np.loadtxt(path + "/" + file, comments='%')
-        rundata = np.reshape(simdata, (1, simdata.shape[0], simdata.shape[1]));
-        ++nfiles;
 
-        # Store the data in an ndarray for later access
+        # Store the data in a list for later access
         if (runlength == 0):
-            # For the initial run, just save the data
-            setdata = rundata;
-
             # Store the length of the run and number of variables
             runlength = simdata.shape[0];
             varcount = simdata.shape[1];
+            runs.append(simdata);
 
+        # Make sure the data is the same length
+        elif (simdata.shape[0] != runlength):
+            print("%s: run length mismatch; skipping file" % file);
+        elif (simdata.shape[1] != varcount):
+            print("%s: variable count mismatch; skipping file" % file);
         else:
-            # Make sure the data is the same length
-            if (simdata.shape[0] != runlength):
-                print("%s: run length mismatch; skipping file" % file);
-            elif (simdata.shape[1] != varcount):
-                print("%s: variable count mismatch; skipping file" % file);
+            runs.append(simdata);
+
+    # Store the runs as one ndarray (n = 3), stacked once at the end
+    if (len(runs) == 0): return None
+    return np.array(runs)
+
+# Read the statistics an ensemble took with --stats (output-file.STAT)
+# as a dictionary of arrays shaped like a run: 'mean', 'var', 'min',
+# 'max' and 'q5', 'q50', ... for the quantiles, with 'n' the number of
+# trajectories at each time and 'hist' the histograms, if any
+def readStats(prefix):
+    stats = {}
+    dir = os.path.dirname(prefix) or "."
+    base = os.path.basename(prefix)
+    for file in os.listdir(dir):
+        m = re.match(re.escape(base) + "\\.(mean|var|min|max|q[0-9.]+|n|hist)$",
+                     file)
+        if (m != None):
+            stats[m.group(1)] = np.loadtxt(dir + "/" + file, comments='%', 
+                                           ndmin=2)
+    return stats
+
+# Read the runs simulac-reduce -c wrote to a columns file: the names of
+# the columns and a list of the runs, each an array of rows like the
+# output of np.loadtxt(), mapped into memory rather than read
+def readColumns(file):
+    magic = open(file, 'rb').read(8)
+    if (magic != b'SIMCOLS1'):
+        print("%s: not a columns file" % file)
+        return None
+    (ncols, nruns) = np.fromfile(file, dtype='<u4', count=2, offset=8)
+    names = [name.decode() for name in 
+             np.fromfile(file, dtype='S32', count=ncols, offset=16)]
+    rows = np.fromfile(file, dtype='<u8', count=nruns+1, offset=16+32*ncols)
+    data = np.memmap(file, dtype='<f8', mode='r', 
+                     offset=16+32*ncols+8*(nruns+1))
+
+    # Each run is its columns one after the other
+    runs = []
+    for k in range(nruns):
+        n = int(rows[k+1] - rows[k])
+        runs.append(data[ncols*rows[k]:ncols*rows[k+1]].reshape(ncols, n).T)
+    return (names, runs)
+
+# Read the header of a binary or delta output: a dictionary of its
+# format ('magic'), where its rows start ('start'), the bytes of a
+# record or rows of a block ('unit'), its rows ('rows', None if it
+# doesn't say), the dtype of a record ('record') and its metadata
+# ('meta'), with the fate of the run ('fate' and 'fate_time') if a
+# stop condition decided it
+def readOutputHeader(file):
+    magic = open(file, 'rb').read(8)
+    head = np.fromfile(file, dtype='<u4', count=6)
+    (start, unit, ncols, mbytes) = [int(x) for x in head[2:6]]
+    nrows = int(np.fromfile(file, dtype='<u8', count=1, offset=24)[0])
+    (fate, complete) = np.fromfile(file, dtype='<i4', count=2, offset=32)
+    columns = np.fromfile(file, offset=48, count=ncols,
+                          dtype=[('name', 'S32'), ('type', 'S4'),
+                                 ('offset', '<u4')])
+    types = [t.decode() for t in columns['type']]
+    offsets = [int(o) for o in columns['offset']]
+    if (magic == b'SIMROWS1'):
+        itemsize = unit
+    else:
+        itemsize = (max(offsets) + 4 + 7) // 8 * 8
+    record = np.dtype({'names': [c.decode() for c in columns['name']],
+                       'formats': types, 'offsets': offsets,
+                       'itemsize': itemsize})
+
+    # Lines of "name = value" after the columns
+    meta = {}
+    text = open(file, 'rb').read(48 + 40*ncols + mbytes)[48 + 40*ncols:]
+    for line in text.decode().splitlines():
+        (name, value) = line.split(" = ", 1)
+        meta[name] = value
+    if (fate >= 0):
+        meta['fate'] = meta['fates'].split()[fate]
+        meta['fate_time'] = float(np.fromfile(file, dtype='<f8', count=1,
+                                              offset=40)[0])
+
+    # A run that hasn't ended, or was written to a pipe, runs to the end
+    if (not complete): nrows = None
+    return {'magic': magic, 'start': start, 'unit': unit, 'rows': nrows,
+            'record': record, 'meta': meta}
+
+# Read a run written with --output-format=binary: its records, a
+# structured array of the columns by name mapped into memory, and a
+# dictionary of its metadata (see readOutputHeader()).  The array of
+# rows np.loadtxt() would give is np.column_stack([data[c] for c in
+# data.dtype.names]).
+def readBinary(file):
+    if (open(file, 'rb').read(8) != b'SIMROWS1'):
+        print("%s: not a binary output" % file)
+        return None
+    head = readOutputHeader(file)
+    record = head['record']
+    nrecords = head['rows']
+    if (nrecords == None):
+        nrecords = (os.path.getsize(file) - head['start']) // head['unit']
+    if (nrecords == 0): return (np.zeros(0, dtype=record), head['meta'])
+    data = np.memmap(file, dtype=record, mode='r', offset=head['start'],
+                     shape=(nrecords,))
+    return (data, head['meta'])
+
+# Decode the zig-zag varints of buffer into an array of uint64
+def decodeVarints(buffer):
+    b = np.frombuffer(buffer, dtype=np.uint8)
+    starts = np.concatenate(([True], b[:-1] < 0x80))
+    first = np.flatnonzero(starts)
+    shift = np.arange(len(b)) - first[np.cumsum(starts) - 1]
+    z = np.add.reduceat((b & 0x7f).astype(np.uint64) <<
+                        (7*shift).astype(np.uint64), first)
+    return (z >> np.uint64(1)) ^ (np.uint64(0) - (z & np.uint64(1)))
+
+# Read rows first to first+count (to the end if count is None) of a run
+# written with --output-format=delta, as readBinary() does but into
+# memory.  The blocks before them are hopped over, not decoded.
+def readDelta(file, first=0, count=None):
+    if (open(file, 'rb').read(8) != b'SIMDELT1'):
+        print("%s: not a delta output" % file)
+        return None
+    head = readOutputHeader(file)
+    record = head['record']
+    names = sorted(record.names, key=lambda c: record.fields[c][1])
+    ncols = len(names)
+
+    # Hop to the block of the first row, then decode up to the last
+    data = open(file, 'rb').read()
+    at = head['start']
+    row = 0
+    blocks = []
+    while (at + 8 <= len(data) and (count == None or row < first + count)):
+        (nbytes, nrows) = np.frombuffer(data, dtype='<u4', count=2, offset=at)
+        if (at + 8 + nbytes > len(data)): break
+        if (row + nrows > first):
+            z = decodeVarints(data[at+8:at+8+nbytes]).reshape(nrows, ncols)
+            blocks.append((row, np.cumsum(z, axis=0, dtype=np.uint64)))
+        row += int(nrows)
+        at += 8 + int(nbytes)
+
+    # The columns, in order of their offsets, are the bits of each value
+    rows = np.zeros(0, dtype=record)
+    if (len(blocks) > 0):
+        values = np.concatenate([v for (r, v) in blocks])
+        values = values[first - blocks[0][0]:]
+        if (count != None): values = values[:count]
+        rows = np.zeros(values.shape[0], dtype=record)
+        for i in range(ncols):
+            if (record.fields[names[i]][0].kind == 'f'):
+                rows[names[i]] = values[:,i].view('<f8')
             else:
-                # Store the data as ndarrays (n = 3)
-                setdata = np.concatenate((setdata, rundata));
-                
-    return setdata
+                rows[names[i]] = values[:,i].view('<i8')
+    return (rows, head['meta'])
+
+# Read the fate a run was stopped with (--stop): (fate, time), or None
+def readFate(file):
+    for line in open(file):
+        m = re.match("% fate (\\S+) (\\S+)", line)
+        if (m != None):
+            return (m.group(1), float(m.group(2)))
+    return None
 
 #
 # Functions for reading simulac configuration files
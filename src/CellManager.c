@@ -10,6 +10,10 @@
 /****************************/
 
 #include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 
 #ifndef _H_STDIO
    #include <stdio.h>
@@ -19,6 +23,10 @@
    #include <stdlib.h>
 #endif
 
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
 #ifndef _H_MATH
    #include <math.h>
 #endif
@@ -35,6 +43,14 @@
  #include "Memory.h"
 #endif
 
+#ifndef RANDOM
+ #include "Rng.h"
+#endif
+
+#ifndef OUTPUT
+ #include "Output.h"
+#endif
+
 /******************************/
 /******* Submission ***********/
 /******************************/
@@ -49,13 +65,16 @@ void SubmitCellReactions()
   void SubmitReaction();
   void MassAction();
 
-  if(EColi->GrowthRate== 0.0) return;
+  if(Sim->EColi->GrowthRate== 0.0) return;
+
+  /* A continuously growing cell divides through SelectReaction() */
+  if(Sim->EColi->Continuous) return;
 
 
   reaction= (REACTION *)   AllocReaction();
   reaction->Type=          Reaction_Type_ChangeCellVolume;
   reaction->ReactionFunc=  Balloon;
-  reaction->Probability=   EColi->GrowthRate;    
+  reaction->Probability=   Sim->EColi->GrowthRate;    
   reaction->ReactionData=  NULL;
   SubmitReaction(reaction);
 
@@ -64,127 +83,224 @@ void SubmitCellReactions()
 void Balloon(rdata)
 void *rdata;
 {
-  int i;
-  static long idum= -12;
-  float bnldev();
+  void DivideCell();
 
 
-  EColi->V += 1e-18;
+  Sim->EColi->V += 1e-18;
 
-  if((EColi->V/EColi->VI) >= 2.0){ /* Then Time to Divide */
-    EColi->V /= 2.0;
+  if((Sim->EColi->V/Sim->EColi->VI) >= 2.0) /* Then Time to Divide */
+    DivideCell();
+    
+}
 
-    /* Binomial Partition of Chemical Species */
+void DivideCell()
+{
+  void SplitCell();
 
-    for(i=0; i<NSpecies; i++)
-      Concentration[i]=(int)bnldev(0.5,Concentration[i],&idum);
+  if(Sim->EColi->Generation < Sim->EColi->MaxGeneration){
+    SplitCell();
+    return;
   }
-    
+
+  Sim->EColi->V /= 2.0;
+
+  /* Binomial Partition of Chemical Species */
+
+  RandomPartition(NSpecies,Sim->Concentration,0.5,Sim->Concentration);
 }
 
+/**************************
+ *
+ * Lineage mode: at division the process forks, and parent and child
+ * go on as the two daughters, so that every cell of the colony is
+ * followed and the cells run in parallel.  Cell n divides into cells
+ * 2n+1 (the parent process) and 2n+2 (the child).  Each cell writes
+ * its own output file, and every birth is recorded as a line
+ * "cell parent time" in the lineage file.
+ *
+ * At most "cells" cells run at once.  They share a pipe holding a
+ * token for each place beyond the founder's.  A dividing cell that
+ * takes a token forks a daughter that runs alongside it and hands the
+ * token back when it exits.  When there is none the mother lends her
+ * own place: she waits for the daughter's subtree to finish before
+ * going on.  Live processes are thus at most cells*(generations+1),
+ * while n generations still cost 2^n cells, each with its own output
+ * file.
+ *
+ **************************/
 
-#define PI 3.141592654
+static int LineageFd= -1;
+static int Place[2]= {-1,-1};   /* The token pipe */
+static int OwnsPlace= 0;        /* This cell took a token when it was forked */
 
-float bnldev(pp,n,idum)
-float pp;
-int n;
-long *idum;
+/* Open the lineage file, record the founding cell and make the places */
+void StartLineage(name,cells)
+char *name;
+int cells;
 {
-	double gammln();
-	float ran1();
-	int j;
-	static int nold=(-1);
-	float am,em,g,angle,p,bnl,sq,t,y;
-	static float pold=(-1.0),pc,plog,pclog,en,oldg;
-
-	p=(pp <= 0.5 ? pp : 1.0-pp);
-	am=n*p;
-	if (n < 25) {
-		bnl=0.0;
-		for (j=1;j<=n;j++)
-			if (ran1(idum) < p) ++bnl;
-	} else if (am < 1.0) {
-		g=exp(-am);
-		t=1.0;
-		for (j=0;j<=n;j++) {
-			t *= ran1(idum);
-			if (t < g) break;
-		}
-		bnl=(j <= n ? j : n);
-	} else {
-		if (n != nold) {
-			en=n;
-			oldg= (float) gammln(en+1.0);
-			nold=n;
-		} if (p != pold) {
-			pc=1.0-p;
-			plog=log(p);
-			pclog=log(pc);
-			pold=p;
-		}
-		sq=sqrt(2.0*am*pc);
-		do {
-			do {
-				angle=PI*ran1(idum);
-				y=tan(angle);
-				em=sq*y+am;
-			} while (em < 0.0 || em >= (en+1.0));
-			em=floor(em);
-			t=1.2*sq*(1.0+y*y)*exp(oldg-gammln(em+1.0)
-				-gammln(en-em+1.0)+em*plog+(en-em)*pclog);
-		} while (ran1(idum) > t);
-		bnl=em;
-	}
-	if (p != pp) bnl=n-bnl;
-	return bnl;
+  char line[64];
+
+  if((LineageFd= open(name,O_WRONLY|O_CREAT|O_TRUNC|O_APPEND,0666)) < 0){
+    perror(name);
+    exit(1);
+  }
+  sprintf(line,"%d\t%d\t%e\n",Sim->EColi->id,-1,0.0);
+  write(LineageFd,line,strlen(line));
+
+  if(cells<=0) cells= (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if(pipe(Place) < 0 || fcntl(Place[0],F_SETFL,O_NONBLOCK) < 0){
+    perror(progid);
+    exit(1);
+  }
+  for(; cells>1; cells--)
+    write(Place[1],"",1);
 }
-#undef PI
-
-#define IA 16807
-#define IM 2147483647
-#define AM (1.0/IM)
-#define IQ 127773
-#define IR 2836
-#define NTAB 32
-#define NDIV (1+(IM-1)/NTAB)
-#define EPS 1.2e-7
-#define RNMX (1.0-EPS)
-
-float ran1(idum)
-long *idum;
+
+/* Take a token if one is free; the pipe never blocks */
+static int TakePlace()
 {
-	int j;
-	long k;
-	static long iy=0;
-	static long iv[NTAB];
-	float temp;
-
-	if (*idum <= 0 || !iy) {
-		if (-(*idum) < 1) *idum=1;
-		else *idum = -(*idum);
-		for (j=NTAB+7;j>=0;j--) {
-			k=(*idum)/IQ;
-			*idum=IA*(*idum-k*IQ)-IR*k;
-			if (*idum < 0) *idum += IM;
-			if (j < NTAB) iv[j] = *idum;
-		}
-		iy=iv[0];
-	}
-	k=(*idum)/IQ;
-	*idum=IA*(*idum-k*IQ)-IR*k;
-	if (*idum < 0) *idum += IM;
-	j=iy/NDIV;
-	iy=iv[j];
-	iv[j] = *idum;
-	if ((temp=AM*iy) > RNMX) return RNMX;
-	else return temp;
+  char token;
+
+  return(Place[0]>=0 && read(Place[0],&token,1)==1);
+}
+
+/*
+ * Divide into two cells.  Species are split binomially and every free
+ * transcript and every copy of a sequence that follows the MOI goes
+ * to one daughter or the other; RNAPs and nascent transcripts leave
+ * with their DNA.  The split is drawn before the fork so that the
+ * two daughters get complementary shares.
+ */
+void SplitCell()
+{
+  int i,j,n,parent,sister,own;
+  int *keep;
+  char *tkeep,**ckeep,line[128];
+  pid_t pid;
+  mRNA *trans,*next;
+  SEQTEMPLATE *tmpl;
+  SEQUENCE **copies;
+  void OpenCellOutput();
+  void GiveAwayTranscript();
+  void GiveAwaySequenceCopy();
+
+  keep= (int *) rcalloc(NSpecies,sizeof(int),"SplitCell");
+  RandomPartition(NSpecies,Sim->Concentration,0.5,keep);
+
+  tkeep= (char *) rcalloc(Sim->NTranscripts+1,sizeof(char),"SplitCell");
+  for(i=0; i<Sim->NTranscripts; i++)
+    tkeep[i]= (RngUniform(Sim->Rng) < 0.5);
+
+  ckeep= (char **) rcalloc(NSeqTemplates,sizeof(char *),"SplitCell");
+  for(i=0; i<NSeqTemplates; i++){
+    tmpl= SeqTemplate[i];
+    if(!tmpl->FollowsMOI) continue;
+    ckeep[i]= (char *) rcalloc(Sim->Copies[i].NCopies+1,sizeof(char),"SplitCell");
+    for(j=0; j<Sim->Copies[i].NCopies; j++)
+      ckeep[i][j]= (RngUniform(Sim->Rng) < 0.5);
+  }
+
+  /*
+   * The mother's output ends here, before the daughters share it, and
+   * otherwise buffered output would be written by both of them
+   */
+  if(Sim->Output!=NULL) EndOutput(-1,0.0);
+  fflush(NULL);
+
+  own= TakePlace();
+  if((pid= fork()) < 0){
+    perror(progid);
+    exit(-1);
+  }
+
+  parent= Sim->EColi->id;
+  if(pid==0){
+    OwnsPlace= own;
+    /* The child is the second daughter and takes the other share */
+    Sim->EColi->id= 2*parent+2;
+    for(i=0; i<NSpecies; i++)
+      keep[i]= Sim->Concentration[i]-keep[i];
+    for(i=0; i<Sim->NTranscripts; i++)
+      tkeep[i]= !tkeep[i];
+    for(i=0; i<NSeqTemplates; i++)
+      if(ckeep[i]!=NULL)
+	for(j=0; j<Sim->Copies[i].NCopies; j++)
+	  ckeep[i][j]= !ckeep[i][j];
+  } else
+    Sim->EColi->id= 2*parent+1;
+
+  /* Each cell of the lineage draws from a substream of its own */
+  RngSubstream(Sim->Rng,(unsigned long) Sim->EColi->id);
+  sister= (pid==0 ? 2*parent+1 : 2*parent+2);
+
+  for(i=0; i<NSpecies; i++)
+    Sim->Concentration[i]= keep[i];
+
+  for(i=0, trans=Sim->Transcript; trans!=NULL; i++, trans=next){
+    next= trans->NextTranscript;
+    if(!tkeep[i]) GiveAwayTranscript(trans);
+  }
+
+  /* Giving a copy away reorders the copies, so work from a list */
+  for(i=0; i<NSeqTemplates; i++){
+    if(ckeep[i]==NULL) continue;
+    n= Sim->Copies[i].NCopies;
+    copies= (SEQUENCE **) rcalloc(n+1,sizeof(SEQUENCE *),"SplitCell");
+    for(j=0; j<n; j++) copies[j]= Sim->Copies[i].Copy[j];
+    for(j=0; j<n; j++)
+      if(!ckeep[i][j]) GiveAwaySequenceCopy(copies[j]);
+    free(copies);
+    free(ckeep[i]);
+  }
+  free(ckeep);
+  free(tkeep);
+  free(keep);
+
+  Sim->EColi->V /= 2.0;
+  Sim->EColi->Generation++;
+
+  if(pid!=0){
+    sprintf(line,"%d\t%d\t%e\n%d\t%d\t%e\n",
+	    Sim->EColi->id,parent,Sim->Time,sister,parent,Sim->Time);
+    write(LineageFd,line,strlen(line));
+
+    /* Without a place of her own the daughter runs in her mother's */
+    if(!own)
+      while(waitpid(pid,NULL,0) < 0 && errno==EINTR);
+  }
+
+  if (DebugLevel > 1)
+    fprintf(logfp, "Cell %d divided at %g; now cell %d\n", parent, Sim->Time, Sim->EColi->id);
+
+  OpenCellOutput(Sim->EColi->id);
+}
+
+/*
+ * Wait until the daughters forked by this cell have finished, then
+ * hand back the place the cell took, if it took one
+ */
+void WaitForDaughters()
+{
+  while(wait(NULL) > 0 || errno==EINTR);
+  if(OwnsPlace) write(Place[1],"",1);
+}
+
+/* 
+ * Bring the volume of a continuously growing cell up to time t.
+ * The cell never grows past its division volume; division itself
+ * is an event returned by SelectReaction().
+ */
+void GrowCell(t)
+double t;
+{
+  double v;
+
+  if(!Sim->EColi->Continuous) return;
+
+  if(t>Sim->EColi->TV){
+    v= Sim->EColi->V + Sim->EColi->GrowthRate*1e-18*(t-Sim->EColi->TV);
+    if(v > 2.0*Sim->EColi->VI) v= (Sim->EColi->V > 2.0*Sim->EColi->VI ? Sim->EColi->V : 2.0*Sim->EColi->VI);
+    Sim->EColi->V=  v;
+    Sim->EColi->TV= t;
+  }
 }
-#undef IA
-#undef IM
-#undef AM
-#undef IQ
-#undef IR
-#undef NTAB
-#undef NDIV
-#undef EPS
-#undef RNMX
@@ -16,10 +16,18 @@
 
 #define DataStructures
 
+#ifndef _H_STDIO
+  #include <stdio.h>
+#endif
+
 #ifndef _H_STDLIB
   #include <stdlib.h>
 #endif
 
+#ifndef RANDOM
+  #include "Rng.h"
+#endif
+
 /***********************
  *
  * Simulation Object Types
@@ -35,6 +43,18 @@ typedef struct ackersshea SHEADATA;
 typedef struct reaction   REACTION;
 typedef struct ribosome   RIBOSOME;
 typedef struct cell       CELL;
+typedef struct rnapindex  RNAPINDEX;
+typedef struct sequence   SEQUENCE;
+typedef struct opergroup  OPERGROUP;
+typedef struct idleinit   IDLEINIT;
+typedef struct segtemplate SEGTEMPLATE;
+typedef struct promtemplate PROMTEMPLATE;
+typedef struct seqtemplate SEQTEMPLATE;
+typedef struct seqcopies  SEQCOPIES;
+typedef struct simcontext SIMCONTEXT;
+typedef struct sample     SAMPLE;
+typedef struct bytes      BYTES;
+typedef struct rowcodec   ROWCODEC;
 
 #define LEFT  0
 #define RIGHT 1
@@ -46,8 +66,24 @@ struct rnap {
   short      Direction;
   int        CurrentPosition;
   mRNA      *Transcript;
-  RNAP      *LastRNAP;
-  RNAP      *NextRNAP;
+
+  DNA       *Segment;      /* Segment the RNAP is currently on */
+  int        AbsPosition;  /* Position along the whole sequence (see SEGTEMPLATE) */
+  int        Slot;         /* Index in the sequence's RNAPINDEX */
+};
+
+/*
+ * All of the RNAPs on one sequence, sorted by increasing AbsPosition.
+ * Absolute positions increase to the RIGHT whatever the orientation of
+ * the segment, so the polymerases adjacent to an RNAP along the DNA are
+ * RNAP[Slot-1] and RNAP[Slot+1], even when they sit on another segment.
+ */
+struct rnapindex {
+  int        NRNAPs;
+  int        MaxRNAPs;
+  RNAP     **RNAP;
+
+  int        ActiveIndex; /* Position in ActiveSequence[], -1 if there are no RNAPs */
 };
 
 #define DNA_Type_Promotor       0
@@ -56,49 +92,123 @@ struct rnap {
 #define DNA_Type_Terminator     3
 #define DNA_Type_AntiTerminator 4
 
-struct dna {
-
-  DNA         *LeftSegment;
-  DNA         *RightSegment;
-
-  CELL       *Bug;
+/*
+ * Everything that describes a segment and does not change during a
+ * run is kept once per sequence read, and shared by all the copies
+ * made of it for MOI > 1.
+ */
+struct segtemplate {
   char       *Name;
   int        Length;
   short      Direction;
 
   short      Type;
-  void       *DNAStruct;
+  int        Data;        /* Index in Promotor[] or SegmentRec[], by Type */
 
+  int        Left;        /* Index of the neighbouring segments in Segment[], */
+  int        Right;       /* -1 at the ends of the sequence */
+
+  int        Offset;      /* Nucleotides to the left of this segment in its sequence */
 };
 
-struct promotor {
-  int          Data;
+/* A segment on one copy of a sequence */
+struct dna {
+  SEQUENCE    *Seq;       /* Copy holding this segment */
+  SEGTEMPLATE *T;
+};
+
+#define LEFT_SEGMENT(dna)  ((dna)->T->Left<0  ? NULL : &(dna)->Seq->Segment[(dna)->T->Left])
+#define RIGHT_SEGMENT(dna) ((dna)->T->Right<0 ? NULL : &(dna)->Seq->Segment[(dna)->T->Right])
+#define DNA_PROMOTOR(dna)  (&(dna)->Seq->Promotor[(dna)->T->Data])
+#define DNA_SEGMENT(dna)   (&(dna)->Seq->Template->SegmentRec[(dna)->T->Data])
+
+struct promtemplate {
   double      *IsoRate;   /* Isomerization rates for formation of OC for each config */
   short        TranscriptionDirection;
-  RNAP        *RNAPQueue;
+  char        *SheaAckers;  /* S/A file of the operators, one per copy */
+};
+
+struct promotor {
+  PROMTEMPLATE *T;
+  int          Data;      /* Operator controlling this copy of the promotor */
 #ifdef RMM_MODS
-  char        *Name;	/* Name of the promotor (for output file) */
   int RNAPCount;	/* Count the number of RNAP polymerases that go by  */
 #endif
+  DNA         *Segment;      /* DNA fragment holding this promotor */
+  int          FiringIndex;  /* Position in FiringPromotor[], -1 if it can't fire */
 };
 
 struct segment {
-  RNAP*      RNAPQueue;
   void       *SegmentData;
   void      (*SegmentFunc)();
 };
 
+/*
+ * A sequence as read from the mechanism file: the segments left to
+ * right, the promotors on them and the records for the other segment
+ * types.  None of it moves once the mechanism has been read; the
+ * copies made of it belong to a simulation context (see SEQ_COPIES()).
+ */
+struct seqtemplate {
+  int          Index;     /* Position in SeqTemplate[] */
+
+  int          NSegments;
+  SEGTEMPLATE *Segment;
+
+  int          NPromotors;
+  PROMTEMPLATE *Promotor;
+
+  int          NSegmentRecs;
+  SEGMENT     *SegmentRec;
+
+  short        FollowsMOI;  /* Number of copies set by --moi (MOI != 1 in the mechanism) */
+};
+
+/* The copies of one sequence in a simulation context */
+struct seqcopies {
+  int          NCopies;   /* Copies currently in the cell, Copy[0..NCopies-1] */
+  int          MaxCopies;
+  SEQUENCE   **Copy;      /* Every copy made; removed ones are kept for reuse */
+};
+
+#define SEQ_COPIES(tmpl) (&Sim->Copies[(tmpl)->Index])
+
+/* Separates the copy number from the name of a segment or operator */
+#ifdef RMM_MODS
+#define COPY_SEPARATOR '_'
+#else
+#define COPY_SEPARATOR '.'
+#endif
+
+/*
+ * One copy of a sequence holds only what changes during a run: its
+ * RNAPs, and the promotors through which it is tied to its operators.
+ * Segment[] and Promotor[] are in the same order as in the template.
+ * Copies are made from the template while parsing and may be added
+ * or removed later (see AddSequenceCopy()), so each is allocated on
+ * its own and Sequence[] only holds pointers to the copies in the cell.
+ */
+struct sequence {
+  SEQTEMPLATE *Template;
+  int          Copy;      /* Copy number, 0 for the first */
+
+  DNA         *Segment;
+  PROMOTOR    *Promotor;
+
+  RNAPINDEX    RNAPs;     /* RNAPs on the sequence */
+};
+
 struct ribosome {
   int        NBound;
   int        *SpeciesIndex;
 
 
   int        CurrentPosition;
-  mRNA      *Transcript;
-  RIBOSOME  *LastRibosome;
-  RIBOSOME  *NextRibosome;
 };
 
+#define RIBOSOME_AT(trans,k) \
+  (&(trans)->Ribosome[((trans)->FirstRibosome+(k))%(trans)->MaxRibosomes])
+
 #define mRNA_Type_Sense         0
 #define mRNA_Type_AntiSense     1
 
@@ -112,7 +222,21 @@ struct transcript {
   short       RBSState;
   int         CurrentLength;
   int         Type;
-  RIBOSOME   *RiboQueue;
+
+  /*
+   * Bound ribosomes are kept in a ring buffer ordered from the 5' end
+   * (RIBOSOME_AT(trans,0) is nearest the RBS) together with a bitmap
+   * of the occupied nucleotides, so that footprint and RBS checks do
+   * not have to walk the ribosomes.  Both live in one block sized by
+   * the length of the gene (see AllocLattice()).
+   */
+  int         NRibosomes;
+  int         FirstRibosome;
+  int         MaxRibosomes;
+  RIBOSOME   *Ribosome;
+  unsigned long *Occupancy;
+  int         LatticeSize;
+
   mRNA       *LastTranscript;
   mRNA       *NextTranscript;
 };
@@ -124,8 +248,38 @@ struct ackersshea {
   int       **CList;
   double     *DeltaG;
   int         CurrentState;  /* Index into configuration matrix */
+
+  int         NPromotors;    /* Promotors controlled by this operator */
+  PROMOTOR  **Promotors;
+
+  OPERGROUP  *Group;         /* Copies of this operator (see below) */
+  int         MemberIndex;   /* Position in Group->Member[] */
+};
+
+/*
+ * The copies of an operator made for MOI > 1 (the <file>_<copy>
+ * entries) are interchangeable as long as there are no RNAPs on their
+ * DNA.  Such idle copies are not sampled one by one: the group keeps
+ * the number of idle copies in each configuration, drawn jointly in
+ * SetGroupState().  A copy is made explicit again when a polymerase
+ * loads onto its DNA, and goes back to the pool when the DNA is clear.
+ */
+struct idleinit {
+  OPERGROUP  *Group;
+  int         Promotor;      /* Index in Template->Promotors[] */
+};
+
+struct opergroup {
+  SHEADATA   *Template;      /* Copy whose configurations and promotors are used, NULL if empty */
+  int         NMembers;
+  int         NIdle;         /* Member[0..NIdle-1] are idle, the rest explicit */
+  SHEADATA  **Member;
+  int        *Count;         /* Idle copies in each configuration */
+  IDLEINIT   *Init;          /* Initiation data, one per promotor of the template */
 };
 
+#define OPERATOR_IDLE(oper) ((oper)->MemberIndex < (oper)->Group->NIdle)
+
 #define Reaction_Type_Kinetic            0
 #define Reaction_Type_TransInit          1
 #define Reaction_Type_MoveRNAP           2
@@ -146,6 +300,7 @@ struct reaction {
   void      *ReactionData;
   void     (*ReactionFunc)();
   double     Probability;
+  short      VolumeOrder;  /* Probability scales as (V0/V)^VolumeOrder */
   REACTION  *LastReaction;
   REACTION  *NextReaction;
 };
@@ -171,8 +326,18 @@ struct cell {
 			     etc.
 		   */
   double V;
+  short  Continuous; /* Grow V continuously instead of in Balloon steps */
+  double TV;         /* Time at which V was last brought up to date */
+
+  int Generation;    /* Divisions since the founding cell */
+  int MaxGeneration; /* Lineage mode: both daughters are followed up to here */
 };
 
+/* Range of volume orders a reaction may carry (zeroth order is -1) */
+#define MIN_VOLUME_ORDER -1
+#define MAX_VOLUME_ORDER  4
+#define NVOLUMEORDERS (MAX_VOLUME_ORDER-MIN_VOLUME_ORDER+1)
+
 /***************************
  *
  * Object Parameter Data Types
@@ -240,46 +405,157 @@ struct termdata {
 
 /****** Globals *********/
 
+/*
+ * The parsed model.  It is read once by ParseOutline() and
+ * does not change afterwards, so every simulation context
+ * shares it.
+ */
+
 extern int        NMechanisms;
 extern char       **Mechanism;
 
 extern int        NSpecies;
 extern char     **SpeciesName;
-extern int       *Concentration;
-
-extern int        NOperators;
-extern SHEADATA  *Operator;
-
-extern int        NSequences;
-extern DNA       *Sequence;
-
-#ifdef RMM_MODS
-/* Keep track of the promotors so that we can report on transcription rates */
-extern int        NPromotors;
-extern PROMOTOR   **Promotor;
-#endif
 
-extern int        NTranscripts;
-extern mRNA      *Transcript;
+extern int        NSeqTemplates;
+extern SEQTEMPLATE **SeqTemplate;
 
 extern int        NMassAction;
 extern int      **StoMat1;
 extern int      **StoMat2;
 extern double    *ReactionProbability;
 
-extern int       NReactions;
-extern REACTION  *Reaction;
-extern double     TotalProbability;
-extern double    *Probabilities;
+extern double MaximumTime;
+extern double PrintTime;
 
+extern char progid[80];
 
-extern CELL      *EColi;
+/***********************
+ *
+ * Output rows
+ *
+ * A row of the output, as WriteSpeciesState() takes it from the
+ * context: the int columns are the species counts, the operator
+ * states and, with --pops, the RNAPs of each promotor (see
+ * SampleColumns()).
+ *
+ ***********************/
 
-extern double Time;
-extern double MaximumTime;
-extern double PrintTime,WriteTime;
+struct sample {
+  double  Time;
+  int     NR;           /* Reactions since the last row */
+  double  RPQ;          /* Reactions queued per reaction since then */
+  double  Volume;       /* Relative to the reference volume */
+  int    *Value;        /* SampleColumns() of them */
+};
 
-extern char progid[80];
+/* A growing run of bytes */
+struct bytes {
+  unsigned char *Data;
+  size_t  N,Max;
+};
+
+/* The rows on their way to an output file (see Output.c) */
+struct rowcodec {
+  BYTES     Buffer;     /* A record, or the block of rows not yet written */
+  int       Rows;       /* In the block */
+  uint64_t *Last;       /* Columns of the row before, for the deltas */
+};
+
+/***********************
+ *
+ * Simulation Context
+ *
+ * Everything that changes as a trajectory runs: the molecule
+ * counts, the copies of the sequences with their operators,
+ * RNAPs and transcripts, the reaction queue, the cell, the clock
+ * and the random stream.  Several contexts made from one parsed
+ * model (see NewSimContext()) can run at once; each thread works
+ * on its own through Sim.
+ *
+ ***********************/
+
+struct simcontext {
+  int        *Concentration;
+
+  int         NOperators;
+  SHEADATA   *Operator;
+
+  int         NOperGroups;
+  OPERGROUP **OperGroup;
+
+  SEQCOPIES  *Copies;        /* One per SeqTemplate[] */
 
+  int         NSequences;
+  SEQUENCE  **Sequence;
+
+#ifdef RMM_MODS
+  /* Keep track of the promotors so that we can report on transcription rates */
+  int         NPromotors;
+  PROMOTOR  **Promotor;
+#endif
+
+  int         NTranscripts;
+  mRNA       *Transcript;
+
+  /* 
+   * Worklists used by Polymerize() so that the cost of a step scales with
+   * the active machinery rather than with the size of the genome:
+   *
+   *   FiringPromotor - promotors whose operator state allows initiation
+   *   ActiveSequence - RNAP indices of sequences that currently carry RNAPs
+   */
+  int         NFiringPromotors;
+  int         MaxFiringPromotors;
+  PROMOTOR  **FiringPromotor;
+
+  int         NActiveSequences;
+  int         MaxActiveSequences;
+  RNAPINDEX **ActiveSequence;
+
+  double     *Rates;         /* ReactionProbability, or those of a sweep point */
+  short       OwnRates;      /* Or a copy of the context's own (see ApplyRunSpec()) */
+
+  int         NReactions;
+  REACTION   *Reaction;
+  double      TotalProbability;
+  double      OrderProbability[NVOLUMEORDERS]; /* By volume order (see SubmitReaction()) */
+
+  CELL       *EColi;
+
+  double      Time;
+  double      WriteTime;
+
+  RNG        *Rng;
+  FILE       *Output;        /* Where WriteSpeciesState() writes, if anywhere */
+  SAMPLE      Row;           /* The row it writes */
+  short       KeepRows;      /* It packs the rows into Kept too (see Distribute.c) */
+  BYTES       Kept;
+  ROWCODEC    Codec;         /* Of Output (see Output.c) */
+  long        Written;       /* Rows written to Output */
+
+  /* Stop conditions (see Fate.c) */
+  int         Fate;          /* The one that decided, or -1 */
+  double      FateTime;
+  double      StopTime;      /* Of the last check */
+  double     *StopValue;     /* Values then */
+  double     *StopIntegral;
+  double      TargetValue;   /* Of the run, for an adaptive ensemble (see Target.c) */
+  short       TargetTaken;
+
+  struct mempools *Pools;    /* See Memory.c */
+  short       OwnPools;      /* Or they are those of the thread */
+
+  /* Work space of SetOperatorStates() */
+  int         MaxConfigs;
+  double     *ConfigProb;
+  int        *SpeciesNeed;
+  int         MaxUnits;
+  OPERGROUP **UnitGroup;
+  SHEADATA  **UnitOper;
+};
 
+extern __thread SIMCONTEXT *Sim;   /* Context of the running thread */
 
+extern SIMCONTEXT *NewSimContext(SIMCONTEXT *, struct mempools *);
+extern void        FreeSimContext(SIMCONTEXT *);
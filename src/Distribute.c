@@ -0,0 +1,872 @@
+/**************************
+ *
+ * Runs handed out over the network.
+ *
+ * A coordinator (--coordinator=[HOST:]PORT) reads the runs to make,
+ * one a line as for the fork server (see ForkServer.c), from stdin
+ * and hands them out to the workers (--worker=HOST:PORT) that connect
+ * to it over TCP.  A worker reads the outline with the same options
+ * as the coordinator, asks for runs a batch at a time, makes them on
+ * --threads threads, each in a context of its own, and sends back
+ * the rows of each run in binary.  The coordinator writes them to
+ * the output file of the run just as the run would have, and
+ * answers the run on stdout with "done FILE" or "failed FILE
+ * STATUS".  Runs given to a worker that goes away before sending
+ * them back are given to another; the coordinator is done when
+ * every run is.
+ *
+ * A message is a type byte, the length of its body (32 bits) and
+ * the body; numbers are little-endian.
+ *
+ *   worker       'H' version, columns, threads   hello
+ *                'N' n                           give me up to n runs
+ *                'R' run, status, fate, time,    the rows of a run, and
+ *                    rows, row...                its fate (see Fate.c)
+ *   coordinator  'S' (run, length, line)...      runs to make
+ *                'E'                             no more runs
+ *
+ * A row is the time, RPQ and volume (doubles) around NR, then the
+ * int columns (see SampleColumns()).
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef MEMORY
+ #include "Memory.h"
+#endif
+
+#ifndef FORKSERVER
+ #include "ForkServer.h"
+#endif
+
+#ifndef FATE
+ #include "Fate.h"
+#endif
+
+#ifndef DISTRIBUTE
+ #include "Distribute.h"
+#endif
+
+#ifndef OUTPUT
+ #include "Output.h"
+#endif
+
+#define PROTOCOL   1
+#define RESULTBYTES        (4*4+8)      /* Of 'R' before the rows */
+
+/****************************/
+/******* Messages ***********/
+/****************************/
+
+void PutBytes(b,p,n)
+BYTES *b;
+void *p;
+size_t n;
+{
+  if(b->N+n>b->Max){
+    b->Max= 2*b->Max+n+256;
+    b->Data= (unsigned char *) rrealloc(b->Data,b->Max,sizeof(unsigned char),"PutBytes");
+  }
+  memcpy(b->Data+b->N,p,n);
+  b->N += n;
+}
+
+void PutU32(b,v)
+BYTES *b;
+uint32_t v;
+{
+  unsigned char c[4];
+
+  c[0]= v; c[1]= v>>8; c[2]= v>>16; c[3]= v>>24;
+  PutBytes(b,c,4);
+}
+
+void PutDouble(b,x)
+BYTES *b;
+double x;
+{
+  uint64_t u;
+
+  memcpy(&u,&x,sizeof(u));
+  PutU32(b,(uint32_t) u);
+  PutU32(b,(uint32_t) (u>>32));
+}
+
+uint32_t GetU32(p)
+unsigned char *p;
+{
+  return((uint32_t) p[0] | (uint32_t) p[1]<<8 | (uint32_t) p[2]<<16 | (uint32_t) p[3]<<24);
+}
+
+double GetDouble(p)
+unsigned char *p;
+{
+  uint64_t u;
+  double x;
+
+  u= (uint64_t) GetU32(p) | (uint64_t) GetU32(p+4)<<32;
+  memcpy(&x,&u,sizeof(x));
+  return(x);
+}
+
+/* Pack row onto the rows of the current context */
+void KeepRow(row)
+SAMPLE *row;
+{
+  int i,n;
+
+  int SampleColumns();
+
+  n= SampleColumns();
+  PutDouble(&Sim->Kept,row->Time);
+  PutU32(&Sim->Kept,(uint32_t) row->NR);
+  PutDouble(&Sim->Kept,row->RPQ);
+  PutDouble(&Sim->Kept,row->Volume);
+  for(i=0; i<n; i++)
+    PutU32(&Sim->Kept,(uint32_t) row->Value[i]);
+}
+
+/* Unpack the row at p into row */
+void UnpackRow(p,row,columns)
+unsigned char *p;
+SAMPLE *row;
+int columns;
+{
+  int i;
+
+  row->Time=   GetDouble(p);
+  row->NR=     (int) GetU32(p+8);
+  row->RPQ=    GetDouble(p+12);
+  row->Volume= GetDouble(p+20);
+  for(i=0; i<columns; i++)
+    row->Value[i]= (int) GetU32(p+28+4*i);
+}
+
+static int WriteAll(fd,p,n)
+int fd;
+unsigned char *p;
+size_t n;
+{
+  ssize_t k;
+
+  while(n>0){
+    if((k=write(fd,p,n))<0){
+      if(errno==EINTR) continue;
+      return(-1);
+    }
+    p += k;
+    n -= k;
+  }
+  return(0);
+}
+
+static int ReadAll(fd,p,n)
+int fd;
+unsigned char *p;
+size_t n;
+{
+  ssize_t k;
+
+  while(n>0){
+    if((k=read(fd,p,n))<0){
+      if(errno==EINTR) continue;
+      return(-1);
+    }
+    if(k==0) return(-1);
+    p += k;
+    n -= k;
+  }
+  return(0);
+}
+
+/* Send a message of head and then body, either of which may be NULL; -1 if it can't */
+static int SendMessage(fd,type,head,body)
+int fd,type;
+BYTES *head,*body;
+{
+  unsigned char c[5];
+  size_t n;
+
+  n= (head!=NULL ? head->N : 0)+(body!=NULL ? body->N : 0);
+  c[0]= type;
+  c[1]= n; c[2]= n>>8; c[3]= n>>16; c[4]= n>>24;
+  if(WriteAll(fd,c,5)<0) return(-1);
+  if(head!=NULL && WriteAll(fd,head->Data,head->N)<0) return(-1);
+  if(body!=NULL && WriteAll(fd,body->Data,body->N)<0) return(-1);
+  return(0);
+}
+
+/* Read a message into body; its type, or -1 when the other end is gone */
+static int ReadMessage(fd,body)
+int fd;
+BYTES *body;
+{
+  unsigned char c[5];
+  uint32_t n;
+
+  if(ReadAll(fd,c,5)<0) return(-1);
+  n= GetU32(c+1);
+  if(n>(1U<<30)) return(-1);
+
+  body->N= 0;
+  if(n>body->Max){
+    body->Max= n;
+    body->Data= (unsigned char *) rrealloc(body->Data,n,sizeof(unsigned char),"ReadMessage");
+  }
+  if(ReadAll(fd,body->Data,n)<0) return(-1);
+  body->N= n;
+  return(c[0]);
+}
+
+/* Split HOST:PORT at the last colon; host is NULL for a bare PORT */
+static void SplitAddress(address,host,port)
+char *address,**host,**port;
+{
+  char *colon;
+
+  *host= (char *) rcalloc(strlen(address)+1,sizeof(char),"SplitAddress");
+  strcpy(*host,address);
+  if((colon=strrchr(*host,':'))==NULL){
+    *port= address;
+    free(*host);
+    *host= NULL;
+    return;
+  }
+  *colon= '\0';
+  *port= address+(colon-*host)+1;
+}
+
+static void NoDelay(fd)
+int fd;
+{
+  int on=1;
+
+  setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,&on,sizeof(on));
+}
+
+/****************************/
+/******* Coordinator ********/
+/****************************/
+
+typedef struct remoterun REMOTERUN;
+typedef struct peer      PEER;
+
+struct remoterun {
+  char  *Line;          /* As read */
+  char  *Output;
+  int    Worker;        /* Id of the worker making it, or -1 */
+  short  Done;
+};
+
+struct peer {
+  int    Fd;
+  int    Id;
+  int    Wanted;        /* Runs asked for and not yet sent */
+  short  Hello;
+  char   Name[64];
+};
+
+static REMOTERUN *Run=NULL;
+static int        NRuns=0,NDone=0;
+static int       *Queue=NULL,QFront=0,QCount=0;  /* Runs to give, a ring of NRuns */
+static PEER      *Peer=NULL;
+static int        NPeers=0,NextId=0;
+
+/* Read the runs from in; a line that isn't a run is answered with an error */
+static void ReadRuns(in)
+FILE *in;
+{
+  char line[4096],copy[4096],*c,*error;
+  RUNSPEC spec;
+
+  while(fgets(line,sizeof(line),in)!=NULL){
+    if((c=strpbrk(line,"#\r\n"))!=NULL) *c= '\0';
+    for(c=line; *c==' ' || *c=='\t'; c++);
+    if(*c=='\0') continue;
+
+    strcpy(copy,c);
+    if((error=ReadRunSpec(copy,&spec))!=NULL){
+      fprintf(stdout,"error %s\n",error);
+      fflush(stdout);
+      FreeRunSpec(&spec);
+      continue;
+    }
+
+    Run= (REMOTERUN *) rrealloc(Run,NRuns+1,sizeof(REMOTERUN),"ReadRuns");
+    Run[NRuns].Line= (char *) rcalloc(strlen(c)+1,sizeof(char),"ReadRuns");
+    strcpy(Run[NRuns].Line,c);
+    Run[NRuns].Output= spec.Output;
+    spec.Output= NULL;
+    Run[NRuns].Worker= -1;
+    Run[NRuns].Done= 0;
+    NRuns++;
+    FreeRunSpec(&spec);
+  }
+}
+
+static void QueueRun(r)
+int r;
+{
+  Queue[(QFront+QCount)%NRuns]= r;
+  QCount++;
+  Run[r].Worker= -1;
+}
+
+/* Close the connection of peer p, giving its runs to others */
+static void DropPeer(p)
+int p;
+{
+  int r,n;
+
+  for(n=r=0; r<NRuns; r++)
+    if(!Run[r].Done && Run[r].Worker==Peer[p].Id){
+      QueueRun(r);
+      n++;
+    }
+  if(n>0)
+    fprintf(logfp,"%s: lost worker %s, giving its %d runs to others\n",
+	    progid,Peer[p].Name,n);
+  else if (DebugLevel > 1)
+    fprintf(logfp,"Worker %s is gone\n",Peer[p].Name);
+
+  close(Peer[p].Fd);
+  Peer[p]= Peer[--NPeers];
+}
+
+/* Write the rows of run r, and its fate, from body */
+static void WriteRun(r,body)
+int r;
+BYTES *body;
+{
+  int columns,rows,fate,i;
+  unsigned long seed;
+  char line[4096];
+  FILE *fp;
+  SAMPLE row;
+  RUNSPEC spec;
+  RNG rng,*own;
+
+  int SampleColumns();
+
+  columns= SampleColumns();
+  fate= (int) GetU32(body->Data+8);
+  rows= (int) GetU32(body->Data+20);
+
+  if((fp=fopen(Run[r].Output,"w"))==NULL){
+    perror(Run[r].Output);
+    fprintf(stdout,"failed %s 1\n",Run[r].Output);
+    return;
+  }
+  /* The header of a binary output has the seed and trajectory of the run */
+  rng= *Sim->Rng;
+  if(OutputFormat!=TEXTOUTPUT){
+    strcpy(line,Run[r].Line);
+    if(ReadRunSpec(line,&spec)==NULL){
+      seed= (unsigned long) ((uint64_t) rng.Key[0] | (uint64_t) rng.Key[1]<<32);
+      RngInit(&rng,(spec.SeedGiven ? (unsigned long) spec.Seed : seed),
+	      (spec.TrajectoryGiven ? (unsigned long) spec.Trajectory : (unsigned long) rng.Stream[1]));
+    }
+    FreeRunSpec(&spec);
+  }
+  own= Sim->Rng;
+  Sim->Rng= &rng;
+  Sim->Output= fp;
+  BeginOutput(Run[r].Line);
+  Sim->Rng= own;
+
+  row.Value= (int *) rcalloc(columns+1,sizeof(int),"WriteRun");
+  for(i=0; i<rows; i++){
+    UnpackRow(body->Data+RESULTBYTES+(size_t) i*ROWBYTES(columns),&row,columns);
+    PutOutput(&row);
+  }
+  free(row.Value);
+  EndOutput((fate>=0 && fate<NStops ? fate : -1),GetDouble(body->Data+12));
+
+  if(fclose(fp)!=0){
+    perror(Run[r].Output);
+    fprintf(stdout,"failed %s 1\n",Run[r].Output);
+  }
+  else
+    fprintf(stdout,"done %s\n",Run[r].Output);
+}
+
+/* Act on a message from peer p; FALSE if p is to be dropped */
+static int HandleMessage(p,type,body)
+int p,type;
+BYTES *body;
+{
+  int r,status,columns;
+
+  int SampleColumns();
+
+  columns= SampleColumns();
+
+  switch(type){
+  case 'H':
+    if(body->N<12 || GetU32(body->Data)!=PROTOCOL || (int) GetU32(body->Data+4)!=columns){
+      fprintf(logfp,"%s: worker %s has another outline or version, turning it away\n",
+	      progid,Peer[p].Name);
+      SendMessage(Peer[p].Fd,'E',NULL,NULL);
+      return(0);
+    }
+    Peer[p].Hello= 1;
+    if (DebugLevel > 1)
+      fprintf(logfp,"Worker %s with %d threads\n",Peer[p].Name,(int) GetU32(body->Data+8));
+    return(1);
+
+  case 'N':
+    if(!Peer[p].Hello || body->N<4) return(0);
+    Peer[p].Wanted= (int) GetU32(body->Data);
+    return(1);
+
+  case 'R':
+    if(!Peer[p].Hello || body->N<RESULTBYTES) return(0);
+    r=      (int) GetU32(body->Data);
+    status= (int) GetU32(body->Data+4);
+    if(r<0 || r>=NRuns ||
+       body->N!=RESULTBYTES+(size_t) GetU32(body->Data+20)*ROWBYTES(columns)) return(0);
+
+    /* Given again after all, or made twice: the first to come back counts */
+    if(Run[r].Done) return(1);
+
+    if(status!=0)
+      fprintf(stdout,"failed %s %d\n",Run[r].Output,status);
+    else
+      WriteRun(r,body);
+    fflush(stdout);
+
+    Run[r].Done= 1;
+    Run[r].Worker= -1;
+    NDone++;
+    return(1);
+  }
+  return(0);
+}
+
+/* Send the runs waiting to the workers that asked for them */
+static void GiveRuns()
+{
+  int p,r,n;
+  BYTES msg;
+
+  memset(&msg,0,sizeof(msg));
+  for(p=0; p<NPeers && QCount>0; p++){
+    if(Peer[p].Wanted<=0) continue;
+
+    msg.N= 0;
+    for(n=0; n<Peer[p].Wanted && QCount>0; n++){
+      r= Queue[QFront];
+      QFront= (QFront+1)%NRuns;
+      QCount--;
+      if(Run[r].Done){
+	n--;
+	continue;
+      }
+      Run[r].Worker= Peer[p].Id;
+      PutU32(&msg,(uint32_t) r);
+      PutU32(&msg,(uint32_t) strlen(Run[r].Line));
+      PutBytes(&msg,Run[r].Line,strlen(Run[r].Line));
+    }
+    if(n==0) continue;
+    Peer[p].Wanted= 0;
+
+    /* A worker that can't take them is dropped when its end is read */
+    SendMessage(Peer[p].Fd,'S',&msg,NULL);
+  }
+  free(msg.Data);
+}
+
+static int Listen(address)
+char *address;
+{
+  int sock,on=1,error;
+  char *host,*port;
+  struct addrinfo hints,*ai;
+
+  SplitAddress(address,&host,&port);
+  memset(&hints,0,sizeof(hints));
+  hints.ai_family=   AF_UNSPEC;
+  hints.ai_socktype= SOCK_STREAM;
+  hints.ai_flags=    AI_PASSIVE;
+  if((error=getaddrinfo(host,port,&hints,&ai))!=0){
+    fprintf(stderr,"%s: %s: %s\n",progid,address,gai_strerror(error));
+    exit(1);
+  }
+  if((sock=socket(ai->ai_family,ai->ai_socktype,ai->ai_protocol))<0 ||
+     setsockopt(sock,SOL_SOCKET,SO_REUSEADDR,&on,sizeof(on))<0 ||
+     bind(sock,ai->ai_addr,ai->ai_addrlen)<0 ||
+     listen(sock,64)<0){
+    perror(address);
+    exit(1);
+  }
+  freeaddrinfo(ai);
+  free(host);
+  return(sock);
+}
+
+/*
+ * Hand out the runs read from stdin to the workers that connect at
+ * address, [HOST:]PORT, writing their rows as the runs would have
+ * (see Output.c).
+ */
+void RunCoordinator(address)
+char *address;
+{
+  int sock,fd,p,n,type;
+  struct pollfd *fds=NULL;
+  struct sockaddr_storage addr;
+  socklen_t len;
+  char host[48],port[16];
+  BYTES body;
+
+  /* A worker that goes away must not take the coordinator with it */
+  signal(SIGPIPE,SIG_IGN);
+
+  sock= Listen(address);
+  ReadRuns(stdin);
+
+  Queue= (int *) rcalloc(NRuns+1,sizeof(int),"RunCoordinator");
+  for(n=NRuns-1; n>=0; n--) Queue[n]= n;
+  QCount= NRuns;
+
+  if (DebugLevel > 1)
+    fprintf(logfp,"Handing out %d runs at %s\n",NRuns,address);
+
+  memset(&body,0,sizeof(body));
+  while(NDone<NRuns){
+    fds= (struct pollfd *) rrealloc(fds,NPeers+1,sizeof(struct pollfd),"RunCoordinator");
+    fds[0].fd= sock;
+    fds[0].events= POLLIN;
+    for(p=0; p<NPeers; p++){
+      fds[p+1].fd= Peer[p].Fd;
+      fds[p+1].events= POLLIN;
+    }
+    if(poll(fds,NPeers+1,-1)<0){
+      if(errno==EINTR) continue;
+      perror(progid);
+      exit(-1);
+    }
+
+    /* Peers are dropped from the back, so the ones polled stay put */
+    for(p=NPeers-1; p>=0; p--){
+      if(fds[p+1].revents==0) continue;
+      if((type=ReadMessage(Peer[p].Fd,&body))<0 || !HandleMessage(p,type,&body))
+	DropPeer(p);
+    }
+
+    if(fds[0].revents&POLLIN){
+      len= sizeof(addr);
+      if((fd=accept(sock,(struct sockaddr *) &addr,&len))>=0){
+	NoDelay(fd);
+	Peer= (PEER *) rrealloc(Peer,NPeers+1,sizeof(PEER),"RunCoordinator");
+	memset(&Peer[NPeers],0,sizeof(PEER));
+	Peer[NPeers].Fd= fd;
+	Peer[NPeers].Id= NextId++;
+	if(getnameinfo((struct sockaddr *) &addr,len,host,sizeof(host),port,sizeof(port),
+		       NI_NUMERICHOST|NI_NUMERICSERV)==0)
+	  sprintf(Peer[NPeers].Name,"%s:%s",host,port);
+	else
+	  sprintf(Peer[NPeers].Name,"#%d",Peer[NPeers].Id);
+	NPeers++;
+      }
+    }
+
+    GiveRuns();
+  }
+
+  for(p=0; p<NPeers; p++){
+    SendMessage(Peer[p].Fd,'E',NULL,NULL);
+    close(Peer[p].Fd);
+  }
+  close(sock);
+
+  for(n=0; n<NRuns; n++){
+    free(Run[n].Line);
+    free(Run[n].Output);
+  }
+  free(Run);
+  free(Queue);
+  free(Peer);
+  free(fds);
+  free(body.Data);
+}
+
+/****************************/
+/******* Worker *************/
+/****************************/
+
+typedef struct job JOB;
+
+struct job {
+  int    Run;
+  char  *Line;
+  JOB   *Next;
+};
+
+static SIMCONTEXT     *Proto;
+static int             Sock,NThreads;
+static pthread_mutex_t Lock=PTHREAD_MUTEX_INITIALIZER;      /* Of the jobs */
+static pthread_cond_t  JobReady=PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t SendLock=PTHREAD_MUTEX_INITIALIZER;  /* Of Sock */
+static JOB            *First=NULL,*Last=NULL;
+static int             NJobs=0,Asked=0,Ended=0;
+
+static void Ask(n)
+int n;
+{
+  BYTES msg;
+
+  memset(&msg,0,sizeof(msg));
+  PutU32(&msg,(uint32_t) n);
+  pthread_mutex_lock(&SendLock);
+  SendMessage(Sock,'N',&msg,NULL);
+  pthread_mutex_unlock(&SendLock);
+  free(msg.Data);
+}
+
+/*
+ * Next job, or NULL at the end.  More are asked for while fewer are
+ * left than there are threads, so that none waits for the network.
+ */
+static JOB *NextJob()
+{
+  JOB *job;
+  int ask=0;
+
+  pthread_mutex_lock(&Lock);
+  for(;;){
+    if(Ended){
+      job= NULL;
+      break;
+    }
+    if(NJobs<NThreads && !Asked){
+      Asked= 1;
+      ask= 2*NThreads-NJobs;
+      pthread_mutex_unlock(&Lock);
+      Ask(ask);
+      pthread_mutex_lock(&Lock);
+      continue;
+    }
+    if((job=First)!=NULL){
+      if((First=job->Next)==NULL) Last= NULL;
+      NJobs--;
+      break;
+    }
+    pthread_cond_wait(&JobReady,&Lock);
+  }
+  pthread_mutex_unlock(&Lock);
+  return(job);
+}
+
+/* Make job in a context of its own, and send its rows */
+static void MakeJob(job,pools)
+JOB *job;
+struct mempools *pools;
+{
+  int status;
+  char *error;
+  RUNSPEC spec;
+  BYTES head;
+
+  int ApplyRunSpec();
+  void RunTrajectory();
+  int SampleColumns();
+
+  Sim= NewSimContext(Proto,pools);
+  Sim->KeepRows= 1;
+
+  if((error=ReadRunSpec(job->Line,&spec))!=NULL){
+    fprintf(logfp,"%s: %s in run %d\n",progid,error,job->Run);
+    status= 1;
+  }
+  else if((status=ApplyRunSpec(&spec))==0)
+    RunTrajectory();
+  FreeRunSpec(&spec);
+
+  memset(&head,0,sizeof(head));
+  PutU32(&head,(uint32_t) job->Run);
+  PutU32(&head,(uint32_t) status);
+  PutU32(&head,(uint32_t) (status==0 && NStops>0 ? Sim->Fate : -1));
+  PutDouble(&head,(status==0 && NStops>0 ? Sim->FateTime : 0.0));
+  PutU32(&head,(uint32_t) (status==0 ? Sim->Kept.N/ROWBYTES(SampleColumns()) : 0));
+  if(status!=0) Sim->Kept.N= 0;
+
+  pthread_mutex_lock(&SendLock);
+  SendMessage(Sock,'R',&head,&Sim->Kept);
+  pthread_mutex_unlock(&SendLock);
+
+  free(head.Data);
+  FreeSimContext(Sim);
+}
+
+static void *MakeJobs(arg)
+void *arg;
+{
+  JOB *job;
+  struct mempools *pools;
+
+  pools= NewMemoryPools();
+  while((job=NextJob())!=NULL){
+    MakeJob(job,pools);
+    free(job->Line);
+    free(job);
+  }
+  FreeMemoryPools(pools);
+  return(NULL);
+}
+
+static int Connect(address)
+char *address;
+{
+  int sock,error,tries;
+  char *host,*port;
+  struct addrinfo hints,*ai;
+
+  SplitAddress(address,&host,&port);
+  if(host==NULL){
+    fprintf(stderr,"%s: --worker takes HOST:PORT\n",progid);
+    exit(1);
+  }
+  memset(&hints,0,sizeof(hints));
+  hints.ai_family=   AF_UNSPEC;
+  hints.ai_socktype= SOCK_STREAM;
+  if((error=getaddrinfo(host,port,&hints,&ai))!=0){
+    fprintf(stderr,"%s: %s: %s\n",progid,address,gai_strerror(error));
+    exit(1);
+  }
+
+  /* The coordinator may still be reading its outline */
+  for(tries=0; ; tries++){
+    if((sock=socket(ai->ai_family,ai->ai_socktype,ai->ai_protocol))<0){
+      perror(address);
+      exit(1);
+    }
+    if(connect(sock,ai->ai_addr,ai->ai_addrlen)==0) break;
+    close(sock);
+    if(tries==30){
+      perror(address);
+      exit(1);
+    }
+    sleep(1);
+  }
+  freeaddrinfo(ai);
+  free(host);
+
+  NoDelay(sock);
+  return(sock);
+}
+
+/*
+ * Make runs for the coordinator at address, HOST:PORT, from proto,
+ * the context the outline was parsed into, on threads threads (one
+ * per processor if threads<=0), until it has no more.
+ */
+void WorkForCoordinator(address,threads)
+char *address;
+int threads;
+{
+  int i,type,n,len;
+  size_t at;
+  pthread_t *thread;
+  BYTES msg;
+  JOB *job;
+
+  int SampleColumns();
+
+  signal(SIGPIPE,SIG_IGN);
+
+  NThreads= (threads>0 ? threads : (int) sysconf(_SC_NPROCESSORS_ONLN));
+  if(NThreads<1) NThreads= 1;
+  Proto= Sim;
+  Sock= Connect(address);
+
+  memset(&msg,0,sizeof(msg));
+  PutU32(&msg,PROTOCOL);
+  PutU32(&msg,(uint32_t) SampleColumns());
+  PutU32(&msg,(uint32_t) NThreads);
+  SendMessage(Sock,'H',&msg,NULL);
+
+  if (DebugLevel > 1)
+    fprintf(logfp,"Working for %s on %d threads\n",address,NThreads);
+
+  thread= (pthread_t *) rcalloc(NThreads,sizeof(pthread_t),"WorkForCoordinator");
+  for(i=0; i<NThreads; i++)
+    if(pthread_create(&thread[i],NULL,MakeJobs,NULL)!=0){
+      fprintf(stderr,"%s: can't start thread %d of the worker\n",progid,i);
+      exit(-1);
+    }
+
+  /* Take in the runs until the coordinator has no more, or is gone */
+  while((type=ReadMessage(Sock,&msg))=='S'){
+    pthread_mutex_lock(&Lock);
+    for(at=0, n=0; at+8<=msg.N; at += 8+len, n++){
+      len= (int) GetU32(msg.Data+at+4);
+      if(at+8+len>msg.N) break;
+      job= (JOB *) rcalloc(1,sizeof(JOB),"WorkForCoordinator");
+      job->Run=  (int) GetU32(msg.Data+at);
+      job->Line= (char *) rcalloc(len+1,sizeof(char),"WorkForCoordinator");
+      memcpy(job->Line,msg.Data+at+8,len);
+      if(Last!=NULL) Last->Next= job;
+      else First= job;
+      Last= job;
+      NJobs++;
+    }
+    Asked= 0;
+    pthread_cond_broadcast(&JobReady);
+    pthread_mutex_unlock(&Lock);
+  }
+  if(type!='E')
+    fprintf(logfp,"%s: lost the coordinator at %s\n",progid,address);
+
+  pthread_mutex_lock(&Lock);
+  Ended= 1;
+  pthread_cond_broadcast(&JobReady);
+  pthread_mutex_unlock(&Lock);
+
+  for(i=0; i<NThreads; i++)
+    pthread_join(thread[i],NULL);
+  close(Sock);
+
+  while((job=First)!=NULL){
+    First= job->Next;
+    free(job->Line);
+    free(job);
+  }
+  free(thread);
+  free(msg.Data);
+}
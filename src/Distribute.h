@@ -0,0 +1,20 @@
+/**********************
+ *
+ * Runs handed out over the network by a coordinator (see Distribute.c)
+ *
+ **********************/
+#define DISTRIBUTE
+
+#define ROWBYTES(columns)  (3*8+4+4*(columns))   /* Of a row packed by KeepRow() */
+
+/* Little-endian fields of a message, or of a binary output (see Output.c) */
+extern void     PutBytes(BYTES *, void *, size_t);
+extern void     PutU32(BYTES *, uint32_t);
+extern void     PutDouble(BYTES *, double);
+extern uint32_t GetU32(unsigned char *);
+extern double   GetDouble(unsigned char *);
+
+extern void KeepRow(SAMPLE *);
+extern void UnpackRow(unsigned char *, SAMPLE *, int);
+extern void RunCoordinator(char *);
+extern void WorkForCoordinator(char *, int);
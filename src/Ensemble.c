@@ -0,0 +1,245 @@
+/**************************
+ *
+ * Ensembles: many trajectories from one parse of the outline.
+ *
+ * The trajectories are run by a pool of threads.  Each thread owns a
+ * range of trajectory indices, handed out from the front; a thread
+ * that runs out steals the back half of the range of the thread with
+ * the most left.  Trajectories differ much in length (a lytic run
+ * ends up far busier than a lysogenic one), so the work is balanced
+ * as it is done rather than split evenly beforehand.
+ *
+ * An adaptive ensemble (see Target.c), or one taking statistics (see
+ * Stats.c), is handed out in order instead, up to a limit that is
+ * lowered once enough trajectories are done.  One taking statistics
+ * also hands out none more than a window past the first it hasn't
+ * joined yet, so that the trajectories done ahead of a slow one, kept
+ * until it is, stay few.
+ *
+ * Every trajectory runs in a context of its own (see SimContext.c)
+ * with a random stream of its own; the contexts of a thread take
+ * their objects from memory pools the thread keeps for all of them.
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#include <pthread.h>
+#include <unistd.h>
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef MEMORY
+ #include "Memory.h"
+#endif
+
+typedef struct worker WORKER;
+
+struct worker {
+  pthread_mutex_t Lock;
+  int             Front,Back;   /* Trajectories [Front,Back) are left */
+  pthread_t       Thread;
+};
+
+static SIMCONTEXT *Proto;
+static WORKER     *Worker;
+static int         NWorkers;
+
+static pthread_mutex_t OrderLock=PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  Moved=PTHREAD_COND_INITIALIZER;
+static int         Ordered,Next,Limit;   /* Trajectories [Next,Limit) are left */
+static int         Ahead=0,Window;       /* A thread, and all of them */
+static int         Joined;               /* Trajectories 0..Joined-1 are joined */
+
+/* Run no trajectory past the first n of an ordered ensemble */
+void LimitEnsemble(n)
+int n;
+{
+  pthread_mutex_lock(&OrderLock);
+  if(n<Limit) Limit= n;
+  pthread_cond_broadcast(&Moved);
+  pthread_mutex_unlock(&OrderLock);
+}
+
+/*
+ * Hand out no trajectory of an ordered ensemble more than n a thread
+ * past the first not yet joined (see JoinedEnsemble())
+ */
+void WindowEnsemble(n)
+int n;
+{
+  Ahead= n;
+}
+
+/* Trajectories 0..n-1 of an ordered ensemble are joined */
+void JoinedEnsemble(n)
+int n;
+{
+  pthread_mutex_lock(&OrderLock);
+  Joined= n;
+  pthread_cond_broadcast(&Moved);
+  pthread_mutex_unlock(&OrderLock);
+}
+
+/* Trajectories of an ordered ensemble that may still be run */
+int EnsembleLimit()
+{
+  int n;
+
+  pthread_mutex_lock(&OrderLock);
+  n= Limit;
+  pthread_mutex_unlock(&OrderLock);
+  return(n);
+}
+
+/* Next trajectory for worker w, stealing if its own are done; -1 at the end */
+static int NextTrajectory(w)
+int w;
+{
+  int i,v,k,left,most;
+  WORKER *own,*victim;
+
+  if(Ordered){
+    /* The first not joined is running, so it will be */
+    pthread_mutex_lock(&OrderLock);
+    while(Window>0 && Next<Limit && Next>=Joined+Window)
+      pthread_cond_wait(&Moved,&OrderLock);
+    k= (Next<Limit ? Next++ : -1);
+    pthread_mutex_unlock(&OrderLock);
+    return(k);
+  }
+
+  own= &Worker[w];
+  for(;;){
+    pthread_mutex_lock(&own->Lock);
+    if(own->Front<own->Back){
+      k= own->Front++;
+      pthread_mutex_unlock(&own->Lock);
+      return(k);
+    }
+    pthread_mutex_unlock(&own->Lock);
+
+    /* Pick the worker with the most left */
+    v= -1;
+    most= 0;
+    for(i=0; i<NWorkers; i++){
+      if(i==w) continue;
+      pthread_mutex_lock(&Worker[i].Lock);
+      left= Worker[i].Back-Worker[i].Front;
+      pthread_mutex_unlock(&Worker[i].Lock);
+      if(left>most){
+	most= left;
+	v= i;
+      }
+    }
+    if(v<0) return(-1);
+
+    /*
+     * Take the back half of it; it may have moved on in the meantime.
+     * Only one lock is held at a time: nobody else adds to an empty
+     * range, so own can be filled after victim is let go.
+     */
+    victim= &Worker[v];
+    pthread_mutex_lock(&victim->Lock);
+    left= (victim->Back-victim->Front+1)/2;
+    k= victim->Back;
+    victim->Back -= left;
+    pthread_mutex_unlock(&victim->Lock);
+
+    if(left>0){
+      pthread_mutex_lock(&own->Lock);
+      own->Front= k-left;
+      own->Back=  k;
+      pthread_mutex_unlock(&own->Lock);
+      DEBUG(2) fprintf(logfp,"Worker %d takes %d trajectories from worker %d\n",
+		       w,left,v);
+    }
+  }
+}
+
+static void *RunWorker(arg)
+void *arg;
+{
+  int w,k;
+  struct mempools *pools;
+
+  void RunEnsembleMember();
+
+  w= (int) (long) arg;
+  pools= NewMemoryPools();
+
+  while((k=NextTrajectory(w))>=0)
+    RunEnsembleMember(Proto,k,pools);
+
+  FreeMemoryPools(pools);
+  return(NULL);
+}
+
+/*
+ * Run trajectories 0..n-1 from proto, the context the outline was
+ * parsed into, on threads threads (one per processor if threads<=0),
+ * in order if ordered.  Returns how many were started, from 0 on:
+ * fewer than n once LimitEnsemble() is called.
+ */
+int RunEnsemble(proto,n,threads,ordered)
+SIMCONTEXT *proto;
+int n,threads,ordered;
+{
+  int i;
+
+  if(threads<=0) threads= (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if(threads<1)  threads= 1;
+  if(threads>n)  threads= n;
+
+  if (DebugLevel > 1)
+    fprintf(logfp,"Running %d trajectories on %d threads\n",n,threads);
+
+  Proto=    proto;
+  NWorkers= threads;
+  Worker=   (WORKER *) rcalloc(NWorkers,sizeof(WORKER),"RunEnsemble");
+  Ordered=  ordered;
+  Next=     0;
+  Limit=    n;
+  Joined=   0;
+  Window=   Ahead*threads;
+
+  /* Start with contiguous blocks of trajectories */
+  for(i=0; i<NWorkers; i++){
+    pthread_mutex_init(&Worker[i].Lock,NULL);
+    Worker[i].Front= (int) ((long) i*n/NWorkers);
+    Worker[i].Back=  (int) ((long) (i+1)*n/NWorkers);
+  }
+
+  for(i=0; i<NWorkers; i++)
+    if(pthread_create(&Worker[i].Thread,NULL,RunWorker,(void *) (long) i)!=0){
+      fprintf(stderr,"%s: can't start thread %d of the ensemble\n",progid,i);
+      exit(-1);
+    }
+
+  /* Workers look at each other until the last is done */
+  for(i=0; i<NWorkers; i++)
+    pthread_join(Worker[i].Thread,NULL);
+  for(i=0; i<NWorkers; i++)
+    pthread_mutex_destroy(&Worker[i].Lock);
+
+  free(Worker);
+  Worker= NULL;
+  NWorkers= 0;
+  return(Ordered ? Next : n);
+}
@@ -0,0 +1,227 @@
+/**************************
+ *
+ * Stop conditions.
+ *
+ * A run can end as soon as its fate is decided, rather than at the
+ * maximum time.  A stop condition (--stop) is
+ *
+ *   FATE:QUANTITY>X   or   FATE:QUANTITY<X
+ *
+ * where QUANTITY is one of
+ *
+ *   NAME          the count of species NAME
+ *   NAME/V        its count over the cell volume, as in the output
+ *   int(NAME)     the integral of the count over time
+ *   int(NAME/V)   the integral of the concentration over time
+ *   time          the time itself, for a fate decided by default
+ *
+ * The conditions are checked after every reaction; the first to pass
+ * decides the fate, and the time of its first passage is the time
+ * of the decision.  Integrals are sums of the value after each
+ * reaction times the time to the next, as simulac.py's
+ * integrateConcentration() takes them from the output, but at every
+ * reaction rather than every row.
+ *
+ * The run writes a row at the time of the decision, and then
+ *
+ *   % fate FATE TIME
+ *
+ * which readers of the output (comments='%') pass over.
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef FATE
+ #include "Fate.h"
+#endif
+
+#define STOP_COUNT    0
+#define STOP_CONC     1
+#define STOP_TIME     2
+
+typedef struct stop STOP;
+
+struct stop {
+  char   *Fate;
+  int     Kind;         /* STOP_COUNT, ... */
+  int     Species;
+  short   Integral;
+  short   Above;        /* QUANTITY>X, or QUANTITY<X */
+  double  Threshold;
+};
+
+int          NStops=0;
+static STOP *Stop=NULL;
+
+/* Read the stop conditions of --stop */
+void SetupStops(n,spec)
+int n;
+char **spec;
+{
+  int i;
+  char *copy,*colon,*op,*name,*slash,*end;
+  STOP *stop;
+
+  int FindSpecies();
+
+  NStops= n;
+  Stop= (STOP *) rcalloc(NStops+1,sizeof(STOP),"SetupStops");
+
+  for(i=0; i<NStops; i++){
+    stop= &Stop[i];
+    copy= (char *) rcalloc(strlen(spec[i])+1,sizeof(char),"SetupStops");
+    strcpy(copy,spec[i]);
+
+    if((colon=strchr(copy,':'))==NULL || colon==copy ||
+       (op=strpbrk(colon,"<>"))==NULL){
+      fprintf(stderr,"%s: stop condition '%s' is not FATE:QUANTITY>X or FATE:QUANTITY<X\n",
+	      progid,spec[i]);
+      exit(1);
+    }
+    *colon= '\0';
+    stop->Fate=  copy;
+    stop->Above= (*op=='>');
+    stop->Threshold= strtod(op+1,&end);
+    if(end==op+1 || *end!='\0'){
+      fprintf(stderr,"%s: bad threshold in stop condition '%s'\n",progid,spec[i]);
+      exit(1);
+    }
+    *op= '\0';
+
+    name= colon+1;
+    if(strncmp(name,"int(",4)==0 && op[-1]==')'){
+      stop->Integral= 1;
+      name += 4;
+      op[-1]= '\0';
+    }
+
+    if(strcmp(name,"time")==0 && !stop->Integral){
+      stop->Kind= STOP_TIME;
+      continue;
+    }
+
+    stop->Kind= STOP_COUNT;
+    if((slash=strrchr(name,'/'))!=NULL && strcmp(slash,"/V")==0){
+      stop->Kind= STOP_CONC;
+      *slash= '\0';
+    }
+    if((stop->Species=FindSpecies(name))<0 || stop->Species==NSpecies){
+      fprintf(stderr,"%s: no species '%s' for stop condition '%s'\n",
+	      progid,name,spec[i]);
+      exit(1);
+    }
+  }
+
+  if (DebugLevel > 1)
+    for(i=0; i<NStops; i++)
+      fprintf(logfp,"Stop with fate %s when %s%s%s%s %c %g\n",Stop[i].Fate,
+	      (Stop[i].Integral ? "int(" : ""),
+	      (Stop[i].Kind==STOP_TIME ? "time" : SpeciesName[Stop[i].Species]),
+	      (Stop[i].Kind==STOP_CONC ? "/V" : ""),(Stop[i].Integral ? ")" : ""),
+	      (Stop[i].Above ? '>' : '<'),Stop[i].Threshold);
+}
+
+char *FateName(fate)
+int fate;
+{
+  return(Stop[fate].Fate);
+}
+
+/* Value of the quantity of stop now */
+static double StopValue(stop)
+STOP *stop;
+{
+  switch(stop->Kind){
+  case STOP_TIME:
+    return(Sim->Time);
+  case STOP_CONC:
+#ifdef RMM_MODS
+    return(Sim->Concentration[stop->Species]/(Sim->EColi->V/Sim->EColi->V0));
+#else
+    return(Sim->Concentration[stop->Species]/(Sim->EColi->V/Sim->EColi->VI));
+#endif
+  }
+  return((double) Sim->Concentration[stop->Species]);
+}
+
+/* Start the stop conditions of the current context at its time */
+void StartStops()
+{
+  int i;
+
+  if(Sim->StopValue==NULL){
+    Sim->StopValue=    (double *) rcalloc(NStops+1,sizeof(double),"StartStops");
+    Sim->StopIntegral= (double *) rcalloc(NStops+1,sizeof(double),"StartStops");
+  }
+  for(i=0; i<NStops; i++){
+    Sim->StopValue[i]= StopValue(&Stop[i]);
+    Sim->StopIntegral[i]= 0.0;
+  }
+  Sim->StopTime= Sim->Time;
+  Sim->Fate= -1;
+}
+
+/*
+ * Check the stop conditions, after a reaction; TRUE if one decides
+ * the fate, which is then in Sim->Fate with the time in FateTime.
+ */
+int CheckStops()
+{
+  int i;
+  double value,x;
+  STOP *stop;
+
+  for(i=0; i<NStops; i++){
+    stop= &Stop[i];
+    value= StopValue(stop);
+    if(stop->Integral){
+      Sim->StopIntegral[i] += Sim->StopValue[i]*(Sim->Time-Sim->StopTime);
+      x= Sim->StopIntegral[i];
+    }
+    else
+      x= value;
+    Sim->StopValue[i]= value;
+
+    if(Sim->Fate<0 && (stop->Above ? x>stop->Threshold : x<stop->Threshold)){
+      Sim->Fate= i;
+      Sim->FateTime= Sim->Time;
+    }
+  }
+  Sim->StopTime= Sim->Time;
+
+  if(Sim->Fate>=0 && DebugLevel > 1)
+    fprintf(logfp,"Fate %s decided at %g\n",Stop[Sim->Fate].Fate,Sim->FateTime);
+  return(Sim->Fate>=0);
+}
+
+/* Record fate, decided at time t, in the output */
+void WriteFate(fp,fate,t)
+FILE *fp;
+int fate;
+double t;
+{
+  fprintf(fp,"%% fate %s %e\n",Stop[fate].Fate,t);
+}
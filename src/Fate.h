@@ -0,0 +1,13 @@
+/**********************
+ *
+ * Stop conditions: runs that end when their fate is decided (see Fate.c)
+ *
+ **********************/
+#define FATE
+
+extern int  NStops;
+extern void SetupStops(int, char **);
+extern void StartStops();
+extern int  CheckStops();
+extern char *FateName(int);
+extern void WriteFate(FILE *, int, double);
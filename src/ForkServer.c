@@ -0,0 +1,300 @@
+/**************************
+ *
+ * Fork server.
+ *
+ * The outline is read and the common options are applied once; the
+ * server then reads the runs to make, one a line, from stdin, a
+ * file, a named pipe or a Unix socket.  A line is a list of
+ *
+ *   output=FILE seed=N trajectory=N volume=V init=NAME=N rate=kN=P
+ *
+ * of which output is required and init and rate may be repeated
+ * ("--output=FILE" etc. also do).  Each run is made by a process
+ * forked from the server, which inherits the parsed model
+ * copy-on-write: a run costs a fork rather than a parse, and the
+ * server itself is never changed.  At most jobs runs go at a time.
+ *
+ * Every line is answered, when its run has finished, with
+ * "done FILE", "failed FILE STATUS" or "error MESSAGE": on stdout
+ * for a pipe or a file and on the connection for a socket.  A pipe
+ * or a file is read to its end.  The connections of a socket are served one after the
+ * other, until a client sends "quit".
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef FORKSERVER
+ #include "ForkServer.h"
+#endif
+
+static int    Jobs=0,NRunning=0;
+static pid_t *RunPid=NULL;
+static char **RunOutput=NULL;
+static FILE  *Reply=NULL;
+
+/* Copy of the n characters at s */
+static char *CopyString(s,n)
+char *s;
+int n;
+{
+  char *copy;
+
+  copy= (char *) rcalloc(n+1,sizeof(char),"CopyString");
+  strncpy(copy,s,n);
+  return(copy);
+}
+
+void FreeRunSpec(spec)
+RUNSPEC *spec;
+{
+  int i;
+
+  free(spec->Output);
+  for(i=0; i<spec->NInits; i++) free(spec->Init[i]);
+  free(spec->Init);
+  for(i=0; i<spec->NRates; i++) free(spec->Rate[i]);
+  free(spec->Rate);
+  memset(spec,0,sizeof(RUNSPEC));
+}
+
+/* Read a line into spec; NULL, or what is wrong with it */
+char *ReadRunSpec(line,spec)
+char *line;
+RUNSPEC *spec;
+{
+  char *w,*save,*value,*end;
+
+  memset(spec,0,sizeof(RUNSPEC));
+
+  for(w=strtok_r(line," \t",&save); w!=NULL; w=strtok_r(NULL," \t",&save)){
+    if(strncmp(w,"--",2)==0) w += 2;
+    if((value=strchr(w,'='))==NULL) return("setting without a value");
+    *value++= '\0';
+
+    if(strcmp(w,"output")==0 || strcmp(w,"output-file")==0){
+      free(spec->Output);
+      spec->Output= CopyString(value,strlen(value));
+    }
+    else if(strcmp(w,"seed")==0){
+      spec->Seed= strtol(value,&end,0);
+      spec->SeedGiven= 1;
+      if(*end!='\0') return("bad seed");
+    }
+    else if(strcmp(w,"trajectory")==0){
+      spec->Trajectory= (int) strtol(value,&end,0);
+      spec->TrajectoryGiven= 1;
+      if(*end!='\0') return("bad trajectory");
+    }
+    else if(strcmp(w,"volume")==0){
+      spec->Volume= (float) strtod(value,&end);
+      spec->VolumeGiven= 1;
+      if(*end!='\0' || spec->Volume<=0.0) return("bad volume");
+    }
+    else if(strcmp(w,"init")==0){
+      spec->Init= (char **) rrealloc(spec->Init,spec->NInits+1,sizeof(char *),"ReadRunSpec");
+      spec->Init[spec->NInits++]= CopyString(value,strlen(value));
+    }
+    else if(strcmp(w,"rate")==0){
+      spec->Rate= (char **) rrealloc(spec->Rate,spec->NRates+1,sizeof(char *),"ReadRunSpec");
+      spec->Rate[spec->NRates++]= CopyString(value,strlen(value));
+    }
+    else return("unknown setting");
+  }
+
+  if(spec->Output==NULL) return("no output file");
+  return(NULL);
+}
+
+/* Collect runs that have finished, waiting for one if block */
+static void Reap(block)
+int block;
+{
+  int i,status;
+  pid_t pid;
+
+  while(NRunning>0 && (pid=waitpid(-1,&status,(block ? 0 : WNOHANG)))>0){
+    for(i=0; i<Jobs && RunPid[i]!=pid; i++);
+    if(i==Jobs) continue;
+
+    if(WIFEXITED(status) && WEXITSTATUS(status)==0)
+      fprintf(Reply,"done %s\n",RunOutput[i]);
+    else
+      fprintf(Reply,"failed %s %d\n",RunOutput[i],
+	      (WIFEXITED(status) ? WEXITSTATUS(status) : -WTERMSIG(status)));
+    fflush(Reply);
+
+    free(RunOutput[i]);
+    RunOutput[i]= NULL;
+    RunPid[i]= 0;
+    NRunning--;
+    block= 0;
+  }
+}
+
+/* Fork a process for the run of spec */
+static void StartRun(spec)
+RUNSPEC *spec;
+{
+  int i,status;
+  pid_t pid;
+
+  int RunForkedSpec();
+
+  while(NRunning==Jobs) Reap(1);
+  for(i=0; RunPid[i]!=0; i++);
+
+  /* Otherwise buffered output would be written by the run as well */
+  fflush(NULL);
+
+  if((pid= fork()) < 0){
+    perror(progid);
+    exit(-1);
+  }
+
+  if(pid==0){
+    /*
+     * The run leaves without exit(): closing the input it shares with
+     * the server could move the server's position in it.
+     */
+    status= RunForkedSpec(spec);
+    fflush(logfp);
+    _exit(status);
+  }
+
+  RunPid[i]= pid;
+  RunOutput[i]= CopyString(spec->Output,strlen(spec->Output));
+  NRunning++;
+}
+
+/* Serve the runs read from in until its end; TRUE if asked to quit */
+static int Serve(in)
+FILE *in;
+{
+  char line[4096],*c,*error;
+  RUNSPEC spec;
+
+  while(fgets(line,sizeof(line),in)!=NULL){
+    if((c=strpbrk(line,"#\r\n"))!=NULL) *c= '\0';
+    for(c=line; *c==' ' || *c=='\t'; c++);
+    if(*c=='\0') continue;
+
+    if(strncmp(c,"quit",4)==0) break;
+
+    if((error=ReadRunSpec(c,&spec))!=NULL){
+      fprintf(Reply,"error %s\n",error);
+      fflush(Reply);
+    }
+    else
+      StartRun(&spec);
+    FreeRunSpec(&spec);
+
+    Reap(0);
+  }
+
+  while(NRunning>0) Reap(1);
+
+  return(!feof(in) && !ferror(in));
+}
+
+/*
+ * Serve runs from source: "-" for stdin, a file or named pipe, or
+ * else the path of a Unix socket to listen on.  jobs<=0 means one
+ * run at a time per processor.
+ */
+void RunForkServer(source,jobs)
+char *source;
+int jobs;
+{
+  int sock,conn,quit;
+  FILE *in;
+  struct stat st;
+  struct sockaddr_un addr;
+
+  Jobs= (jobs>0 ? jobs : (int) sysconf(_SC_NPROCESSORS_ONLN));
+  if(Jobs<1) Jobs= 1;
+  RunPid=    (pid_t *) rcalloc(Jobs,sizeof(pid_t),"RunForkServer");
+  RunOutput= (char **) rcalloc(Jobs,sizeof(char *),"RunForkServer");
+
+  if (DebugLevel > 1)
+    fprintf(logfp,"Serving runs from %s, %d at a time\n",source,Jobs);
+
+  if(strcmp(source,"-")==0 || (stat(source,&st)==0 && !S_ISSOCK(st.st_mode))){
+    Reply= stdout;
+    if(strcmp(source,"-")==0) in= stdin;
+    else if((in=fopen(source,"r"))==NULL){
+      perror(source);
+      exit(1);
+    }
+    Serve(in);
+    if(in!=stdin) fclose(in);
+  }
+  else {
+    if(strlen(source)>=sizeof(addr.sun_path)){
+      fprintf(stderr,"%s: socket name %s is too long\n",progid,source);
+      exit(1);
+    }
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family= AF_UNIX;
+    strcpy(addr.sun_path,source);
+
+    /* A client that goes away early must not take the server with it */
+    signal(SIGPIPE,SIG_IGN);
+
+    unlink(source);
+    if((sock=socket(AF_UNIX,SOCK_STREAM,0))<0 ||
+       bind(sock,(struct sockaddr *) &addr,sizeof(addr))<0 ||
+       listen(sock,8)<0){
+      perror(source);
+      exit(1);
+    }
+
+    for(quit=0; !quit; ){
+      if((conn=accept(sock,NULL,NULL))<0){
+	perror(source);
+	continue;
+      }
+      in=    fdopen(conn,"r");
+      Reply= fdopen(dup(conn),"w");
+      quit= Serve(in);
+      fclose(Reply);
+      fclose(in);
+    }
+
+    close(sock);
+    unlink(source);
+  }
+
+  free(RunPid);
+  free(RunOutput);
+}
@@ -0,0 +1,27 @@
+/**********************
+ *
+ * Fork server: one run a process, from one parse (see ForkServer.c)
+ *
+ **********************/
+#define FORKSERVER
+
+typedef struct runspec RUNSPEC;
+
+/* A run asked of the server; what is not given is as the server was started */
+struct runspec {
+  char   *Output;       /* Output file */
+  long    Seed;
+  short   SeedGiven;
+  int     Trajectory;
+  short   TrajectoryGiven;
+  float   Volume;       /* As --volume, and read to the same precision */
+  short   VolumeGiven;
+  int     NInits;       /* As --init name=val */
+  char  **Init;
+  int     NRates;       /* As --rate kN=val */
+  char  **Rate;
+};
+
+extern char *ReadRunSpec(char *, RUNSPEC *);
+extern void  FreeRunSpec(RUNSPEC *);
+extern void  RunForkServer(char *, int);
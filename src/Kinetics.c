@@ -53,11 +53,12 @@ void SubmitKinetics()
 
 
   for(i=0; i<NMassAction; i++){
-    prob= ReactionProbability[i];
+    prob= Sim->Rates[i];
 
+    order=0;
     nmolecs=0;
     for(j=0; j<NSpecies; j++){
-      prob *= (double) bico(Concentration[j],StoMat1[i][j]);
+      prob *= (double) bico(Sim->Concentration[j],StoMat1[i][j]);
       nmolecs += StoMat1[i][j];
     }
     
@@ -67,7 +68,7 @@ void SubmitKinetics()
       order= nmolecs-1; /* Note that if reaction is zeroth order then it is multiplied by an inverse volume
 			 * This assumes that these reactions work to maintain molarity....
 			 */
-      prob *= pow(EColi->V0/EColi->V,(double) order);
+      prob *= pow(Sim->EColi->V0/Sim->EColi->V,(double) order);
     }
     /* Make Reaction */
 
@@ -76,6 +77,7 @@ void SubmitKinetics()
       reaction->Type=          Reaction_Type_Kinetic;
       reaction->ReactionFunc=  MassAction;
       reaction->Probability=   prob;    
+      reaction->VolumeOrder=   order;
       rdata= (REACTDATA *) rcalloc(1,sizeof(REACTDATA), "SubmitKinetics");
       rdata->Mu=i;
       reaction->ReactionData=  (void *) rdata;
@@ -96,7 +98,7 @@ void *rdata;
   mu= data->Mu;
   
    for(i=0; i<NSpecies; i++){
-      Concentration[i] += StoMat2[mu][i] - StoMat1[mu][i];
+      Sim->Concentration[i] += StoMat2[mu][i] - StoMat1[mu][i];
    }
 }
 
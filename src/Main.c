@@ -29,6 +29,7 @@
 /* Modifications by R. M. Murray, 1 Oct 09 */
 #ifdef RMM_MODS
 #include <time.h>
+#include <unistd.h>
 #include "param.h"
 #include "cmdline.h"
 struct gengetopt_args_info args_info;
@@ -46,6 +47,38 @@ struct gengetopt_args_info args_info;
   #include "Memory.h"
 #endif
 
+#ifndef RANDOM
+  #include "Rng.h"
+#endif
+
+#ifndef SWEEP
+  #include "Sweep.h"
+#endif
+
+#ifndef FORKSERVER
+  #include "ForkServer.h"
+#endif
+
+#ifndef OUTPUT
+  #include "Output.h"
+#endif
+
+#ifndef DISTRIBUTE
+  #include "Distribute.h"
+#endif
+
+#ifndef FATE
+  #include "Fate.h"
+#endif
+
+#ifndef TARGET
+  #include "Target.h"
+#endif
+
+#ifndef STATS
+  #include "Stats.h"
+#endif
+
 /****** Object Parameters (see DataStructures.h) ********/
 
 double Rate_Of_Polymerase_Motion,Rate_Of_RNAP_Collision_Escape,Rate_Of_RNAP_Collision_Failure;
@@ -58,42 +91,25 @@ char       **Mechanism;
 
 int        NSpecies=2;
 char     **SpeciesName;
-int       *Concentration;
-
-int        NOperators=0;
-SHEADATA  *Operator;
-
-int        NSequences=0;
-DNA       *Sequence;
-
-#ifdef RMM_MODS
-int        NPromotors=0;
-PROMOTOR   **Promotor = NULL;
-#endif
 
-int        NTranscripts=0;
-mRNA      *Transcript;
+int        NSeqTemplates=0;
+SEQTEMPLATE **SeqTemplate=NULL;
 
 int        NMassAction=0;
 int      **StoMat1;
 int      **StoMat2;
 double    *ReactionProbability;
 
-int        NReactions=0;
-REACTION  *Reaction;
-double     TotalProbability=0.0;
-double    *Probabilities;
-
-CELL      *EColi;
-
-double Time;
 double MaximumTime;
 long SEED;
 
 /* Configuration parameters */
 char *SystemFile, *ConfigPath;
-double PrintTime,WriteTime;
+double PrintTime;
 char progid[80];
+
+/* Operators and promotors listed in the header; copies added later are not written */
+int NOutputOperators, NOutputPromotors;
 FILE *ofp = NULL, *logfp = NULL;
 
 /* Function declarations */
@@ -103,20 +119,13 @@ int main(argc, argv)
 int argc;
 char **argv;
 {
-  int i,j;
-  int rcnt;
-  double tau;
-  REACTION *reaction=NULL;
-  
-  void SetAckersState();
-  void Polymerize();
-  void SubmitKinetics();
-  REACTION *SelectReaction();
-  void ExecuteReaction();
-  void FreeReactionQueue();
+  void StartLineage();
+  void WaitForDaughters();
+  char *CellOutputName();
   void ParseOutline();
-  void WriteSpeciesState();
   void FillBicoTable();
+  void RunTrajectory();
+  int RunEnsemble();
 
   strcpy(progid,argv[0]);
 
@@ -171,9 +180,88 @@ char **argv;
       exit(1);
   }
 
+  /* A sweep runs its points as an ensemble, one trial each unless given */
+  if (args_info.sweep_given && !args_info.ensemble_given) {
+    args_info.ensemble_given = 1;
+    args_info.ensemble_arg = 1;
+  }
+  if (args_info.lineage_given && args_info.ensemble_given) {
+    fprintf(stderr, "%s: --lineage can't be used with --ensemble or --sweep\n",
+	    progid);
+    exit(1);
+  }
+  if (args_info.fork_server_given &&
+      (args_info.lineage_given || args_info.ensemble_given || 
+       args_info.output_file_given)) {
+    fprintf(stderr, "%s: --fork-server takes the output file of each run from "
+	    "its spec, and can't be used with --lineage, --ensemble or --sweep\n",
+	    progid);
+    exit(1);
+  }
+  if ((args_info.coordinator_given || args_info.worker_given) &&
+      (args_info.lineage_given || args_info.ensemble_given || 
+       args_info.output_file_given || args_info.fork_server_given ||
+       (args_info.coordinator_given && args_info.worker_given))) {
+    fprintf(stderr, "%s: --coordinator and --worker take the output file of "
+	    "each run from its spec, and can't be used with each other, "
+	    "--lineage, --ensemble, --sweep or --fork-server\n", progid);
+    exit(1);
+  }
+  if (args_info.target_given &&
+      (!args_info.ensemble_given || args_info.sweep_given ||
+       args_info.half_width_arg <= 0)) {
+    fprintf(stderr, "%s: --target requires --ensemble, as the most trajectories "
+	    "to run, and --half-width > 0, and can't be used with --sweep\n",
+	    progid);
+    exit(1);
+  }
+  if ((args_info.stats_flag && (!args_info.ensemble_given || args_info.sweep_given)) ||
+      (args_info.stats_only_flag && !args_info.stats_flag)) {
+    fprintf(stderr, "%s: --stats requires --ensemble and can't be used with "
+	    "--sweep; --stats-only requires --stats\n", progid);
+    exit(1);
+  }
+
+  if (args_info.writer_flag &&
+      (args_info.lineage_given || args_info.fork_server_given)) {
+    fprintf(stderr, "%s: --writer is a thread, which the processes forked by "
+	    "--lineage and --fork-server don't have\n", progid);
+    exit(1);
+  }
+
+  /* Text, binary or delta output, flushed as asked and maybe written by a thread (see Output.c) */
+  SetupOutput(args_info.output_format_arg, args_info.flush_arg,
+	      args_info.keyframe_arg, args_info.header_flag);
+  if (args_info.writer_flag) StartWriter(args_info.writer_rows_arg);
+
   /* Set the output file handle */
   ofp = stdout;
-  if (args_info.output_file_given) {
+  if (args_info.lineage_given) {
+    /* Every cell of a lineage writes its own file (see OpenCellOutput()) */
+    if (!args_info.output_file_given) {
+      fprintf(stderr, "%s: --lineage requires --output-file\n", progid);
+      exit(1);
+    }
+    if (args_info.lineage_arg < 0 || args_info.lineage_arg > 20) {
+      fprintf(stderr, "%s: --lineage must be between 0 and 20 generations\n",
+	      progid);
+      exit(1);
+    }
+    if ((ofp = fopen(CellOutputName(0), "w")) == NULL) {
+      perror(CellOutputName(0));
+      exit(1);
+    }
+  } else if (args_info.ensemble_given) {
+    /* Every trajectory of an ensemble writes its own file (see RunEnsembleMember()) */
+    if (!args_info.output_file_given) {
+      fprintf(stderr, "%s: --ensemble and --sweep require --output-file\n", progid);
+      exit(1);
+    }
+    if (args_info.ensemble_arg < 1) {
+      fprintf(stderr, "%s: --ensemble must be at least 1\n", progid);
+      exit(1);
+    }
+  } else if (args_info.output_file_given) {
     /* Open up a file for storing the simulation output */
     if ((ofp = fopen(args_info.output_file_arg, "w")) == NULL) {
       perror(args_info.output_file_arg);
@@ -205,11 +293,9 @@ char **argv;
    *
    ************/
 
-  FillReactionBlock();
-  FillRNAPBlock();
-  FillRibosomeBlock();
-  FillMRNAPBlock();
-  FillMRibosomeBlock();
+  /* The outline is parsed into the context of this run */
+  Sim= NewSimContext(NULL,NULL);
+  Sim->Output= ofp;
 
   /* Create "RNAP" and "Ribosome" species */
   SpeciesName= (char **) rcalloc((size_t) 2,(size_t) sizeof(char *),"main");
@@ -217,8 +303,8 @@ char **argv;
   strcpy(SpeciesName[0],"RNAP");
   SpeciesName[1]= (char *) rcalloc(9,sizeof(char),"main");
   strcpy(SpeciesName[1],"Ribosome");
-  Concentration= (int *) rcalloc(2,sizeof(int),"main");
-  Concentration[0]=Concentration[1]=0;
+  Sim->Concentration= (int *) rcalloc(2,sizeof(int),"main");
+  Sim->Concentration[0]=Sim->Concentration[1]=0;
 
   /* 
    * Allocate space for stoichiometry matrices and reaction probabilities
@@ -252,16 +338,16 @@ char **argv;
   /* Set cell volume */
   if (args_info.volume_given) {
     if (DebugLevel > 1)
-      fprintf(logfp, "Resetting initial cell volume from %g", EColi->VI);
-    EColi->V = (EColi->VI *= args_info.volume_arg);
+      fprintf(logfp, "Resetting initial cell volume from %g", Sim->EColi->VI);
+    Sim->EColi->V = (Sim->EColi->VI *= args_info.volume_arg);
     if (DebugLevel > 1)
-      fprintf(logfp, " to %g\n", EColi->VI);
+      fprintf(logfp, " to %g\n", Sim->EColi->VI);
 
     /* See if we should scale initial conditions */
     if (args_info.scale_init_given) {
       int i;
       for (i = 0; i < NSpecies; ++i)
-	Concentration[i] *= args_info.volume_arg;
+	Sim->Concentration[i] *= args_info.volume_arg;
 
       if (DebugLevel > 1) fprintf(logfp, "Scaling initial concentrations\n");
     }
@@ -270,10 +356,33 @@ char **argv;
   /* Set growth rate */
   if (args_info.growth_given) {
     if (DebugLevel > 1)
-      fprintf(logfp, "Resetting cell growth rate from %g", EColi->GrowthRate);
-    EColi->GrowthRate *= args_info.growth_arg;
+      fprintf(logfp, "Resetting cell growth rate from %g", Sim->EColi->GrowthRate);
+    Sim->EColi->GrowthRate *= args_info.growth_arg;
+    if (DebugLevel > 1)
+      fprintf(logfp, " to %g\n", Sim->EColi->GrowthRate);
+  }
+
+  /* Grow the cell continuously rather than in Balloon steps */
+  if (args_info.continuous_growth_given) {
     if (DebugLevel > 1)
-      fprintf(logfp, " to %g\n", EColi->GrowthRate);
+      fprintf(logfp, "Using continuous cell growth\n");
+    Sim->EColi->Continuous= 1;
+    Sim->EColi->TV= 0.0;
+  }
+
+  /* Follow both daughters at division */
+  if (args_info.lineage_given) {
+    char *name;
+
+    if (DebugLevel > 1)
+      fprintf(logfp, "Following the lineage for %d generations\n",
+	      args_info.lineage_arg);
+    Sim->EColi->MaxGeneration= args_info.lineage_arg;
+
+    name= (char *) rcalloc(strlen(args_info.output_file_arg)+9,sizeof(char),"main");
+    sprintf(name,"%s.lineage",args_info.output_file_arg);
+    StartLineage(name,args_info.threads_arg);
+    free(name);
   }
 
   /* Determine if we should allow cell division */
@@ -281,7 +390,7 @@ char **argv;
     if (DebugLevel > 1)
       fprintf(logfp, "Resetting cell volume to stop cell division\n");
     /* HACK: set cell division size to something huge */
-    EColi->VI *= 1000;
+    Sim->EColi->VI *= 1000;
   }
 
   /* Set parameter values */
@@ -339,13 +448,38 @@ char **argv;
 	/* We found a match */
 	fprintf(logfp, "  resetting initial concentration for species %s",
 		SpeciesName[j]);
-	fprintf(logfp, " from %d to %d\n", Concentration[j], val);
-	Concentration[j] = val;
+	fprintf(logfp, " from %d to %d\n", Sim->Concentration[j], val);
+	Sim->Concentration[j] = val;
       } else {
 	fprintf(stderr, "  couldn't find species %s\n", name);
       }
     }
   }
+
+  /* Read the sweep; its points are applied to the contexts of the runs */
+  if (args_info.sweep_given) {
+    if (args_info.volume_given || args_info.growth_given) {
+      int i;
+      for (i = 0; i < args_info.sweep_given; ++i)
+	if (strncmp(args_info.sweep_arg[i], "volume", 6) == 0 ||
+	    strncmp(args_info.sweep_arg[i], "growth", 6) == 0) {
+	  fprintf(stderr, "%s: '%s' can't be swept with --volume or --growth\n",
+		  progid, args_info.sweep_arg[i]);
+	  exit(1);
+	}
+    }
+    SetupSweep(args_info.sweep_given, args_info.sweep_arg,
+	       args_info.sweep_list_flag, args_info.scale_init_given);
+  }
+
+  /* Runs end early when a stop condition decides their fate */
+  if (args_info.stop_given)
+    SetupStops(args_info.stop_given, args_info.stop_arg);
+
+  /* An adaptive ensemble runs until its target is met */
+  if (args_info.target_given)
+    SetupTarget(args_info.target_arg, args_info.half_width_arg,
+		args_info.ensemble_arg);
 #else  
   /****************
    *
@@ -360,11 +494,17 @@ char **argv;
 #endif
   if (DebugLevel > 2)
     fprintf(logfp, "SEED = %ld\n", SEED);
-  srand48(SEED);
+#ifdef RMM_MODS
+  RngInit(Sim->Rng,(unsigned long) SEED,(unsigned long) args_info.trajectory_arg);
+#else
+  RngInit(Sim->Rng,(unsigned long) SEED,0UL);
+#endif
+
+  Sim->Rates= ReactionProbability;
 
   DEBUG(20){
-    fprintf(logfp,"@@@ NOperators  = %d\n", NOperators);
-    fprintf(logfp,"@@@ NSequences  = %d\n", NSequences);
+    fprintf(logfp,"@@@ NOperators  = %d\n", Sim->NOperators);
+    fprintf(logfp,"@@@ NSequences  = %d\n", Sim->NSequences);
     fprintf(logfp,"@@@ NMassAction = %d\n", NMassAction);
     fprintf(logfp,"@@@ NSpecies    = %d\n", NSpecies);
   }
@@ -373,6 +513,8 @@ char **argv;
    * Print out headers and setup files
    *
    */
+  NOutputOperators= Sim->NOperators;
+
 #ifdef RMM_MODS
   FILE *matlab_fp = NULL;
 
@@ -391,47 +533,109 @@ char **argv;
     generateSetupScript(args_info.python_setup_arg, "#", "", 0);
   }
 
-  if (args_info.header_flag) {
-# endif
-    fprintf(ofp,"%% Time\tNR\tRPQ\t");
-    for(i=0;i<NSpecies;i++)
-      fprintf(ofp,"%6s\t",SpeciesName[i]);
-    fprintf(ofp,"%6s\t","Volume");
-    for(i=0;i<NOperators; i++)
-      fprintf(ofp,"%6s\t",&Operator[i].Name[8]);
+  NOutputPromotors= Sim->NPromotors;
+
+  if (!args_info.ensemble_given && !args_info.fork_server_given &&
+      !args_info.coordinator_given && !args_info.worker_given)
+    BeginOutput(NULL);
+# else
+  BeginOutput(NULL);
+#endif
+
 #ifdef RMM_MODS
-    /* RNAP counts */
-    if (args_info.pops_given) {
-      for (i = 0; i < NPromotors; ++i)
-	fprintf(ofp, "%6s-RNAP\t", Promotor[i]->Name);
+  /* The statistics of an ensemble are taken as it runs, on its columns */
+  if (args_info.stats_flag)
+    SetupStats(args_info.stats_quantiles_arg, args_info.stats_bins_arg,
+	       args_info.ensemble_arg);
+
+  if (args_info.sweep_given) {
+    char *name;
+
+    name= (char *) rcalloc(strlen(args_info.output_file_arg)+7,sizeof(char),"main");
+    sprintf(name,"%s.index",args_info.output_file_arg);
+    WriteSweepIndex(name,args_info.output_file_arg,args_info.ensemble_arg);
+    free(name);
+
+    RunEnsemble(Sim,NSweepPoints()*args_info.ensemble_arg,args_info.threads_arg,0);
+  }
+  else if (args_info.ensemble_given && Adaptive) {
+    int n,started;
+    char *name;
+
+    started= RunEnsemble(Sim,args_info.ensemble_arg,args_info.threads_arg,1);
+    n= ReportTarget(stdout);
+    if (Stats) WriteStats(args_info.output_file_arg,args_info.header_flag);
+
+    /* Trajectories run past the target are not part of the ensemble */
+    name= (char *) rcalloc(strlen(args_info.output_file_arg)+16,sizeof(char),"main");
+    for (; n < started; n++) {
+      sprintf(name,"%s.%d",args_info.output_file_arg,n);
+      unlink(name);
     }
-    fprintf(ofp,"\n");
+    free(name);
   }
-# else
-  fprintf(ofp,"\n");
+  else if (args_info.ensemble_given) {
+    RunEnsemble(Sim,args_info.ensemble_arg,args_info.threads_arg,Stats);
+    if (Stats) WriteStats(args_info.output_file_arg,args_info.header_flag);
+  }
+  else if (args_info.fork_server_given)
+    RunForkServer(args_info.fork_server_arg,args_info.threads_arg);
+  else if (args_info.coordinator_given)
+    RunCoordinator(args_info.coordinator_arg);
+  else if (args_info.worker_given)
+    WorkForCoordinator(args_info.worker_arg,args_info.threads_arg);
+  else
+    RunTrajectory();
+  StopWriter();
+#else
+  RunTrajectory();
 #endif
 
-  /********************
-   *
-   * Main Loop 
-   *
-   ********************/
+  FreeSimContext(Sim);
+
+  WaitForDaughters();
+  exit(0);
+}
+
+
+/*
+ * Run the current context from time 0 to MaximumTime, writing its
+ * state every PrintTime to Sim->Output.  A stop condition that
+ * decides the fate (see Fate.c) ends the run with a row at the time
+ * of the decision and the fate.
+ */
+void RunTrajectory()
+{
+  int rcnt;
+  long nqueued;
+  int superinfected=0;
+  double tau;
+  REACTION *reaction=NULL;
+
+  void SetOperatorStates();
+  void Superinfect();
+  void Polymerize();
+  void SubmitKinetics();
+  void SubmitCellReactions();
+  REACTION *SelectReaction();
+  void ExecuteReaction();
+  void GrowCell();
+  void DivideCell();
+  void FreeReactionQueue();
+  void WriteSpeciesState();
 
   WriteSpeciesState(0.0,0,0.0);
-  Time=0.0;
-  WriteTime= Time+PrintTime;
+  Sim->Time=0.0;
+  Sim->WriteTime= Sim->Time+PrintTime;
   rcnt=0;
-  SEED=0;
+  nqueued=0;
+  if (NStops > 0) StartStops();
   do {
+    if (NStops > 0 && CheckStops()) break;
+
     /* Set Promotor States (Assumed Rapid-Equilibrium) */
 
-    /*** Randomly set operator precedence ***/
-    j= (int) ((double) NOperators*drand48());
-    for(i=0; i<NOperators; i++){     
-      SetAckersState(&Operator[j]);
-      j++;
-      if(j==NOperators) j=0;
-    }
+    SetOperatorStates();
         
     /* Submit All Genetic Reactions, execute all current genetic Actions */
     
@@ -449,16 +653,45 @@ char **argv;
 
     reaction= (REACTION *) SelectReaction(&tau);
 
-    if(Time+tau > MaximumTime) break;
-    while(Time+tau > WriteTime){
-      WriteSpeciesState(WriteTime,rcnt,(rcnt> 0 ? (double) SEED/rcnt : 0.0));
-      WriteTime= WriteTime+PrintTime;
+    /* 
+     * Superinfection: stop the clock at the time of infection and
+     * start the step again with the new copies.  Discarding the draw
+     * is exact, as the waiting times are exponential.
+     */
+    if(args_info.superinfect_given && !superinfected &&
+       Sim->Time+tau > args_info.superinfect_arg && args_info.superinfect_arg <= MaximumTime){
+      while(args_info.superinfect_arg > Sim->WriteTime){
+	GrowCell(Sim->WriteTime);
+	WriteSpeciesState(Sim->WriteTime,rcnt,(rcnt> 0 ? (double) nqueued/rcnt : 0.0));
+	Sim->WriteTime= Sim->WriteTime+PrintTime;
+	rcnt=0;
+      }
+      if (DebugLevel)
+	fprintf(logfp, "Superinfection by %d phage at %g\n",
+		args_info.superinfect_moi_arg, args_info.superinfect_arg);
+      if (args_info.superinfect_arg > Sim->Time) Sim->Time= args_info.superinfect_arg;
+      GrowCell(Sim->Time);
+      Superinfect(args_info.superinfect_moi_arg);
+      superinfected=1;
+      FreeReactionQueue();
+      continue;
+    }
+
+    if(Sim->Time+tau > MaximumTime) break;
+    while(Sim->Time+tau > Sim->WriteTime){
+      GrowCell(Sim->WriteTime);
+      WriteSpeciesState(Sim->WriteTime,rcnt,(rcnt> 0 ? (double) nqueued/rcnt : 0.0));
+      Sim->WriteTime= Sim->WriteTime+PrintTime;
       rcnt=0;
     }
 
-    ExecuteReaction(reaction);
+    /* A continuously growing cell divides when no reaction is chosen */
+    Sim->Time += tau;    
+    GrowCell(Sim->Time);
+    if(reaction==NULL) DivideCell();
+    else ExecuteReaction(reaction);
     rcnt++;
-    SEED+=NReactions;
+    nqueued+=Sim->NReactions;
     /*    
     fprintf(logfp,"NR= %d\t",NReactions);    
     fprintf(logfp,"react= %d\trnap= %d\tribo= %d\tmrnap= %d\tmribo= %d\n",
@@ -470,65 +703,298 @@ char **argv;
 	    );
     */
     FreeReactionQueue();
-    Time += tau;    
 
-  } while(Time<=MaximumTime);
+  } while(Sim->Time<=MaximumTime);
+
+  if (NStops > 0 && Sim->Fate >= 0) {
+    WriteSpeciesState(Sim->FateTime,rcnt,(rcnt> 0 ? (double) nqueued/rcnt : 0.0));
+    if (Sim->Output != NULL) EndOutput(Sim->Fate,Sim->FateTime);
+    return;
+  }
   
-  while(Time<MaximumTime){
-    WriteSpeciesState(WriteTime,rcnt,(rcnt> 0 ? (double) SEED/rcnt : 0.0));
-    WriteTime= WriteTime+PrintTime;
+  while(Sim->Time<MaximumTime){
+    GrowCell(Sim->WriteTime);
+    WriteSpeciesState(Sim->WriteTime,rcnt,(rcnt> 0 ? (double) nqueued/rcnt : 0.0));
+    Sim->WriteTime= Sim->WriteTime+PrintTime;
     rcnt=0;
-    Time += PrintTime;
+    Sim->Time += PrintTime;
   }
 
-  WriteSpeciesState(WriteTime,rcnt,(rcnt> 0 ? (double) SEED/rcnt : 0.0));
+  GrowCell(Sim->WriteTime);
+  WriteSpeciesState(Sim->WriteTime,rcnt,(rcnt> 0 ? (double) nqueued/rcnt : 0.0));
+  if (Sim->Output != NULL) EndOutput(-1,0.0);
+}
 
-  EmptyReactionBlock();
-  EmptyRNAPBlock();
-  EmptyRibosomeBlock();
-  EmptyMRNAPBlock();
-  EmptyMRibosomeBlock();
 
-  exit(0);
+/* Print the column headings */
+void WriteHeader()
+{
+  int i;
+
+  fprintf(Sim->Output,"%% Time\tNR\tRPQ\t");
+  for(i=0;i<NSpecies;i++)
+    fprintf(Sim->Output,"%6s\t",SpeciesName[i]);
+  fprintf(Sim->Output,"%6s\t","Volume");
+  for(i=0;i<NOutputOperators; i++)
+    fprintf(Sim->Output,"%6s\t",&Sim->Operator[i].Name[8]);
+#ifdef RMM_MODS
+  /* RNAP counts */
+  if (args_info.pops_given) {
+    for (i = 0; i < NOutputPromotors; ++i)
+      fprintf(Sim->Output, "%6s-RNAP\t", SegmentName(Sim->Promotor[i]->Segment));
+  }
+#endif
+  fprintf(Sim->Output,"\n");
+}
+
+#ifdef RMM_MODS
+/* Name of the output file of cell id in lineage mode */
+char *CellOutputName(id)
+int id;
+{
+  static char *name=NULL;
+
+  name= (char *) rrealloc(name,strlen(args_info.output_file_arg)+16,sizeof(char),"CellOutputName");
+  sprintf(name,"%s.%d",args_info.output_file_arg,id);
+  return(name);
 }
 
+/*
+ * Run trajectory k of an ensemble (see Ensemble.c) in a context of
+ * its own, made from proto with objects from pools, and write it to
+ * output-file.k (but with --stats-only; see Stats.c).  In a sweep it is trial k%N of point k/N, for N
+ * trials a point; otherwise trial k.  Trial t draws from stream t
+ * (past any --trajectory), so it is the trajectory a single run with
+ * --trajectory=t would give, and the points share their streams.
+ */
+void RunEnsembleMember(proto,k,pools)
+SIMCONTEXT *proto;
+int k;
+struct mempools *pools;
+{
+  int trial;
+  char *name;
+
+  void RunTrajectory();
+
+  Sim= NewSimContext(proto,pools);
+  trial= k%args_info.ensemble_arg;
+  if (args_info.sweep_given) ApplySweepPoint(k/args_info.ensemble_arg);
+  RngInit(Sim->Rng,(unsigned long) SEED,(unsigned long) (args_info.trajectory_arg+trial));
+
+  /* Rows are kept for the statistics, which may be all that's written */
+  Sim->KeepRows= Stats;
+  Sim->Output= NULL;
+  if (!args_info.stats_only_flag) {
+    name= (char *) rcalloc(strlen(args_info.output_file_arg)+16,sizeof(char),"RunEnsembleMember");
+    sprintf(name,"%s.%d",args_info.output_file_arg,k);
+    if ((Sim->Output = fopen(name, "w")) == NULL) {
+      perror(name);
+      exit(1);
+    }
+    free(name);
+    BeginOutput(NULL);
+  }
 
-void WriteSpeciesState(t,cnt,rpq)
-double t,rpq;
-int cnt;
+  RunTrajectory();
+  if (Adaptive) AddTargetRun(k);
+  if (Stats) AddStatsRun(k);
+
+  if (Sim->Output != NULL) fclose(Sim->Output);
+  FreeSimContext(Sim);
+}
+
+/*
+ * Apply the settings of spec, a run asked of the fork server (see
+ * ForkServer.c) or of a coordinator (see Distribute.c), to the
+ * current context, as the options of the same names are applied by
+ * main(), and read as floats as they are.  Rates are set in a copy of
+ * the context's own.  Returns FALSE, or TRUE if spec can't be applied.
+ */
+int ApplyRunSpec(spec)
+RUNSPEC *spec;
 {
+  int i,j,index,val;
+  float rate;
+  double *rates;
+  char name[256];
 
-  int i;
+  int FindSpecies();
 
-  /* Print some information for the user */
-  if (DebugLevel) {
-    fprintf(stderr, "%g: \tCNT = %d, RPQ = %e\n", t, cnt, rpq);
+  RngInit(Sim->Rng,(unsigned long) (spec->SeedGiven ? spec->Seed : SEED),
+	  (unsigned long) (spec->TrajectoryGiven ? spec->Trajectory : args_info.trajectory_arg));
+
+  if (spec->VolumeGiven) {
+    Sim->EColi->V  *= spec->Volume;
+    Sim->EColi->VI *= spec->Volume;
+    if (args_info.scale_init_given)
+      for (i = 0; i < NSpecies; ++i)
+	Sim->Concentration[i] *= spec->Volume;
   }
 
-  fprintf(ofp,"%e\t%d\t%e\t",t,cnt,rpq);
-  for(i=0; i<NSpecies; i++)
-    fprintf(ofp,"%7d\t",Concentration[i]);
+  if (spec->NRates > 0 && !Sim->OwnRates) {
+    rates= (double *) rcalloc(NMassAction+1,sizeof(double),"ApplyRunSpec");
+    memcpy(rates,Sim->Rates,NMassAction*sizeof(double));
+    Sim->Rates= rates;
+    Sim->OwnRates= 1;
+  }
+  for (i = 0; i < spec->NRates; ++i) {
+    if (sscanf(spec->Rate[i], "k%d=%g", &index, &rate) != 2 ||
+	index < 0 || index >= NMassAction) {
+      fprintf(logfp, "%s: bad rate '%s' for %s\n", progid, spec->Rate[i],
+	      spec->Output);
+      return(1);
+    }
+    Sim->Rates[index] = rate;
+  }
+
+  for (i = 0; i < spec->NInits; ++i) {
+    if (sscanf(spec->Init[i], "%255[^=]=%d", name, &val) != 2 ||
+	(j = FindSpecies(name)) == NSpecies) {
+      fprintf(logfp, "%s: bad initial condition '%s' for %s\n", progid,
+	      spec->Init[i], spec->Output);
+      return(1);
+    }
+    Sim->Concentration[j] = val;
+  }
+  return(0);
+}
+
+/*
+ * Make the run of spec in a process forked by the fork server: the
+ * context the outline was parsed into, and the model, are the copies
+ * of this process.  Returns the exit status of the run.
+ */
+int RunForkedSpec(spec)
+RUNSPEC *spec;
+{
+  void RunTrajectory();
+
+  if (ApplyRunSpec(spec)) return(1);
+
+  if ((Sim->Output = fopen(spec->Output, "w")) == NULL) {
+    perror(spec->Output);
+    return(1);
+  }
+  BeginOutput(NULL);
+
+  RunTrajectory();
+
+  if (fclose(Sim->Output) != 0) {
+    perror(spec->Output);
+    return(1);
+  }
+  return(0);
+}
+
+/*
+ * Switch the output to a newly born cell of the lineage; its mother's
+ * was ended before the division (see SplitCell())
+ */
+void OpenCellOutput(id)
+int id;
+{
+  char *name;
+
+  name= CellOutputName(id);
+  fclose(Sim->Output);
+  if ((Sim->Output = fopen(name, "w")) == NULL) {
+    perror(name);
+    exit(1);
+  }
+  BeginOutput(NULL);
+}
+#endif
+
+/* Number of int columns of a row: species, operators and, with --pops, promotors */
+int SampleColumns()
+{
+  int n;
+
+  n= NSpecies+NOutputOperators;
+#ifdef RMM_MODS
+  if (args_info.pops_given) n += NOutputPromotors;
+#endif
+  return(n);
+}
+
+/* Take the current state into row */
+void TakeSample(row,t,cnt,rpq)
+SAMPLE *row;
+double t,rpq;
+int cnt;
+{
+  int i,*v;
+  void SyncIdleOperatorStates();
+
+  row->Time= t;
+  row->NR=   cnt;
+  row->RPQ=  rpq;
 
 #ifdef RMM_MODS
   /* Use the reference cell size for normalization */
-  fprintf(ofp,"%e\t",EColi->V/EColi->V0);
+  row->Volume= Sim->EColi->V/Sim->EColi->V0;
 #else
-  fprintf(ofp,"%e\t",EColi->V/EColi->VI);
+  row->Volume= Sim->EColi->V/Sim->EColi->VI;
 #endif
 
-  for(i=0; i<NOperators; i++)
-    fprintf(ofp,"%7d\t",Operator[i].CurrentState);
+  v= row->Value;
+  for(i=0; i<NSpecies; i++)
+    *v++= Sim->Concentration[i];
+
+  SyncIdleOperatorStates();
+  for(i=0; i<NOutputOperators; i++)
+    *v++= Sim->Operator[i].CurrentState;
 
 #ifdef RMM_MODS
   if (args_info.pops_given) {
-    /* Print out the number of RNApolymerases for each promoter */
-    for (i = 0; i < NPromotors; ++i)
-      fprintf(ofp, "%7d\t", Promotor[i]->RNAPCount);
+    /* The number of RNA polymerases for each promoter */
+    for (i = 0; i < NOutputPromotors; ++i)
+      *v++= (i < Sim->NPromotors ? Sim->Promotor[i]->RNAPCount : 0);
   }
 #endif
+}
+
+/* Print row as a line of the output */
+void PrintSample(fp,row)
+FILE *fp;
+SAMPLE *row;
+{
+  int i,n;
+
+  n= SampleColumns();
+
+  fprintf(fp,"%e\t%d\t%e\t",row->Time,row->NR,row->RPQ);
+  for(i=0; i<NSpecies; i++)
+    fprintf(fp,"%7d\t",row->Value[i]);
+  fprintf(fp,"%e\t",row->Volume);
+  for(; i<n; i++)
+    fprintf(fp,"%7d\t",row->Value[i]);
+  fprintf(fp,"\n");
+}
 
-  fprintf(ofp,"\n");
-  fflush(ofp);
+void WriteSpeciesState(t,cnt,rpq)
+double t,rpq;
+int cnt;
+{
+  void KeepRow();
+
+  /* Print some information for the user */
+  if (DebugLevel) {
+    fprintf(stderr, "%g: \tCNT = %d, RPQ = %e\n", t, cnt, rpq);
+  }
+
+  if (Sim->Row.Value == NULL)
+    Sim->Row.Value= (int *) rcalloc(SampleColumns()+1,sizeof(int),"WriteSpeciesState");
+  TakeSample(&Sim->Row,t,cnt,rpq);
+  if (Adaptive) TakeTarget(&Sim->Row);
+
+  /*
+   * A worker sends the rows to its coordinator (see Distribute.c), and
+   * the statistics of an ensemble are taken from them (see Stats.c)
+   */
+  if (Sim->KeepRows) KeepRow(&Sim->Row);
+  if (Sim->Output != NULL) PutOutput(&Sim->Row);
 }
 
 void generateSetupScript(char *filename, char *comment, char *prefix, 
@@ -557,15 +1023,15 @@ void generateSetupScript(char *filename, char *comment, char *prefix,
 
   /* Print out cell information */
   fprintf(setup_fp, "\n%s Cell parameters\n", comment);
-  fprintf(setup_fp, "%scell_size_initial = %g;\n", prefix, EColi->VI);
-  fprintf(setup_fp, "%scell_size_reference = %g;\n", prefix, EColi->V0);
-  fprintf(setup_fp, "%scell_growth_rate = %g;\n", prefix, EColi->GrowthRate);
+  fprintf(setup_fp, "%scell_size_initial = %g;\n", prefix, Sim->EColi->VI);
+  fprintf(setup_fp, "%scell_size_reference = %g;\n", prefix, Sim->EColi->V0);
+  fprintf(setup_fp, "%scell_growth_rate = %g;\n", prefix, Sim->EColi->GrowthRate);
 
   /* Print out information about the number of objects of each type */
   fprintf(setup_fp, "\n%s System size\n", comment);
   fprintf(setup_fp, "%sn_species = %d;\n", prefix, NSpecies);
-  fprintf(setup_fp, "%sn_operators = %d;\n", prefix, NOperators);
-  fprintf(setup_fp, "%sn_promoters = %d;\n", prefix, NPromotors);
+  fprintf(setup_fp, "%sn_operators = %d;\n", prefix, Sim->NOperators);
+  fprintf(setup_fp, "%sn_promoters = %d;\n", prefix, Sim->NPromotors);
 
   /* Print out information about the species that are present */
   fprintf(setup_fp, "\n%s Species information\n", comment);
@@ -586,13 +1052,13 @@ void generateSetupScript(char *filename, char *comment, char *prefix,
     fprintf(setup_fp, "%sspecies_%s_index = %d;\n", prefix, 
 	    SpeciesName[i], col++);
   fprintf(setup_fp, "%svolume_index = %d;\n", prefix, col++);
-  for (i=0 ; i < NOperators; ++i)
+  for (i=0 ; i < Sim->NOperators; ++i)
     fprintf(setup_fp, "%soperator_%s_index = %d;\n", prefix, 
-	    Operator[i].Name, col++);
+	    Sim->Operator[i].Name, col++);
   if (args_info.pops_given) {
-    for (i = 0; i < NPromotors; ++i)
+    for (i = 0; i < Sim->NPromotors; ++i)
       fprintf(setup_fp, "%spromoter_%s_index = %d;\n", prefix,
-	      Promotor[i]->Name, col++);
+	      SegmentName(Sim->Promotor[i]->Segment), col++);
   }
     
   /* Close up the file */
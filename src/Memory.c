@@ -16,6 +16,10 @@
   #include <math.h>
 #endif
 
+#ifndef _H_STRING
+  #include <string.h>
+#endif
+
 #ifndef DataStructures
    #include "DataStructures.h"
 #endif
@@ -24,47 +28,108 @@
  #include "Util.h"
 #endif
 
-/* 
 #ifndef MEMORY
  #include "Memory.h"
 #endif
-*/
 
-/* Size of some memory preallocation blocks */
-#define MEM_BLOCK_REACTION  500
-#define MEM_BLOCK_RNAP      150      
-#define MEM_BLOCK_RIBOSOME  150
-#define MEM_BLOCK_MOVERNAP  150
-#define MEM_BLOCK_MOVERIBO  150
+/*
+ * Ribosome lattices (ring buffer plus occupancy bitmap, see
+ * struct transcript) are sized by the length of the gene.  Only a
+ * handful of sizes ever occur, so freed lattices are kept on a free
+ * list per size and handed back out to the next transcript of that
+ * gene.  The first word of a free lattice links it to the next one.
+ */
+
+struct latticepool {
+  size_t  Size;
+  void   *Free;
+};
+
+/*
+ * The preallocated blocks and free lists belong to a simulation
+ * context (see DataStructures.h): contexts run by different
+ * threads never hand each other memory.
+ */
+struct mempools {
+  int       react_mptr_full;
+  REACTION *ReactionMemory[MEM_BLOCK_REACTION];
+
+  int       rnap_mptr_full;
+  RNAP     *RNAPMemory[MEM_BLOCK_RNAP];
+
+  int       mrnap_mptr_full;
+  MOVERNAP *MRNAPMemory[MEM_BLOCK_MOVERNAP];
+
+  int       mribo_mptr_full;
+  MOVERIBO *MRibosomeMemory[MEM_BLOCK_MOVERIBO];
+
+  struct latticepool LatticePool[MEM_LATTICE_SIZES];
+  int       NLatticePools;
+};
+
+/*
+ * Pools with the blocks filled.  A context may have pools of its
+ * own or use those of the thread running it (see NewSimContext()).
+ */
+struct mempools *NewMemoryPools()
+{
+  struct mempools *pools;
+
+  pools= (struct mempools *) rcalloc(1,sizeof(struct mempools),"NewMemoryPools");
+  pools->react_mptr_full= -1;
+  pools->rnap_mptr_full=  -1;
+  pools->mrnap_mptr_full= -1;
+  pools->mribo_mptr_full= -1;
+
+  FillReactionBlock(pools);
+  FillRNAPBlock(pools);
+  FillMRNAPBlock(pools);
+  FillMRibosomeBlock(pools);
+
+  return(pools);
+}
+
+void FreeMemoryPools(pools)
+struct mempools *pools;
+{
+  EmptyReactionBlock(pools);
+  EmptyRNAPBlock(pools);
+  EmptyLatticePools(pools);
+  EmptyMRNAPBlock(pools);
+  EmptyMRibosomeBlock(pools);
 
-int      react_mptr_full= -1;
-REACTION *ReactionMemory[MEM_BLOCK_REACTION];
+  free(pools);
+}
 
-void FillReactionBlock()
+void FillReactionBlock(pools)
+struct mempools *pools;
 {
   int i;
 
   for(i=0; i<MEM_BLOCK_REACTION; i++)
-    ReactionMemory[i]= (REACTION *) 
+    pools->ReactionMemory[i]= (REACTION *) 
       rcalloc(1,sizeof(REACTION),"FillReactionBlock");
 }
 
 REACTION *AllocReaction()
 {
-  react_mptr_full++;
+  struct mempools *pools= Sim->Pools;
+
+  pools->react_mptr_full++;
 
-  if(react_mptr_full>=MEM_BLOCK_REACTION) {
+  if(pools->react_mptr_full>=MEM_BLOCK_REACTION) {
     /* Warn the user if he or she is interested */
     if (DebugLevel > 4)
       fprintf(stderr, "AllocReaction: allocating reaction %d\n",
-	      react_mptr_full);
+	      pools->react_mptr_full);
 
     return( (REACTION *) rcalloc(1,sizeof(REACTION),"AllocReaction"));
   }
 
   /* Take one of the reactions out of the block */
-  REACTION *reaction = ReactionMemory[react_mptr_full];
-  ReactionMemory[react_mptr_full] = NULL;
+  REACTION *reaction = pools->ReactionMemory[pools->react_mptr_full];
+  pools->ReactionMemory[pools->react_mptr_full] = NULL;
+  reaction->VolumeOrder = 0;
 
   return(reaction);
 }
@@ -72,22 +137,24 @@ REACTION *AllocReaction()
 void FreeReaction(react)
 REACTION *react;
 {
+  struct mempools *pools= Sim->Pools;
 
-  if(react_mptr_full>=MEM_BLOCK_REACTION) free(react);
+  if(pools->react_mptr_full>=MEM_BLOCK_REACTION) free(react);
   else
     /* Put the reaction back on the list for later use */
-    ReactionMemory[react_mptr_full]=react;
+    pools->ReactionMemory[pools->react_mptr_full]=react;
   
-    react_mptr_full--;
+    pools->react_mptr_full--;
 }
 
-void EmptyReactionBlock()
+void EmptyReactionBlock(pools)
+struct mempools *pools;
 {
   int i, cnt = 0;
 
   for(i=0; i<MEM_BLOCK_REACTION; i++)
-    if(ReactionMemory[i]!=NULL) {
-      free(ReactionMemory[i]);
+    if(pools->ReactionMemory[i]!=NULL) {
+      free(pools->ReactionMemory[i]);
       ++cnt;
     }
 
@@ -96,34 +163,33 @@ void EmptyReactionBlock()
 }
 
 
-int      rnap_mptr_full= -1;
-RNAP *RNAPMemory[MEM_BLOCK_RNAP];
-
-void FillRNAPBlock()
+void FillRNAPBlock(pools)
+struct mempools *pools;
 {
   int i;
 
   for(i=0; i<MEM_BLOCK_RNAP; i++)
-    RNAPMemory[i]= (RNAP *) rcalloc(1,sizeof(RNAP),"FillRNAPBlock");
+    pools->RNAPMemory[i]= (RNAP *) rcalloc(1,sizeof(RNAP),"FillRNAPBlock");
 }
 
 RNAP *AllocRNAP()
 {
+  struct mempools *pools= Sim->Pools;
 
-  rnap_mptr_full++;
+  pools->rnap_mptr_full++;
 
-  if(rnap_mptr_full>=MEM_BLOCK_RNAP) {
+  if(pools->rnap_mptr_full>=MEM_BLOCK_RNAP) {
     /* Warn the user if he or she is interested */
     if (DebugLevel > 4)
       fprintf(stderr, "AllocRNAP: allocating RNAP %d\n",
-	      react_mptr_full);
+	      pools->react_mptr_full);
 
     return( (RNAP *) rcalloc(1,sizeof(RNAP),"AllocRNAP"));
   }
 
   /* Take one of the RNAPs out of the block */
-  RNAP *rnap = RNAPMemory[rnap_mptr_full];
-  RNAPMemory[rnap_mptr_full] = NULL;
+  RNAP *rnap = pools->RNAPMemory[pools->rnap_mptr_full];
+  pools->RNAPMemory[pools->rnap_mptr_full] = NULL;
 
   return(rnap);
 }
@@ -131,23 +197,25 @@ RNAP *AllocRNAP()
 void FreeRNAP(rnap)
 RNAP *rnap;
 {
+  struct mempools *pools= Sim->Pools;
 
 
-  if(rnap_mptr_full>=MEM_BLOCK_RNAP) free(rnap);
+  if(pools->rnap_mptr_full>=MEM_BLOCK_RNAP) free(rnap);
   else
-    RNAPMemory[rnap_mptr_full]=rnap;
+    pools->RNAPMemory[pools->rnap_mptr_full]=rnap;
 
-  rnap_mptr_full--;
+  pools->rnap_mptr_full--;
 
 }
 
-void EmptyRNAPBlock()
+void EmptyRNAPBlock(pools)
+struct mempools *pools;
 {
   int i, cnt = 0;
 
   for(i=0; i<MEM_BLOCK_RNAP; i++)
-    if(RNAPMemory[i]!=NULL) {
-      free(RNAPMemory[i]);
+    if(pools->RNAPMemory[i]!=NULL) {
+      free(pools->RNAPMemory[i]);
       ++cnt;
     }
 
@@ -155,90 +223,103 @@ void EmptyRNAPBlock()
     fprintf(stderr, "EmptyRNAPBlock: freed %d RNAPs\n", cnt);
 }
 
-int      ribo_mptr_full= -1;
-RIBOSOME *RibosomeMemory[MEM_BLOCK_RIBOSOME];
-
-void FillRibosomeBlock()
+static struct latticepool *FindLatticePool(size)
+size_t size;
 {
+  struct mempools *pools= Sim->Pools;
   int i;
 
-  for(i=0; i<MEM_BLOCK_RIBOSOME; i++)
-    RibosomeMemory[i]= (RIBOSOME *) rcalloc(1,sizeof(RIBOSOME),"FillRibosomeBlock");
+  for(i=0; i<pools->NLatticePools; i++)
+    if(pools->LatticePool[i].Size==size) return(&pools->LatticePool[i]);
+
+  if(pools->NLatticePools>=MEM_LATTICE_SIZES) return(NULL);
+
+  pools->LatticePool[pools->NLatticePools].Size= size;
+  pools->LatticePool[pools->NLatticePools].Free= NULL;
+  return(&pools->LatticePool[pools->NLatticePools++]);
 }
 
-RIBOSOME *AllocRibosome()
+void *AllocLattice(size)
+size_t size;
 {
+  struct latticepool *pool;
+  void *lattice;
 
-  ribo_mptr_full++;
+  pool= FindLatticePool(size);
 
-  if(ribo_mptr_full>=MEM_BLOCK_RIBOSOME) {
+  if(pool==NULL || pool->Free==NULL){
     if (DebugLevel > 4)
-      fprintf(stderr, "AllocRibosome: allocating ribosome %d\n",
-	      react_mptr_full);
-
-    return( (RIBOSOME *) rcalloc(1,sizeof(RIBOSOME),"AllocRibosome"));
+      fprintf(stderr, "AllocLattice: allocating lattice of %ld bytes\n",
+	      (long) size);
+    return(rcalloc(1,size,"AllocLattice"));
   }
 
-  /* Take one of the ribosomes out of the block */
-  RIBOSOME *ribosome = RibosomeMemory[ribo_mptr_full];
-  RibosomeMemory[ribo_mptr_full] = NULL;
-  return(ribosome);
+  lattice= pool->Free;
+  pool->Free= *((void **) lattice);
+  memset(lattice,0,size);
+  return(lattice);
 }
 
-void FreeRibosome(ribo)
-RIBOSOME *ribo;
+void FreeLattice(lattice,size)
+void   *lattice;
+size_t  size;
 {
+  struct latticepool *pool;
 
+  pool= FindLatticePool(size);
 
-  if(ribo_mptr_full>=MEM_BLOCK_RIBOSOME) free(ribo);
-  else
-    RibosomeMemory[ribo_mptr_full]=ribo;
-
-  ribo_mptr_full--;
+  if(pool==NULL){
+    free(lattice);
+    return;
+  }
 
+  *((void **) lattice)= pool->Free;
+  pool->Free= lattice;
 }
 
-void EmptyRibosomeBlock()
+void EmptyLatticePools(pools)
+struct mempools *pools;
 {
   int i, cnt=0;
+  void *lattice;
 
-  for(i=0; i<MEM_BLOCK_RIBOSOME; i++)
-    if(RibosomeMemory[i]!=NULL) {
-      free(RibosomeMemory[i]);
+  for(i=0; i<pools->NLatticePools; i++)
+    while((lattice=pools->LatticePool[i].Free)!=NULL){
+      pools->LatticePool[i].Free= *((void **) lattice);
+      free(lattice);
       cnt++;
     }
 
   if (DebugLevel > 3 && cnt > 0) 
-    fprintf(stderr, "EmptyMRibosomeBlock: freed %d MRibosomes\n", cnt);
+    fprintf(stderr, "EmptyLatticePools: freed %d lattices\n", cnt);
 }
 
-int      mrnap_mptr_full= -1;
-MOVERNAP *MRNAPMemory[MEM_BLOCK_MOVERNAP];
-
-void FillMRNAPBlock()
+void FillMRNAPBlock(pools)
+struct mempools *pools;
 {
   int i;
 
   for(i=0; i<MEM_BLOCK_MOVERNAP; i++)
-    MRNAPMemory[i]= (MOVERNAP *) rcalloc(1,sizeof(MOVERNAP),"FillMRNAPBlock");
+    pools->MRNAPMemory[i]= (MOVERNAP *) rcalloc(1,sizeof(MOVERNAP),"FillMRNAPBlock");
 }
  
 MOVERNAP *AllocMRNAP()
 {
+  struct mempools *pools= Sim->Pools;
 
-  mrnap_mptr_full++;
+  pools->mrnap_mptr_full++;
 
-  if(mrnap_mptr_full>=MEM_BLOCK_MOVERNAP) {
+  if(pools->mrnap_mptr_full>=MEM_BLOCK_MOVERNAP) {
     if (DebugLevel > 4)
       fprintf(stderr, "AllocMRNAP: allocating MRNAP %d\n",
-	      react_mptr_full);
+	      pools->react_mptr_full);
 
     return( (MOVERNAP *) rcalloc(1,sizeof(MOVERNAP),"AllocMRNAP"));
   }
 
   /* Take one of the MRNAPs off of the block */
-  MOVERNAP *movernap = MRNAPMemory[mrnap_mptr_full];
-  MRNAPMemory[mrnap_mptr_full] = NULL;
+  MOVERNAP *movernap = pools->MRNAPMemory[pools->mrnap_mptr_full];
+  pools->MRNAPMemory[pools->mrnap_mptr_full] = NULL;
 
   return(movernap);
 }
@@ -246,22 +327,24 @@ MOVERNAP *AllocMRNAP()
 void FreeMRNAP(mrnap)
 MOVERNAP *mrnap;
 {
+  struct mempools *pools= Sim->Pools;
 
-  if(mrnap_mptr_full>=MEM_BLOCK_MOVERNAP) free(mrnap);
+  if(pools->mrnap_mptr_full>=MEM_BLOCK_MOVERNAP) free(mrnap);
   else
-    MRNAPMemory[mrnap_mptr_full]=mrnap;
+    pools->MRNAPMemory[pools->mrnap_mptr_full]=mrnap;
 
-  mrnap_mptr_full--;
+  pools->mrnap_mptr_full--;
 
 }
 
-void EmptyMRNAPBlock()
+void EmptyMRNAPBlock(pools)
+struct mempools *pools;
 {
   int i, cnt = 0;
 
   for(i=0; i<MEM_BLOCK_MOVERNAP; i++)
-    if(MRNAPMemory[i]!=NULL) {
-      free(MRNAPMemory[i]);
+    if(pools->MRNAPMemory[i]!=NULL) {
+      free(pools->MRNAPMemory[i]);
       ++cnt;
     }
 
@@ -269,54 +352,56 @@ void EmptyMRNAPBlock()
     fprintf(stderr, "EmptyMNAPBlock: freed %d MRNAPs\n", cnt);
 }
 
-int      mribo_mptr_full= -1;
-MOVERIBO *MRibosomeMemory[MEM_BLOCK_MOVERIBO];
-
-void FillMRibosomeBlock()
+void FillMRibosomeBlock(pools)
+struct mempools *pools;
 {
   int i;
 
   for(i=0; i<MEM_BLOCK_MOVERIBO; i++)
-    MRibosomeMemory[i]= (MOVERIBO *) rcalloc(1,sizeof(MOVERIBO),"FillMRibosomeBlock");
+    pools->MRibosomeMemory[i]= (MOVERIBO *) rcalloc(1,sizeof(MOVERIBO),"FillMRibosomeBlock");
 }
 
 MOVERIBO *AllocMRibosome()
 {
-  mribo_mptr_full++;
+  struct mempools *pools= Sim->Pools;
+
+  pools->mribo_mptr_full++;
 
-  if(mribo_mptr_full>=MEM_BLOCK_MOVERIBO) {
+  if(pools->mribo_mptr_full>=MEM_BLOCK_MOVERIBO) {
     if (DebugLevel > 4)
       fprintf(stderr, "AllocMRibosome: allocating MRibosome %d\n",
-	      react_mptr_full);
+	      pools->react_mptr_full);
 
     return( (MOVERIBO *) rcalloc(1,sizeof(MOVERIBO),"AllocMRibosome"));
   }
 
   /* Take one of the MOVERIBOs off of the block */
-  MOVERIBO *moveribo = MRibosomeMemory[mribo_mptr_full];
-  MRibosomeMemory[mribo_mptr_full] = NULL;
+  MOVERIBO *moveribo = pools->MRibosomeMemory[pools->mribo_mptr_full];
+  pools->MRibosomeMemory[pools->mribo_mptr_full] = NULL;
   return(moveribo);
 }
 
 void FreeMRibosome(mribo)
 MOVERIBO *mribo;
 {
+  struct mempools *pools= Sim->Pools;
 
 
-  if(mribo_mptr_full>=MEM_BLOCK_MOVERIBO) free(mribo);
+  if(pools->mribo_mptr_full>=MEM_BLOCK_MOVERIBO) free(mribo);
   else
-    MRibosomeMemory[mribo_mptr_full]=mribo;
+    pools->MRibosomeMemory[pools->mribo_mptr_full]=mribo;
 
-  mribo_mptr_full--; 
+  pools->mribo_mptr_full--; 
 }
 
-void EmptyMRibosomeBlock()
+void EmptyMRibosomeBlock(pools)
+struct mempools *pools;
 {
   int i, cnt = 0;
 
   for(i=0; i<MEM_BLOCK_MOVERIBO; i++) {
-    if(MRibosomeMemory[i]!=NULL) {
-      free(MRibosomeMemory[i]);
+    if(pools->MRibosomeMemory[i]!=NULL) {
+      free(pools->MRibosomeMemory[i]);
       ++cnt;
     }
   }
@@ -28,47 +28,37 @@
 
 #define MEM_BLOCK_REACTION  500
 #define MEM_BLOCK_RNAP      150      
-#define MEM_BLOCK_RIBOSOME  150
+#define MEM_LATTICE_SIZES   32
 #define MEM_BLOCK_MOVERNAP  150
 #define MEM_BLOCK_MOVERIBO  150
 
-extern int      react_mptr_full;
-extern REACTION *ReactionMemory[MEM_BLOCK_REACTION];
+/* Pools of free objects (see Memory.c) */
+extern struct mempools *NewMemoryPools();
+extern void FreeMemoryPools(struct mempools *);
 
-extern void FillReactionBlock();
+extern void FillReactionBlock(struct mempools *);
 extern REACTION *AllocReaction();
 extern void FreeReaction(REACTION *);
-extern void EmptyReactionBlock();
+extern void EmptyReactionBlock(struct mempools *);
 
-extern int      rnap_mptr_full;
-extern RNAP *RNAPMemory[MEM_BLOCK_RNAP];
-extern void FillRNAPBlock();
+extern void FillRNAPBlock(struct mempools *);
 extern RNAP *AllocRNAP();
 extern void FreeRNAP(RNAP *);
-extern void EmptyRNAPBlock();
+extern void EmptyRNAPBlock(struct mempools *);
 
-extern int      ribo_mptr_full;
-extern RIBOSOME *RibosomeMemory[MEM_BLOCK_RIBOSOME];
+extern void *AllocLattice(size_t);
+extern void FreeLattice(void *, size_t);
+extern void EmptyLatticePools(struct mempools *);
 
-extern void FillRibosomeBlock();
-extern RIBOSOME *AllocRibosome();
-extern void FreeRibosome(RIBOSOME *);
-extern void EmptyRibosomeBlock();
-
-extern int      mrnap_mptr_full;
-extern MOVERNAP *MRNAPMemory[MEM_BLOCK_MOVERNAP];
-
-extern void FillMRNAPBlock();
+extern void FillMRNAPBlock(struct mempools *);
 extern MOVERNAP *AllocMRNAP();
 void FreeMRNAP(MOVERNAP *);
-void EmptyMRNAPBlock();
+void EmptyMRNAPBlock(struct mempools *);
 
-extern int      mribo_mptr_full;
-extern MOVERIBO *MRibosomeMemory[MEM_BLOCK_MOVERIBO];
-extern void FillMRibosomeBlock();
+extern void FillMRibosomeBlock(struct mempools *);
 extern MOVERIBO *AllocMRibosome();
 extern void FreeMRibosome(MOVERIBO *);
-extern void EmptyMRibosomeBlock();
+extern void EmptyMRibosomeBlock(struct mempools *);
 
 
 
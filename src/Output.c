@@ -0,0 +1,610 @@
+/**************************
+ *
+ * The output of a run.
+ *
+ * A run writes its rows (see WriteSpeciesState()) to Sim->Output as
+ * text, as it always has, or with --output-format=binary as records
+ * of fixed width, so that the file can be mapped into memory as an
+ * array without parsing.  A binary output is, all little-endian,
+ *
+ *   "SIMROWS1"
+ *   u32 bytes of the header, where the records start (a multiple of 8)
+ *   u32 bytes of a record (a multiple of 8)
+ *   u32 columns
+ *   u32 bytes of the metadata
+ *   u64 records
+ *   i32 fate decided by a stop condition (see Fate.c), or -1
+ *   u32 TRUE once the run has ended, and the three fields around it
+ *       are set: until then, or if the file can't be rewound to set
+ *       them (a pipe), the records run to its end and the fate is lost
+ *   f64 time of the fate
+ *   for each column, in the order of the text output,
+ *     its name, NAMEBYTES bytes padded with NULs
+ *     its type, "<f8" (Time, RPQ and Volume) or "<i4", in 4 bytes
+ *     u32 its offset in a record
+ *   the metadata, lines of "name = value", padded with NULs
+ *   the records
+ *
+ * The doubles of a record come first, so every field is aligned.  The
+ * metadata are much those of the python setup script: the outline,
+ * times, the MOI (the copies of the phage sequences the output starts
+ * with, if the outline has any), the seed and trajectory of the
+ * random stream, the volume and growth rate of the cell, the
+ * promoters, the rates of the run and the fates of the stop
+ * conditions, and the spec of a run made for a coordinator (see
+ * Distribute.c).
+ *
+ * With --output-format=delta the rows are compressed instead: the
+ * counts change little from one row to the next, so each column is
+ * written as its change from the row before, as a zig-zag varint
+ * (0, -1, 1, -2, ... as 0, 1, 2, 3, ..., seven bits a byte, low
+ * first, the top bit set on all but the last).  The doubles go as
+ * the changes of their bits, lossless.  The header is that of a
+ * binary output but for "SIMDELT1", and the bytes of a record are
+ * instead the rows of a block: every --keyframe rows a block starts
+ * over, its first row the change from 0 (a keyframe), so that a row
+ * can be found by hopping from block to block rather than decoding
+ * them all.  After the header come the blocks,
+ *
+ *   u32 bytes of the block after these 8
+ *   u32 rows in it (the last block may have fewer)
+ *   the rows, each its columns in the order of their offsets
+ *
+ * A block is written once it is full, so the output is flushed a
+ * block at a time.
+ *
+ * Rather than after every row, the output is flushed every --flush
+ * rows, and when the run ends if 0.  By default (-1) a text output is
+ * flushed every row, for those who watch it, and a binary one at the
+ * end.
+ *
+ * With --writer the rows are formatted and written by a thread of
+ * their own rather than in the loop of the run.  Each thread that
+ * runs trajectories copies its rows into a ring of --writer-rows
+ * slots, of which it is the only producer and the writer the only
+ * consumer, so neither takes a lock: the thread publishes a row by
+ * moving the head of the ring on, the writer frees its slot by moving
+ * the tail.  One writer serves the rings of all the threads of an
+ * ensemble.  A thread that fills its ring waits for the writer to
+ * catch up, and a run waits for its rows to be written before its
+ * output is ended (see EndOutput()).  The header of an output, once
+ * a run, is still written by the run's thread.
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#include <stdarg.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef DISTRIBUTE
+ #include "Distribute.h"
+#endif
+
+#ifndef FATE
+ #include "Fate.h"
+#endif
+
+#ifndef OUTPUT
+ #include "Output.h"
+#endif
+
+#define NAMEBYTES     32
+#define COLUMNBYTES   (NAMEBYTES+8)
+#define FIXEDBYTES    48            /* Of the header, before the columns */
+#define ROUND8(n)     (((n)+7)&~((size_t) 7))
+
+typedef struct ring RING;
+
+/* The rows a thread hands the writer; Head and Tail count them from the first */
+struct ring {
+  size_t  Head;                 /* Moved on by the thread only */
+  char    Pad[64];              /* Head and Tail on lines of their own */
+  size_t  Tail;                 /* Moved on by the writer only */
+  char    Pad2[64];
+  size_t  Size;                 /* Slots, a power of 2 */
+  FILE  **Output;               /* Of the row in each slot */
+  long   *N;                    /* Its count in the output, from 1 */
+  SAMPLE *Row;
+  ROWCODEC Codec;               /* Of the rows it writes */
+  RING   *Next;                 /* Of the writer's list */
+};
+
+short  OutputFormat=TEXTOUTPUT;
+int    FlushRows=1;
+short  OutputHeader=1;
+static int Keyframe=64;
+
+static short   Writer=0;
+static size_t  RingSize;
+static RING   *Rings=NULL;      /* Every thread's, newest first */
+static short   Stopping=0;
+static pthread_t WriterThread;
+static __thread RING *Ring=NULL;  /* The running thread's */
+
+/*
+ * Write the output in format, "text", "binary" or "delta" with a
+ * keyframe every keyframe rows, flushed every flush rows
+ */
+void SetupOutput(format,flush,keyframe,header)
+char *format;
+int flush,keyframe,header;
+{
+  if(strcmp(format,"binary")==0) OutputFormat= BINARYOUTPUT;
+  else if(strcmp(format,"delta")==0) OutputFormat= DELTAOUTPUT;
+  else if(strcmp(format,"text")!=0){
+    fprintf(stderr,"%s: --output-format is text, binary or delta, not '%s'\n",progid,format);
+    exit(1);
+  }
+  if(keyframe<1){
+    fprintf(stderr,"%s: --keyframe must be at least 1\n",progid);
+    exit(1);
+  }
+  Keyframe= keyframe;
+  FlushRows= (flush>=0 ? flush : (OutputFormat==TEXTOUTPUT ? 1 : 0));
+  OutputHeader= header;
+}
+
+/* Bytes of a record */
+static size_t RecordBytes()
+{
+  int SampleColumns();
+
+  return(ROUND8(3*8+4*(1+(size_t) SampleColumns())));
+}
+
+/* Add a line of metadata to b */
+static void Meta(BYTES *b, char *format, ...)
+{
+  va_list ap;
+  char line[256];
+
+  va_start(ap,format);
+  vsnprintf(line,sizeof(line),format,ap);
+  va_end(ap);
+  PutBytes(b,line,strlen(line));
+}
+
+/* Add column name, of type and at offset of a record, to b */
+static void Column(b,name,suffix,type,offset)
+BYTES *b;
+char *name,*suffix,*type;
+size_t offset;
+{
+  char field[COLUMNBYTES];
+
+  memset(field,0,sizeof(field));
+  snprintf(field,NAMEBYTES,"%s%s",name,suffix);
+  strncpy(field+NAMEBYTES,type,4);
+  PutBytes(b,field,NAMEBYTES+4);
+  PutU32(b,(uint32_t) offset);
+}
+
+/* Write the header of a binary output; spec, if any, is the run's */
+static void WriteBinaryHeader(spec)
+char *spec;
+{
+  int i,columns;
+  size_t at;
+  uint64_t seed;
+  BYTES head,meta;
+
+  int SampleColumns();
+  extern char *SystemFile;
+  extern int NOutputOperators,NOutputPromotors;
+
+  columns= 3+SampleColumns()+1;
+
+  /* Metadata, as generateSetupScript() writes them */
+  memset(&meta,0,sizeof(meta));
+  Meta(&meta,"config_file = %.200s\n",SystemFile);
+  Meta(&meta,"maximum_time = %.17g\n",MaximumTime);
+  Meta(&meta,"print_time = %.17g\n",PrintTime);
+  for(i=0; i<NSeqTemplates; i++)
+    if(SeqTemplate[i]->FollowsMOI){
+      Meta(&meta,"moi = %d\n",SEQ_COPIES(SeqTemplate[i])->NCopies);
+      break;
+    }
+  seed= (uint64_t) Sim->Rng->Key[0] | (uint64_t) Sim->Rng->Key[1]<<32;
+  Meta(&meta,"seed = %lld\n",(long long) seed);
+  Meta(&meta,"trajectory = %lu\n",(unsigned long) Sim->Rng->Stream[1]);
+  Meta(&meta,"cell_size_initial = %.17g\n",Sim->EColi->VI);
+  Meta(&meta,"cell_size_reference = %.17g\n",Sim->EColi->V0);
+  Meta(&meta,"cell_growth_rate = %.17g\n",Sim->EColi->GrowthRate);
+  Meta(&meta,"promoters =");
+  for(i=0; i<Sim->NPromotors; i++)
+    Meta(&meta," %s",SegmentName(Sim->Promotor[i]->Segment));
+  Meta(&meta,"\n");
+  Meta(&meta,"n_rates = %d\n",NMassAction);
+  Meta(&meta,"rates =");
+  for(i=0; i<NMassAction; i++)
+    Meta(&meta," %.17g",Sim->Rates[i]);
+  Meta(&meta,"\n");
+  if(NStops>0){
+    Meta(&meta,"fates =");
+    for(i=0; i<NStops; i++)
+      Meta(&meta," %s",FateName(i));
+    Meta(&meta,"\n");
+  }
+  if(spec!=NULL) Meta(&meta,"run = %.200s\n",spec);
+
+  memset(&head,0,sizeof(head));
+  PutBytes(&head,(OutputFormat==DELTAOUTPUT ? "SIMDELT1" : "SIMROWS1"),8);
+  PutU32(&head,(uint32_t) ROUND8(FIXEDBYTES+(size_t) COLUMNBYTES*columns+meta.N));
+  PutU32(&head,(uint32_t) (OutputFormat==DELTAOUTPUT ? Keyframe : RecordBytes()));
+  PutU32(&head,(uint32_t) columns);
+  PutU32(&head,(uint32_t) meta.N);
+  PutU32(&head,0);  PutU32(&head,0);
+  PutU32(&head,(uint32_t) -1);
+  PutU32(&head,0);
+  PutDouble(&head,0.0);
+
+  /* Time, NR, RPQ, the species, Volume, the operators and the promotors */
+  Column(&head,"Time","","<f8",(size_t) 0);
+  Column(&head,"NR","","<i4",(size_t) 24);
+  Column(&head,"RPQ","","<f8",(size_t) 8);
+  at= 28;
+  for(i=0; i<NSpecies; i++, at+=4)
+    Column(&head,SpeciesName[i],"","<i4",at);
+  Column(&head,"Volume","","<f8",(size_t) 16);
+  for(i=0; i<NOutputOperators; i++, at+=4)
+    Column(&head,&Sim->Operator[i].Name[8],"","<i4",at);
+  if(SampleColumns()>NSpecies+NOutputOperators)      /* With --pops */
+    for(i=0; i<NOutputPromotors; i++, at+=4)
+      Column(&head,SegmentName(Sim->Promotor[i]->Segment),"-RNAP","<i4",at);
+
+  PutBytes(&head,meta.Data,meta.N);
+  while(head.N%8!=0) PutBytes(&head,"",1);
+  fwrite(head.Data,1,head.N,Sim->Output);
+  free(head.Data);
+  free(meta.Data);
+}
+
+/*
+ * Start the output of a run on Sim->Output: the column headings, if
+ * they are asked for, or the header of a binary or delta output, with
+ * spec, if not NULL, the spec of the run (see ReadRunSpec())
+ */
+void BeginOutput(spec)
+char *spec;
+{
+  void WriteHeader();
+
+  Sim->Written= 0;
+  if(OutputFormat!=TEXTOUTPUT)
+    WriteBinaryHeader(spec);
+  else if(OutputHeader)
+    WriteHeader();
+}
+
+/* Add x to b as a zig-zag varint */
+static void PutVarint(b,x)
+BYTES *b;
+int64_t x;
+{
+  int n;
+  uint64_t z;
+  unsigned char c[10];
+
+  z= ((uint64_t) x<<1)^(x<0 ? ~(uint64_t) 0 : 0);
+  for(n=0; z>=0x80; z>>=7)
+    c[n++]= (unsigned char) (z|0x80);
+  c[n++]= (unsigned char) z;
+  PutBytes(b,c,n);
+}
+
+/* Write the block of rows codec has, if any, to fp */
+static void WriteBlock(fp,codec)
+FILE *fp;
+ROWCODEC *codec;
+{
+  unsigned char *p;
+
+  if(codec->Rows==0) return;
+  p= codec->Buffer.Data;
+  p[0]= (codec->Buffer.N-8);     p[1]= (codec->Buffer.N-8)>>8;
+  p[2]= (codec->Buffer.N-8)>>16; p[3]= (codec->Buffer.N-8)>>24;
+  p[4]= codec->Rows;     p[5]= codec->Rows>>8;
+  p[6]= codec->Rows>>16; p[7]= codec->Rows>>24;
+  fwrite(p,1,codec->Buffer.N,fp);
+  codec->Rows= 0;
+}
+
+/* Add row to the block of codec, writing it to fp once it's full */
+static void EncodeRow(fp,row,codec)
+FILE *fp;
+SAMPLE *row;
+ROWCODEC *codec;
+{
+  int i,columns;
+  uint64_t x[3];
+
+  int SampleColumns();
+
+  columns= SampleColumns();
+  if(codec->Last==NULL)
+    codec->Last= (uint64_t *) rcalloc(4+columns,sizeof(uint64_t),"EncodeRow");
+
+  /* A block starts with its length and rows, and a keyframe */
+  if(codec->Rows==0){
+    codec->Buffer.N= 0;
+    PutBytes(&codec->Buffer,"\0\0\0\0\0\0\0\0",8);
+    memset(codec->Last,0,(4+columns)*sizeof(uint64_t));
+  }
+
+  memcpy(&x[0],&row->Time,sizeof(double));
+  memcpy(&x[1],&row->RPQ,sizeof(double));
+  memcpy(&x[2],&row->Volume,sizeof(double));
+  for(i=0; i<3; i++){
+    PutVarint(&codec->Buffer,(int64_t) (x[i]-codec->Last[i]));
+    codec->Last[i]= x[i];
+  }
+  PutVarint(&codec->Buffer,(int64_t) ((uint64_t) (int64_t) row->NR-codec->Last[3]));
+  codec->Last[3]= (uint64_t) (int64_t) row->NR;
+  for(i=0; i<columns; i++){
+    PutVarint(&codec->Buffer,(int64_t) ((uint64_t) (int64_t) row->Value[i]-codec->Last[4+i]));
+    codec->Last[4+i]= (uint64_t) (int64_t) row->Value[i];
+  }
+
+  if(++codec->Rows==Keyframe) WriteBlock(fp,codec);
+}
+
+/* Write row to fp, with codec, as row n of the output */
+static void WriteRow(fp,row,n,codec)
+FILE *fp;
+SAMPLE *row;
+long n;
+ROWCODEC *codec;
+{
+  int i,columns;
+  size_t bytes;
+  BYTES *record;
+
+  void PrintSample();
+  int SampleColumns();
+
+  switch(OutputFormat){
+  case BINARYOUTPUT:
+    columns= SampleColumns();
+    bytes= RecordBytes();
+    record= &codec->Buffer;
+    record->N= 0;
+    PutDouble(record,row->Time);
+    PutDouble(record,row->RPQ);
+    PutDouble(record,row->Volume);
+    PutU32(record,(uint32_t) row->NR);
+    for(i=0; i<columns; i++)
+      PutU32(record,(uint32_t) row->Value[i]);
+    while(record->N<bytes) PutBytes(record,"",1);
+    fwrite(record->Data,1,bytes,fp);
+    break;
+  case DELTAOUTPUT:
+    EncodeRow(fp,row,codec);
+    break;
+  default:
+    PrintSample(fp,row);
+  }
+
+  if(FlushRows>0 && n%FlushRows==0)
+    fflush(fp);
+}
+
+/****************************/
+/******* Writer *************/
+/****************************/
+
+/* Let others run a while, longer the more times in a row this is done */
+static void Nap(times)
+int times;
+{
+  struct timespec t;
+
+  if(times<16){
+    sched_yield();
+    return;
+  }
+  t.tv_sec= 0;
+  t.tv_nsec= (times<64 ? 20000L : 1000000L);
+  nanosleep(&t,NULL);
+}
+
+/* Write the rows of every ring as they come until stopped */
+static void *RunWriter(arg)
+void *arg;
+{
+  int idle;
+  size_t head,tail,slot;
+  short stop;
+  RING *r;
+
+  for(idle=0; ; ){
+    stop= __atomic_load_n(&Stopping,__ATOMIC_ACQUIRE);
+    idle++;
+    for(r=__atomic_load_n(&Rings,__ATOMIC_ACQUIRE); r!=NULL; r=r->Next){
+      head= __atomic_load_n(&r->Head,__ATOMIC_ACQUIRE);
+      for(tail=r->Tail; tail!=head; tail++){
+	slot= tail&(r->Size-1);
+	WriteRow(r->Output[slot],&r->Row[slot],r->N[slot],&r->Codec);
+	idle= 0;
+      }
+      __atomic_store_n(&r->Tail,tail,__ATOMIC_RELEASE);
+    }
+    /* Every row queued before the stop has been written */
+    if(stop && idle>0) break;
+    if(idle>0) Nap(idle);
+  }
+  return(NULL);
+}
+
+/* Write the output on a thread of its own, fed by rings of rows slots */
+void StartWriter(rows)
+int rows;
+{
+  if(rows<1){
+    fprintf(stderr,"%s: --writer-rows must be at least 1\n",progid);
+    exit(1);
+  }
+  for(RingSize=1; RingSize<(size_t) rows; RingSize*=2);
+  Writer= 1;
+  if(pthread_create(&WriterThread,NULL,RunWriter,NULL)!=0){
+    fprintf(stderr,"%s: can't start the writer thread\n",progid);
+    exit(-1);
+  }
+}
+
+/* Stop the writer once every row queued has been written */
+void StopWriter()
+{
+  int i;
+  RING *r,*next;
+
+  if(!Writer) return;
+  __atomic_store_n(&Stopping,1,__ATOMIC_RELEASE);
+  pthread_join(WriterThread,NULL);
+  Writer= 0;
+
+  for(r=Rings; r!=NULL; r=next){
+    next= r->Next;
+    for(i=0; i<(int) r->Size; i++)
+      free(r->Row[i].Value);
+    free(r->Row);
+    free(r->N);
+    free(r->Output);
+    free(r->Codec.Buffer.Data);
+    free(r->Codec.Last);
+    free(r);
+  }
+  Rings= NULL;
+  Ring= NULL;
+}
+
+/* The ring of the running thread, made and handed to the writer the first time */
+static RING *ThreadRing()
+{
+  int i,columns;
+  RING *r;
+
+  int SampleColumns();
+
+  if(Ring!=NULL) return(Ring);
+
+  columns= SampleColumns();
+  r= (RING *) rcalloc(1,sizeof(RING),"ThreadRing");
+  r->Size= RingSize;
+  r->Output= (FILE **) rcalloc(RingSize,sizeof(FILE *),"ThreadRing");
+  r->N=      (long *) rcalloc(RingSize,sizeof(long),"ThreadRing");
+  r->Row=    (SAMPLE *) rcalloc(RingSize,sizeof(SAMPLE),"ThreadRing");
+  for(i=0; i<(int) RingSize; i++)
+    r->Row[i].Value= (int *) rcalloc(columns+1,sizeof(int),"ThreadRing");
+
+  /* Rings are only added, at the front, so the writer can walk them as it likes */
+  r->Next= __atomic_load_n(&Rings,__ATOMIC_ACQUIRE);
+  while(!__atomic_compare_exchange_n(&Rings,&r->Next,r,0,__ATOMIC_RELEASE,__ATOMIC_ACQUIRE));
+  Ring= r;
+  return(r);
+}
+
+/* Wait until the writer has written every row the running thread queued */
+static void DrainRing()
+{
+  int times;
+
+  if(Ring==NULL) return;
+  for(times=1; __atomic_load_n(&Ring->Tail,__ATOMIC_ACQUIRE)!=Ring->Head; times++)
+    Nap(times);
+}
+
+/* Write row to Sim->Output, or queue it for the writer */
+void PutOutput(row)
+SAMPLE *row;
+{
+  int times;
+  size_t slot;
+  RING *r;
+
+  int SampleColumns();
+
+  Sim->Written++;
+  if(!Writer){
+    WriteRow(Sim->Output,row,Sim->Written,&Sim->Codec);
+    return;
+  }
+
+  /* Wait while the ring is full */
+  r= ThreadRing();
+  for(times=1; r->Head-__atomic_load_n(&r->Tail,__ATOMIC_ACQUIRE)==r->Size; times++)
+    Nap(times);
+
+  slot= r->Head&(r->Size-1);
+  r->Output[slot]= Sim->Output;
+  r->N[slot]= Sim->Written;
+  r->Row[slot].Time=   row->Time;
+  r->Row[slot].NR=     row->NR;
+  r->Row[slot].RPQ=    row->RPQ;
+  r->Row[slot].Volume= row->Volume;
+  memcpy(r->Row[slot].Value,row->Value,SampleColumns()*sizeof(int));
+  __atomic_store_n(&r->Head,r->Head+1,__ATOMIC_RELEASE);
+}
+
+/*
+ * End the output of a run on Sim->Output, with fate (-1 if none)
+ * decided at time t, once its rows are written, and flush it.  A
+ * binary or delta output that can be rewound gets its number of rows
+ * and its fate in its header.
+ */
+void EndOutput(fate,t)
+int fate;
+double t;
+{
+  long end;
+  BYTES b;
+
+  /* Once the writer is done with the rows; a delta output's last block is left */
+  DrainRing();
+  if(OutputFormat==TEXTOUTPUT){
+    if(fate>=0) WriteFate(Sim->Output,fate,t);
+    fflush(Sim->Output);
+    return;
+  }
+  if(OutputFormat==DELTAOUTPUT)
+    WriteBlock(Sim->Output,(Writer && Ring!=NULL ? &Ring->Codec : &Sim->Codec));
+
+  memset(&b,0,sizeof(b));
+  PutU32(&b,(uint32_t) Sim->Written);
+  PutU32(&b,(uint32_t) ((uint64_t) Sim->Written>>32));
+  PutU32(&b,(uint32_t) fate);
+  PutU32(&b,1);
+  PutDouble(&b,(fate>=0 ? t : 0.0));
+  if((end=ftell(Sim->Output))>=0 && fseek(Sim->Output,24L,SEEK_SET)==0){
+    fwrite(b.Data,1,b.N,Sim->Output);
+    fseek(Sim->Output,end,SEEK_SET);
+  }
+  else
+    clearerr(Sim->Output);
+  fflush(Sim->Output);
+  free(b.Data);
+}
@@ -0,0 +1,18 @@
+/**********************
+ *
+ * The output of a run, as text, binary records or deltas (see Output.c)
+ *
+ **********************/
+#define OUTPUT
+
+#define TEXTOUTPUT    0
+#define BINARYOUTPUT  1
+#define DELTAOUTPUT   2
+
+extern short OutputFormat;
+extern void  SetupOutput(char *, int, int, int);
+extern void  StartWriter(int);
+extern void  StopWriter(void);
+extern void  BeginOutput(char *);
+extern void  PutOutput(SAMPLE *);
+extern void  EndOutput(int, double);
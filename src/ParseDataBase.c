@@ -17,12 +17,14 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <ctype.h>
 #include <assert.h>
 
 #include "DataStructures.h"
 #include "Util.h"
+#include "Sweep.h"
 
 #define Success  0
 #define Failure  1
@@ -160,10 +162,10 @@ char *name;
   SpeciesName[NSpecies-1]= (char *) rcalloc(strlen(name)+1,sizeof(char),"AddSpecies.2");
   strcpy(SpeciesName[NSpecies-1],name);
 
-  if(Concentration==NULL) Concentration= (int *) rcalloc(NSpecies, sizeof(int),"AddSpecies.3");
-  else                    Concentration= (int *) rrealloc(Concentration,NSpecies,sizeof(int),"AddSpecies.3");
+  if(Sim->Concentration==NULL) Sim->Concentration= (int *) rcalloc(NSpecies, sizeof(int),"AddSpecies.3");
+  else                         Sim->Concentration= (int *) rrealloc(Sim->Concentration,NSpecies,sizeof(int),"AddSpecies.3");
 
-  Concentration[NSpecies-1]=0;
+  Sim->Concentration[NSpecies-1]=0;
 
   if (DebugLevel >= 2)
     fprintf(logfp,"@@@ %s: Added Species: %s\n", progid, name);
@@ -219,6 +221,7 @@ char *file;
   void ReadKinetics();
   void ReadRibosome();
   void ReadDNA();
+  void LinkSequences();
 
   fp=OpenFile(file,"r");
 
@@ -309,10 +312,162 @@ char *file;
     exit(-1);
   }
 
+  LinkSequences();
+
 fclose(fp);
 return(Success);
 }
 
+/*
+ * Once all sequences have been read, group the copies of each operator
+ * and set up the list of promotors that are able to fire in their
+ * initial operator state.
+ */
+void LinkSequences()
+{
+  int i;
+  void UpdateOperatorState();
+  void JoinOperatorGroup();
+
+  for(i=0; i<Sim->NOperators; i++)
+    JoinOperatorGroup(&Sim->Operator[i]);
+
+  for(i=0; i<Sim->NOperators; i++)
+    UpdateOperatorState(&Sim->Operator[i],Sim->Operator[i].CurrentState);
+}
+
+/*
+ * Copies of an operator are collected into a group (see
+ * DataStructures.h).  Copies share the name of their S/A file and
+ * must control promotors with the same isomerization rates; 
+ * anything else gets a group of its own.
+ */
+int SameOperator(a,b)
+SHEADATA *a,*b;
+{
+  int i,len;
+  char *sep;
+  PROMTEMPLATE *pa,*pb;
+
+  sep= strrchr(a->Name,COPY_SEPARATOR);
+  len= (sep==NULL ? strlen(a->Name) : sep-a->Name);
+  if(strncmp(a->Name,b->Name,len)!=0 || strrchr(b->Name,COPY_SEPARATOR)!=b->Name+len)
+    return(FALSE);
+
+  if(a->NConfigs!=b->NConfigs || a->NPromotors!=b->NPromotors)
+    return(FALSE);
+
+  for(i=0; i<a->NPromotors; i++){
+    pa= a->Promotors[i]->T;
+    pb= b->Promotors[i]->T;
+    if(pa==pb) continue;    /* Copies of the same sequence */
+    if(pa->TranscriptionDirection!=pb->TranscriptionDirection)
+      return(FALSE);
+    if(memcmp(pa->IsoRate,pb->IsoRate,a->NConfigs*sizeof(double))!=0)
+      return(FALSE);
+  }
+
+  return(TRUE);
+}
+
+/*
+ * Put an operator in the group of its copies, creating the group if
+ * needed.  It joins the idle pool unless one of its promotors already
+ * has RNAPs on its DNA.
+ */
+void JoinOperatorGroup(oper)
+SHEADATA *oper;
+{
+  int g,p,k;
+  OPERGROUP *group;
+  void MoveGroupMember();
+
+  for(g=0; g<Sim->NOperGroups; g++)
+    if(Sim->OperGroup[g]->NMembers>0 && SameOperator(Sim->OperGroup[g]->Template,oper)) break;
+
+  if(g==Sim->NOperGroups){
+    Sim->OperGroup= (OPERGROUP **) rrealloc(Sim->OperGroup,Sim->NOperGroups+1,sizeof(OPERGROUP *),"JoinOperatorGroup.1");
+    group= (OPERGROUP *) rcalloc(1,sizeof(OPERGROUP),"JoinOperatorGroup.2");
+    Sim->OperGroup[Sim->NOperGroups++]= group;
+
+    group->Template= oper;
+    group->Count= (int *) rcalloc(oper->NConfigs,sizeof(int),"JoinOperatorGroup.3");
+    group->Init= (IDLEINIT *) rcalloc(oper->NPromotors+1,sizeof(IDLEINIT),"JoinOperatorGroup.4");
+    for(p=0; p<oper->NPromotors; p++){
+      group->Init[p].Group= group;
+      group->Init[p].Promotor= p;
+    }
+  }
+  group= Sim->OperGroup[g];
+
+  group->Member= (SHEADATA **) rrealloc(group->Member,group->NMembers+1,sizeof(SHEADATA *),"JoinOperatorGroup.5");
+  oper->Group= group;
+  group->Member[group->NMembers]= oper;
+  oper->MemberIndex= group->NMembers++;
+
+  for(p=0; p<oper->NPromotors; p++)
+    if(oper->Promotors[p]->Segment->Seq->RNAPs.NRNAPs>0) break;
+  if(p<oper->NPromotors) return;
+
+  /* Swap with the first explicit copy and grow the pool */
+  k= group->NIdle;
+  MoveGroupMember(group,k,oper->MemberIndex);
+  group->Member[k]= oper;
+  oper->MemberIndex= k;
+  group->NIdle++;
+  group->Count[oper->CurrentState]++;
+}
+
+void LeaveOperatorGroup(oper)
+SHEADATA *oper;
+{
+  int k;
+  OPERGROUP *group;
+  void MoveGroupMember();
+
+  group= oper->Group;
+  k= oper->MemberIndex;
+
+  if(k<group->NIdle){
+    /* Fill the hole from the end of the pool, and that from the end of the list */
+    group->Count[oper->CurrentState]--;
+    group->NIdle--;
+    MoveGroupMember(group,group->NIdle,k);
+    MoveGroupMember(group,group->NMembers-1,group->NIdle);
+  } else
+    MoveGroupMember(group,group->NMembers-1,k);
+  group->NMembers--;
+
+  oper->Group= NULL;
+  if(group->Template==oper)
+    group->Template= (group->NMembers>0 ? group->Member[0] : NULL);
+}
+
+void MoveGroupMember(group,from,to)
+OPERGROUP *group;
+int from,to;
+{
+  if(from==to) return;
+  group->Member[to]= group->Member[from];
+  group->Member[to]->MemberIndex= to;
+}
+
+/*
+ * Point the groups at the operators again after the Operator array
+ * has been realloc'ed by a copy added during the run.
+ */
+void RelinkOperatorGroups()
+{
+  int i;
+
+  for(i=0; i<Sim->NOperators; i++)
+    if(Sim->Operator[i].Group!=NULL)
+      Sim->Operator[i].Group->Member[Sim->Operator[i].MemberIndex]= &Sim->Operator[i];
+
+  for(i=0; i<Sim->NOperGroups; i++)
+    Sim->OperGroup[i]->Template= (Sim->OperGroup[i]->NMembers>0 ? Sim->OperGroup[i]->Member[0] : NULL);
+}
+
 /**************************************/
 /******* Specific Parsers *************/
 /**************************************/
@@ -326,7 +481,7 @@ char *cell;
 
   /**** Allocate EColi *****/
 
-  EColi= (CELL *) calloc(1,sizeof(CELL));
+  Sim->EColi= (CELL *) calloc(1,sizeof(CELL));
 
   /* Read to Separator */
   while(fgets(buffer,81,fp)!=NULL){
@@ -338,12 +493,12 @@ char *cell;
   }
 
   fscanf(fp,"%*s %lf",&vol);
-  EColi->VI=vol;
+  Sim->EColi->VI=vol;
   fscanf(fp,"%*s %lf",&vol);
-  EColi->V0=vol;
+  Sim->EColi->V0=vol;
   fscanf(fp,"%*s %lf",&vol);
-  EColi->GrowthRate=vol;
-  EColi->V=EColi->VI;
+  Sim->EColi->GrowthRate=vol;
+  Sim->EColi->V=Sim->EColi->VI;
 }
 
 
@@ -473,6 +628,7 @@ char *mech;
       exit(-1);
     }
     ReactionProbability[NMassAction-nreact+i] /= mult;    
+    BindParam(buffer,PARAM_RATE,NMassAction-nreact+i,1.0/mult);
   }
 
   fscanf(fp,"%*s"); /* Read Spacer */
@@ -494,7 +650,8 @@ char *mech;
     }
     if (DebugLevel >= 2)
       fprintf(logfp,"@@@ [%s]= %d\n",SpeciesName[j],molec);
-    Concentration[j]=molec;
+    Sim->Concentration[j]=molec;
+    BindParam(buffer,PARAM_INIT,j,1.0);
   }
   
 fclose(fp);	 	 
@@ -505,19 +662,22 @@ FILE *fp;
 char *mech;
 {
   int i,j;
-  int rflag,nflag,moi,length,mult,firstcopy;
-  DNA *sequence,*nextsequence;
-  char token[80],buffer[1024];
+  int rflag,nflag,moi,length,mult;
+  SEQTEMPLATE *tmpl;
+  SEQUENCE *seq;
+  SEGTEMPLATE *sequence;
+  char token[80],buffer[1024],moivalue[80];
   char unit[30],type[80],direction[10];
   char **name,**parameters;
   SEGMENT  *seg;
-  PROMOTOR *prom;
   void ReadPromotorData();
   void ReadTerminatorData();
   void ReadAntiTerminatorData();
   void ReadCodingData();
   void ReadNonCodingData();
-  void *FindSegData();
+  SEGTEMPLATE *FindSegment();
+  SEQUENCE *NewSequenceCopy();
+  void AttachOperator();
 
   void SubmitTermination();
   void SubmitAntiTermination();
@@ -526,25 +686,14 @@ char *mech;
 
   /**** Allocate memory for sequence *******/
 
-  NSequences++;
-
-  if(Sequence==NULL) Sequence= (DNA *) rcalloc(NSequences,sizeof(DNA),"ReadDNA.1");
-  else               Sequence= (DNA *) rrealloc(Sequence,NSequences,sizeof(DNA),"ReadDNA.1");
-
   /****
    *
-   * We've realloc'ed....we gotta reset 
-   * the pointers to the first segment of 
-   * the first sequence 
+   * The segments are read into a template, which
+   * is shared by all the copies of the sequence
+   * made below (see NewSequenceCopy()).
    ****/
 
-  for(i=0; i<NSequences-1; i++){
-    sequence= &Sequence[i];
-  if(sequence->RightSegment != NULL)
-    sequence->RightSegment->LeftSegment= sequence;
-  }
-
-  sequence=(DNA *) &Sequence[NSequences-1];
+  tmpl= (SEQTEMPLATE *) rcalloc(1,sizeof(SEQTEMPLATE),"ReadDNA.1");
   
   /**** Read down to first separator ******/
 
@@ -573,10 +722,7 @@ char *mech;
       if(rflag==0){
 	fprintf(stderr,"%s: Null DNA Sequence encountered in mechanism %s.\n",progid,mech);
 	fclose(fp);
-	NSequences--;
-	free(sequence);
-	if(NSequences==0) free(Sequence);
-	else              Sequence= (DNA *) rrealloc(Sequence,NSequences,sizeof(DNA),"ReadDNA.2");
+	free(tmpl);
 	return;
       }
       if(nflag==1){
@@ -590,22 +736,14 @@ char *mech;
 	fprintf(stderr,"%s: Expected to find '-->' token %s but found %s instead in mechanism %s.\n",progid,(rflag>0 ? "or a Separator" : ""), buffer,mech);
 	exit(-1);
       }
-      if(rflag!=0){
-	nextsequence= (DNA *) rcalloc(1,sizeof(DNA),"ReadDNA.3");
-	sequence->RightSegment=nextsequence;
-	nextsequence->LeftSegment=sequence;
-	nextsequence->RightSegment=NULL;
-	sequence= nextsequence;
-	sequence->Name= (char *) rcalloc(strlen(buffer)+1+4,sizeof(char),"ReadDNA.4");
-	/* Extra 4 in length because we will append a copy-number */
-	strcpy(sequence->Name,buffer);
-      } else {
-	sequence->RightSegment=NULL;
-	sequence->LeftSegment=NULL;
-	sequence->Name= (char *) rcalloc(strlen(buffer)+1+4,sizeof(char),"ReadDNA.5"); 
-	/* Extra 4 in length because we will append a copy-number */
-	strcpy(sequence->Name,buffer);
-      }
+      tmpl->Segment= (SEGTEMPLATE *) rrealloc(tmpl->Segment,rflag+1,sizeof(SEGTEMPLATE),"ReadDNA.3");
+      sequence= &tmpl->Segment[rflag];
+      memset(sequence,0,sizeof(SEGTEMPLATE));
+      sequence->Left=  rflag-1;
+      sequence->Right= -1;
+      if(rflag>0) tmpl->Segment[rflag-1].Right= rflag;
+      sequence->Name= (char *) rcalloc(strlen(buffer)+1,sizeof(char),"ReadDNA.4");
+      strcpy(sequence->Name,buffer);
       rflag++;
       nflag=0;
     }
@@ -616,6 +754,8 @@ char *mech;
     fprintf(stderr,"%s: Premature end-of-file in mechanism %s.\n",progid,mech);
     exit(-1);
   }
+
+  tmpl->NSegments= rflag;
   
   /**** Now read the DNA parameters ******/
 
@@ -625,8 +765,10 @@ char *mech;
     /* Read until we get a valid parameter setting */
     if (param_parse_string(buffer, token, "%d", &moi) == 0) break;
   }
+  if (sscanf(buffer, "%*s = %79s", moivalue) != 1) moivalue[0] = 0;
 # else
   fscanf(fp,"%s %*s %d",token,&moi);
+  moivalue[0] = 0;
 # endif
 
   /* Make sure that we read MOI */
@@ -636,6 +778,9 @@ char *mech;
     exit(-1);
   }
 
+  /* Sequences given more than one copy are phage: --moi and superinfection add to them */
+  tmpl->FollowsMOI= (moi!=1);
+
 #ifdef RMM_MODS
   /* Reset the MOI using the command line option */
   if (global_MOI != 0 && moi != 1) moi = global_MOI;
@@ -658,8 +803,7 @@ char *mech;
 
     /**** Find name ****/
 
-    sequence= &Sequence[NSequences-1];
-    while(sequence!=NULL && strcmp(sequence->Name,name[i])!=0) sequence= sequence->RightSegment;
+    sequence= FindSegment(tmpl,name[i]);
 
     if(sequence==NULL){
       fprintf(stderr,"%s: Parameters for unknown segment %s found in mechanism %s.\n",progid,name[i],mech);
@@ -687,13 +831,6 @@ char *mech;
 
     sequence->Length= mult*length;      
 
-
-    /**** When copying for MOI:
-     ****
-     **** New RNAP Queues for all!
-     **** Full Copies of Shea data must be made
-     ****/
-
     if(strcasecmp(type,"Promotor")==0 || strcasecmp(type,"Promoter")==0)
       sequence->Type= DNA_Type_Promotor;
     else
@@ -716,187 +853,90 @@ char *mech;
 
   } /** End for rflag **/
 
+  /**** Split the segments into promotor and segment records ******/
+
+  tmpl->NPromotors=0;
+  tmpl->NSegmentRecs=0;
+  length=0;
+  for(j=0; j<rflag; j++){
+    sequence= &tmpl->Segment[j];
+    if(sequence->Type==DNA_Type_Promotor) sequence->Data= tmpl->NPromotors++;
+    else                                  sequence->Data= tmpl->NSegmentRecs++;
+    sequence->Offset= length;
+    length+= sequence->Length;
+  }
 
-  /**** Now we make multiple infections ******/
-
-  firstcopy= NSequences-1;
-
-  for(i=1; i<moi; i++){
-    DNA *fseq;
-
-    NSequences++;
-    Sequence= (DNA *) rrealloc(Sequence,NSequences,sizeof(DNA),"ReadDNA.10");
-    sequence=(DNA *) &Sequence[NSequences-1];
-
-  /****
-   *
-   * We've realloc'ed....we gotta reset 
-   * the pointers to the first segment of 
-   * the first sequence 
-   ****/
-    
-    for(j=0; j<NSequences-1; j++){
-      fseq= &Sequence[j];
-      if(fseq->RightSegment != NULL)
-	fseq->RightSegment->LeftSegment=fseq;
-    }
+  tmpl->Promotor=   (PROMTEMPLATE *) rcalloc(tmpl->NPromotors+1,sizeof(PROMTEMPLATE),"ReadDNA.10");
+  tmpl->SegmentRec= (SEGMENT *)      rcalloc(tmpl->NSegmentRecs+1,sizeof(SEGMENT),"ReadDNA.11");
 
-    fseq= &Sequence[firstcopy];
-
-    sequence->Name= (char *) rcalloc(strlen(fseq->Name)+4+1,sizeof(char),"ReadDNA.11");
-#   ifdef RMM_MODS
-    sprintf(sequence->Name,"%s_%d",fseq->Name,i);
-#   else
-    sprintf(sequence->Name,"%s.%d",fseq->Name,i);
-#   endif
-    sequence->Length       = fseq->Length;
-    sequence->Direction    = fseq->Direction;
-    sequence->Type         = fseq->Type;
-    sequence->LeftSegment  = NULL;
-    
-    fseq=fseq->RightSegment;
-    while(fseq!=NULL){
-
-      sequence->RightSegment= (DNA *) rcalloc(1,sizeof(DNA),"ReadDNA.12");
-      sequence->RightSegment->Name= (char *) rcalloc(strlen(fseq->Name)+4+1,sizeof(char),"ReadDNA.13");
-#     ifdef RMM_MODS
-      sprintf(sequence->RightSegment->Name,"%s_%d",fseq->Name,i);
-#     else
-      sprintf(sequence->RightSegment->Name,"%s.%d",fseq->Name,i);
-#     endif
-      sequence->RightSegment->Length       = fseq->Length;
-      sequence->RightSegment->Direction    = fseq->Direction;
-      sequence->RightSegment->Type         = fseq->Type;
-
-      sequence->RightSegment->LeftSegment=sequence;
-      sequence=sequence->RightSegment;
-      fseq=fseq->RightSegment;
-    }
-    sequence->RightSegment=NULL;
-  }
-      
   /**** Now we read in parameter files ******/
 
   /******
-   ****** Currently, in all cases except promotors,
-   ****** all copies of a given sequence can 
-   ****** share common segment data-structures
-   ****** in order to conserve memory.
-   ****** 
-   ****** Promotors on the other hand MUST have
-   ****** separate ACKERSSHEA data structures since
-   ****** the state of the promotor is time-dependent.
-   ******
+   ****** Everything is read once into the template, 
+   ****** except that each copy of a promotor MUST have
+   ****** its own ACKERSSHEA data structure since the
+   ****** state of the promotor is time-dependent.
    ******/
 
-  for(i=0; i<moi; i++){
-   
-   for(j=0; j<rflag; j++){
-
-#    ifdef RMM_MODS
-     sprintf(buffer, i > 0 ? "%s_%d" : "%s", name[j], i);
-#    else
-     if(i>0)
-       sprintf(buffer,"%s.%d",name[j],i);
-     else 
-       sprintf(buffer,"%s",name[j]);
-#    endif
-
-     sequence= &Sequence[firstcopy+i];
-     while(sequence!=NULL && strcmp(sequence->Name,buffer)!=0)
-       sequence= sequence->RightSegment;
-     
-     if(sequence==NULL){
-       fprintf(stderr,"@@@ NULL sequence found when searching %s for %s.\n",
-	       Sequence[firstcopy+i].Name,name[j]);
-       exit(-1);
-     }
+  SeqTemplate= (SEQTEMPLATE **) rrealloc(SeqTemplate,NSeqTemplates+1,sizeof(SEQTEMPLATE *),"ReadDNA.12");
+  Sim->Copies= (SEQCOPIES *) rrealloc(Sim->Copies,NSeqTemplates+1,sizeof(SEQCOPIES),"ReadDNA.13");
+  memset(&Sim->Copies[NSeqTemplates],0,sizeof(SEQCOPIES));
+  tmpl->Index= NSeqTemplates;
+  SeqTemplate[NSeqTemplates++]= tmpl;
+  BindParam(moivalue,PARAM_MOI,tmpl->Index,1.0);
+
+  seq= NewSequenceCopy(tmpl);
+
+  for(j=0; j<rflag; j++){
+
+    sequence= &tmpl->Segment[j];
      
-     switch(sequence->Type){
+    switch(sequence->Type){
        
-     case DNA_Type_Promotor:
-#ifdef RMM_MODS
-       /* Keep a list of the promoters for future reference */
-       if (DebugLevel >= 3)
-	 fprintf(logfp, "Reading promoter %s, copy %d\n", sequence->Name, i);
-
-       if (NPromotors == 0) {
-	 /* Allocate space for the promotor list */
-	 Promotor = (PROMOTOR **) rcalloc(1,
-					 sizeof(PROMOTOR *), "ReadDNA.14a");
-       } else {
-	 /* Reallocate a larger list */
-	 Promotor = (PROMOTOR **) rrealloc(Promotor, NPromotors + 1,
-					  sizeof(PROMOTOR*), "ReadDNA.14b");
-       }
-       prom = (PROMOTOR *) rcalloc(1, sizeof(PROMOTOR), "ReadDNA.14c");
-       prom->Name = sequence->Name;
-       Promotor[NPromotors++] = prom;
-#else
-       prom = (PROMOTOR *) rcalloc(1, sizeof(PROMOTOR), "ReadDNA.14");
-#endif
-       sequence->DNAStruct= (void *)  prom;
-       prom->RNAPQueue=NULL;
-       ReadPromotorData(i,prom,parameters[j]);
-       break;
+    case DNA_Type_Promotor:
+      if (DebugLevel >= 3)
+	fprintf(logfp, "Reading promoter %s\n", sequence->Name);
+      ReadPromotorData(&seq->Promotor[sequence->Data],parameters[j]);
+      break;
        
-     case DNA_Type_Terminator:
-       seg= (SEGMENT *) rcalloc(1,sizeof(SEGMENT),"ReadDNA.15");
-       sequence->DNAStruct= (void *) seg; 
-       seg->RNAPQueue=NULL;
-       seg->SegmentFunc=SubmitTermination;
-       if(i==0)
-	 // Read data for the first copy of the DNA only
-	 ReadTerminatorData(seg,parameters[j]);
-       else
-	 // For MOI > 1, just save a pointer to the parameters
-	 seg->SegmentData= (void *) FindSegData(&Sequence[firstcopy],name[j]);
-       break;
-
-     case DNA_Type_AntiTerminator:
-       seg= (SEGMENT *) rcalloc(1,sizeof(SEGMENT),"ReadDNA.16");
-       sequence->DNAStruct= (void *) seg; 
-       seg->RNAPQueue=NULL;
-       seg->SegmentFunc=SubmitAntiTermination;
-       if(i==0)  
-	 ReadAntiTerminatorData(seg,parameters[j]);
-       else
-	 seg->SegmentData= (void *) FindSegData(&Sequence[firstcopy],name[j]);
-       break;
-
-     case DNA_Type_Coding:
-       seg= (SEGMENT *) rcalloc(1,sizeof(SEGMENT),"ReadDNA.17");
-       sequence->DNAStruct= (void *) seg; 
-       seg->RNAPQueue=NULL;
-       seg->SegmentFunc=SubmitProduceTranscript;
-       ReadCodingData(seg,parameters[j]);
-/*
-       if(i==0)  
-
-       else
-	 seg->SegmentData= (void *) FindSegData(&Sequence[firstcopy],name[j]);
-*/
-       break;
-
-     case DNA_Type_NonCoding:
-       seg= (SEGMENT *) rcalloc(1,sizeof(SEGMENT),"ReadDNA.19");
-       sequence->DNAStruct= (void *) seg; 
-       seg->RNAPQueue=NULL;
-       seg->SegmentFunc=SubmitSimpleJumpSegment;
-       if(i==0)  
-	 ReadNonCodingData(seg,parameters[j]);
-       else
-	 seg->SegmentData= (void *) FindSegData(&Sequence[firstcopy],name[j]);
-       break;
+    case DNA_Type_Terminator:
+      seg= &tmpl->SegmentRec[sequence->Data];
+      seg->SegmentFunc=SubmitTermination;
+      ReadTerminatorData(seg,parameters[j]);
+      break;
+
+    case DNA_Type_AntiTerminator:
+      seg= &tmpl->SegmentRec[sequence->Data];
+      seg->SegmentFunc=SubmitAntiTermination;
+      ReadAntiTerminatorData(seg,parameters[j]);
+      break;
+
+    case DNA_Type_Coding:
+      seg= &tmpl->SegmentRec[sequence->Data];
+      seg->SegmentFunc=SubmitProduceTranscript;
+      ReadCodingData(seg,parameters[j]);
+      break;
+
+    case DNA_Type_NonCoding:
+      seg= &tmpl->SegmentRec[sequence->Data];
+      seg->SegmentFunc=SubmitSimpleJumpSegment;
+      ReadNonCodingData(seg,parameters[j]);
+      break;
        
-     default:
-       fprintf(stderr,"%s: Unknown DNA_Type %d found in mechanism %s\n",
-	       progid,sequence->Type,mech);
-       exit(-1);
-     }    
-   } /* for j */
-   
- }/* for i */
+    default:
+      fprintf(stderr,"%s: Unknown DNA_Type %d found in mechanism %s\n",
+	      progid,sequence->Type,mech);
+      exit(-1);
+    }    
+  } /* for j */
+
+  /**** Now we make multiple infections ******/
+
+  for(i=1; i<moi; i++){
+    seq= NewSequenceCopy(tmpl);
+    for(j=0; j<tmpl->NPromotors; j++)
+      AttachOperator(&seq->Promotor[j]);
+  }
 
   for(i=0; i<rflag; i++){
     free(parameters[i]);
@@ -908,34 +948,299 @@ char *mech;
 
   fclose(fp);
 }
+
+SEGTEMPLATE *FindSegment(tmpl,name)
+SEQTEMPLATE *tmpl;
+char        *name;
+{
+  int i;
+
+  for(i=0; i<tmpl->NSegments; i++)
+    if(strcmp(tmpl->Segment[i].Name,name)==0)
+      return(&tmpl->Segment[i]);
+
+  return(NULL);
+}
+
+/***********************
+ * 
+ * Sequence Copies
+ *
+ * Copies of a sequence are made from its template, both while
+ * parsing (MOI) and during a run (superinfection, or a driver
+ * that runs trajectories at several MOIs without parsing the
+ * mechanism again).
+ *
+ ***********************/
+
+/* Make a copy of a sequence; its promotors are not yet tied to operators */
+SEQUENCE *NewSequenceCopy(tmpl)
+SEQTEMPLATE *tmpl;
+{
+  int j;
+  SEQUENCE  *seq;
+  SEQCOPIES *copies;
+  DNA       *dna;
+  PROMOTOR  *prom;
+
+  copies= SEQ_COPIES(tmpl);
+
+  seq= (SEQUENCE *) rcalloc(1,sizeof(SEQUENCE),"NewSequenceCopy.1");
+  seq->Template= tmpl;
+  seq->Copy= copies->MaxCopies;
+  seq->Segment=  (DNA *)      rcalloc(tmpl->NSegments,sizeof(DNA),"NewSequenceCopy.2");
+  seq->Promotor= (PROMOTOR *) rcalloc(tmpl->NPromotors+1,sizeof(PROMOTOR),"NewSequenceCopy.3");
+  seq->RNAPs.ActiveIndex= -1;
+
+  for(j=0; j<tmpl->NSegments; j++){
+    dna= &seq->Segment[j];
+    dna->Seq= seq;
+    dna->T= &tmpl->Segment[j];
+    if(dna->T->Type!=DNA_Type_Promotor) continue;
+
+    prom= DNA_PROMOTOR(dna);
+    prom->T= &tmpl->Promotor[dna->T->Data];
+    prom->Segment= dna;
+    prom->FiringIndex= -1;
+#ifdef RMM_MODS
+    /* Keep a list of the promoters for future reference */
+    Sim->Promotor= (PROMOTOR **) rrealloc(Sim->Promotor,Sim->NPromotors+1,sizeof(PROMOTOR *),"NewSequenceCopy.4");
+    Sim->Promotor[Sim->NPromotors++]= prom;
+#endif
+  }
+
+  copies->Copy= (SEQUENCE **) rrealloc(copies->Copy,copies->MaxCopies+1,sizeof(SEQUENCE *),"NewSequenceCopy.5");
+  copies->Copy[copies->MaxCopies++]= seq;
+  copies->NCopies++;
+
+  Sim->Sequence= (SEQUENCE **) rrealloc(Sim->Sequence,Sim->NSequences+1,sizeof(SEQUENCE *),"NewSequenceCopy.6");
+  Sim->Sequence[Sim->NSequences++]= seq;
+
+  return(seq);
+}
+
+/*
+ * Tie a promotor to the operator <file>_<copy> for its copy of the
+ * sequence, making the operator if this is the first promotor on it.
+ */
+void AttachOperator(prom)
+PROMOTOR *prom;
+{
+  int i,copy;
+  char name[85];
+  SHEADATA *oper;
+
+  void ReadSheaAckers();
+
+  copy= prom->Segment->Seq->Copy;
+  sprintf(name,"%s%c%d",prom->T->SheaAckers,COPY_SEPARATOR,copy);
+
+  /* Look to see if we have already read this operator file */
+  for(i=0; i<Sim->NOperators; i++)
+    if(strcmp(name,Sim->Operator[i].Name)==0)
+      break;
   
-void *FindSegData(Seq,name)
-DNA *Seq;
-char *name;
+  /* If we haven't read the operator file, do so now */
+  if(i==Sim->NOperators){
+    if (DebugLevel >= 3)
+      fprintf(logfp,"@@@ Reading SheaAckers for copy %d\n",copy);
+    ReadSheaAckers(copy,prom->T->SheaAckers);
+  }
+
+  prom->Data= i;
+
+  /* Keep track of the promotors controlled by each operator */
+  oper= &Sim->Operator[i];
+  oper->Promotors= (PROMOTOR **) 
+    rrealloc(oper->Promotors,oper->NPromotors+1,sizeof(PROMOTOR *),"AttachOperator");
+  oper->Promotors[oper->NPromotors++]= prom;
+}
+
+/*
+ * Add a copy of a sequence to a running cell, reusing one removed
+ * earlier if there is one.  The operators of the copy start idle;
+ * any operator it shares with another sequence is regrouped, as the
+ * promotors it controls have changed.
+ */
+SEQUENCE *AddSequenceCopy(tmpl)
+SEQTEMPLATE *tmpl;
 {
-  DNA     *seq;
-  SEGMENT *seg;
-
-  seq=Seq;
-  while(seq!=NULL){
-    if(strcmp(seq->Name,name)==0){
-      if(seq->Type==DNA_Type_Promotor){
-	fprintf(stderr,"%s: FindSegData() passed an incorrect data type named %s\n",
-		progid,name);
-	exit(-1);
-      }
+  int p;
+  SEQUENCE  *seq;
+  SEQCOPIES *copies;
+  SHEADATA  *oper;
+
+  SEQUENCE *NewSequenceCopy();
+  void AttachOperator();
+  void JoinOperatorGroup();
+  void LeaveOperatorGroup();
+  void UpdateOperatorState();
+
+  copies= SEQ_COPIES(tmpl);
+  if(copies->NCopies<copies->MaxCopies){
+    seq= copies->Copy[copies->NCopies++];
+    Sim->Sequence= (SEQUENCE **) rrealloc(Sim->Sequence,Sim->NSequences+1,sizeof(SEQUENCE *),"AddSequenceCopy");
+    Sim->Sequence[Sim->NSequences++]= seq;
+  } else
+    seq= NewSequenceCopy(tmpl);
+
+  for(p=0; p<tmpl->NPromotors; p++)
+    AttachOperator(&seq->Promotor[p]);
+
+  for(p=0; p<tmpl->NPromotors; p++){
+    oper= &Sim->Operator[seq->Promotor[p].Data];
+    if(oper->Group!=NULL) LeaveOperatorGroup(oper);
+  }
 
-      seg= (SEGMENT *) seq->DNAStruct;
+  for(p=0; p<tmpl->NPromotors; p++){
+    oper= &Sim->Operator[seq->Promotor[p].Data];
+    if(oper->Group!=NULL) continue;
+    JoinOperatorGroup(oper);
+    UpdateOperatorState(oper,oper->CurrentState);
+  }
 
-      return((void *) seg->SegmentData);
-    }
-    seq=seq->RightSegment;
+  DEBUG(1) fprintf(logfp,"@@@ Added copy %d of %s\n",seq->Copy,tmpl->Segment[0].Name);
+
+  return(seq);
+}
+
+/*
+ * Remove the last copy of a sequence from a running cell.  This is
+ * only possible while no RNAP or transcript refers to the copy;
+ * otherwise nothing is done and Failure is returned.  The copy and
+ * its operators are kept, out of the cell, so that the output columns
+ * do not move; they are reused if the copy is added again.
+ */
+short RemoveSequenceCopy(tmpl)
+SEQTEMPLATE *tmpl;
+{
+  SEQUENCE  *seq;
+  SEQCOPIES *copies;
+  mRNA      *trans;
+
+  void DetachSequenceCopy();
+
+  copies= SEQ_COPIES(tmpl);
+  if(copies->NCopies==0) return(Failure);
+  seq= copies->Copy[copies->NCopies-1];
+
+  if(seq->RNAPs.NRNAPs>0) return(Failure);
+  for(trans=Sim->Transcript; trans!=NULL; trans=trans->NextTranscript)
+    if(trans->Gene->Seq==seq) return(Failure);
+
+  DetachSequenceCopy(seq);
+
+  return(Success);
+}
+
+/*
+ * Give any copy of a sequence to the other daughter at division,
+ * together with the RNAPs on it.  Transcripts already released stay
+ * in the cell; the copy they refer to is kept for reuse, as above.
+ */
+void GiveAwaySequenceCopy(seq)
+SEQUENCE *seq;
+{
+  int i;
+  SEQCOPIES *copies;
+
+  void GiveAwayRNAPs();
+  void DetachSequenceCopy();
+
+  copies= SEQ_COPIES(seq->Template);
+  GiveAwayRNAPs(seq);
+
+  /* Swap the copy to the end of the active copies */
+  for(i=0; copies->Copy[i]!=seq; i++);
+  copies->Copy[i]= copies->Copy[copies->NCopies-1];
+  copies->Copy[copies->NCopies-1]= seq;
+
+  DetachSequenceCopy(seq);
+}
+
+/* Take the last active copy of its template, free of RNAPs, out of the cell */
+void DetachSequenceCopy(seq)
+SEQUENCE *seq;
+{
+  int i,j,p;
+  SEQTEMPLATE *tmpl;
+  SHEADATA *oper;
+  PROMOTOR *prom;
+
+  void JoinOperatorGroup();
+  void LeaveOperatorGroup();
+  void UpdateOperatorState();
+  void StopPromotor();
+
+  tmpl= seq->Template;
+
+  for(p=0; p<tmpl->NPromotors; p++){
+    prom= &seq->Promotor[p];
+    oper= &Sim->Operator[prom->Data];
+    StopPromotor(prom);
+    if(oper->Group!=NULL) LeaveOperatorGroup(oper);
+
+    for(j=0; oper->Promotors[j]!=prom; j++);
+    for(j++; j<oper->NPromotors; j++)
+      oper->Promotors[j-1]= oper->Promotors[j];
+    oper->NPromotors--;
+  }
+
+  for(p=0; p<tmpl->NPromotors; p++){
+    oper= &Sim->Operator[seq->Promotor[p].Data];
+    if(oper->Group!=NULL || oper->NPromotors==0) continue;
+    JoinOperatorGroup(oper);
+    UpdateOperatorState(oper,oper->CurrentState);
   }
 
-  fprintf(stderr,"%s: FindSegData() unable to find segment named %s in sequence.\n",
-	  progid,name);
+  for(i=0; Sim->Sequence[i]!=seq; i++);
+  for(i++; i<Sim->NSequences; i++)
+    Sim->Sequence[i-1]= Sim->Sequence[i];
+  Sim->NSequences--;
+  SEQ_COPIES(tmpl)->NCopies--;
 
-  exit(-1);  
+  DEBUG(1) fprintf(logfp,"@@@ Removed copy %d of %s\n",seq->Copy,tmpl->Segment[0].Name);
+}
+
+/*
+ * Set the number of copies of every sequence that follows the MOI.
+ * Copies are removed from the last; Failure is returned if one of 
+ * them is still in use.
+ */
+short SetMOI(moi)
+int moi;
+{
+  int i;
+  SEQTEMPLATE *tmpl;
+
+  SEQUENCE *AddSequenceCopy();
+  short RemoveSequenceCopy();
+
+  for(i=0; i<NSeqTemplates; i++){
+    tmpl= SeqTemplate[i];
+    if(!tmpl->FollowsMOI) continue;
+
+    while(SEQ_COPIES(tmpl)->NCopies<moi)
+      AddSequenceCopy(tmpl);
+    while(SEQ_COPIES(tmpl)->NCopies>moi)
+      if(RemoveSequenceCopy(tmpl)==Failure) return(Failure);
+  }
+
+  return(Success);
+}
+
+/* Infect the cell with n more copies of every sequence that follows the MOI */
+void Superinfect(n)
+int n;
+{
+  int i,k;
+
+  SEQUENCE *AddSequenceCopy();
+
+  for(i=0; i<NSeqTemplates; i++)
+    if(SeqTemplate[i]->FollowsMOI)
+      for(k=0; k<n; k++)
+	AddSequenceCopy(SeqTemplate[i]);
 }
 
 /***********************
@@ -944,17 +1249,15 @@ char *name;
  *
  ***********************/
 
-void ReadPromotorData(copy,prom,params)
-int        copy;
+void ReadPromotorData(prom,params)
 PROMOTOR  *prom;
 char      *params;
 {
-  int i;
   char token1[85],token2[85],token3[85];
   
   FILE *fp;
   
-  void ReadSheaAckers();
+  void AttachOperator();
   void ReadIsoData();
 
   /***** Promotor Data files contain the following information:
@@ -981,8 +1284,11 @@ char      *params;
   /*
    * RMM notes (27 Apr 10): the way that having separate operators for
    * different copies of the DNA is handled (case three) is by setting
-   * the operator name to be of the form <name>_<copy>.  This forces a
-   * reread of the Shea/Ackers file for each copy of the gene.
+   * the operator name to be of the form <name>_<copy>.  Each copy gets
+   * its own operator, but the configurations and energies read from
+   * the Shea/Ackers file are shared with copy 0 (see ReadSheaAckers()).
+   * Only the first copy of a promotor is read from its data file; the
+   * others are tied to their operators by AttachOperator().
    *
    * Note that if you use the same S/A file name for different strands
    * of DNA (in separate files), then the operators are equated across
@@ -997,10 +1303,6 @@ char      *params;
    * strand, however.
    */
 
-#ifdef RMM_MODS
-  prom->RNAPCount = 0;
-#endif
-
   fp= OpenFile(params,"r");
 
   fgets(token3,81,fp);
@@ -1014,10 +1316,10 @@ char      *params;
     exit(-1);
   }
 
-  prom->TranscriptionDirection= ( strcasecmp(token2,"LEFT")==0  ? LEFT  :
-				  strcasecmp(token2,"RIGHT")==0 ? RIGHT : -1);
+  prom->T->TranscriptionDirection= ( strcasecmp(token2,"LEFT")==0  ? LEFT  :
+				     strcasecmp(token2,"RIGHT")==0 ? RIGHT : -1);
 
-  if(prom->TranscriptionDirection== -1){
+  if(prom->T->TranscriptionDirection== -1){
     fprintf(stderr,"%s: Invalid Transcription Direction %s found in parameter file %s.\n",
 	    progid,token2,params);
     exit(-1);
@@ -1031,25 +1333,9 @@ char      *params;
     exit(-1);
   }
 
-# ifdef RMM_MODS
-  sprintf(token3, "%s_%d", token2, copy);
-# else
-  sprintf(token3,"%s.%d",token2,copy);
-# endif
-
-  /* Look to see if we have already read this operator file */
-  for(i=0; i<NOperators; i++)
-    if(strcmp(token3,Operator[i].Name)==0)
-      break;
-  
-  /* If we haven't read the operator file, do so now */
-  if(i==NOperators){
-    if (DebugLevel >= 3)
-      fprintf(logfp,"@@@ Reading SheaAckers for copy %d\n",copy);
-    ReadSheaAckers(copy,token2);
-  }
-
-  prom->Data= i;
+  prom->T->SheaAckers= (char *) rcalloc(strlen(token2)+1,sizeof(char),"ReadPromotorData.1");
+  strcpy(prom->T->SheaAckers,token2);
+  AttachOperator(prom);
 
   fscanf(fp,"%s %*s %s",token1,token2);
   
@@ -1067,6 +1353,13 @@ char      *params;
 #define kcal_per_joule (0.001/4.184)
 #define RT (8.314*310.15*kcal_per_joule)            /* (J/(mol K))*K = J/mol */   
 
+/*
+ * The configurations read from each S/A file, by file name.  They
+ * are shared by all the copies of its operator, in every context.
+ */
+static int       NSheaAckersFiles=0;
+static SHEADATA *SheaAckersFile=NULL;
+
 void ReadSheaAckers(copy,file)
 int copy;
 char *file;
@@ -1078,17 +1371,21 @@ char *file;
   int     **configs;
   char      speciesname[80];
   FILE     *fp;
-  SHEADATA *oper;
+  SHEADATA *oper,*read;
 
   int  FindSpecies();
   void AddSpecies();
   void MakeConfigList();
+  void RelinkOperatorGroups();
 
-  if(NOperators==0) Operator= (SHEADATA *) rcalloc(1,sizeof(SHEADATA),"ReadSheaAckers.1");
-  else              Operator= (SHEADATA *) rrealloc(Operator,NOperators+1,sizeof(SHEADATA),"ReadSheaAckers.1");
+  if(Sim->NOperators==0) Sim->Operator= (SHEADATA *) rcalloc(1,sizeof(SHEADATA),"ReadSheaAckers.1");
+  else                   Sim->Operator= (SHEADATA *) rrealloc(Sim->Operator,Sim->NOperators+1,sizeof(SHEADATA),"ReadSheaAckers.1");
 
-  oper= &Operator[NOperators];
-  NOperators++;
+  /* During a run the groups point into the old array (see AddSequenceCopy()) */
+  if(Sim->NOperGroups>0) RelinkOperatorGroups();
+
+  oper= &Sim->Operator[Sim->NOperators];
+  Sim->NOperators++;
     
   oper->Name= (char *) rcalloc(strlen(file)+1+4,sizeof(char),"ReadSheaAckers.2");
 # ifdef RMM_MODS
@@ -1097,6 +1394,21 @@ char *file;
   sprintf(oper->Name,"%s.%d",file,copy);
 # endif
 
+  oper->CurrentState=0;
+  oper->NPromotors=0;
+  oper->Promotors=NULL;
+  oper->Group=NULL;
+
+  /* Copies of an operator share the configurations read for the first */
+  for(i=0; i<NSheaAckersFiles; i++)
+    if(strcmp(file,SheaAckersFile[i].Name)==0){
+      oper->NSites=   SheaAckersFile[i].NSites;
+      oper->NConfigs= SheaAckersFile[i].NConfigs;
+      oper->DeltaG=   SheaAckersFile[i].DeltaG;
+      oper->CList=    SheaAckersFile[i].CList;
+      return;
+    }
+
   fp=OpenFile(file,"r");
 
   fscanf(fp,"%d %d",&NSites,&NConfigs);
@@ -1136,7 +1448,6 @@ char *file;
   }
   
   oper->DeltaG=deltaG;
-  oper->CurrentState=0;
 
   MakeConfigList(oper,configs);
 
@@ -1144,6 +1455,16 @@ char *file;
   free(configs);
 
   fclose(fp);
+
+  SheaAckersFile= (SHEADATA *) rrealloc(SheaAckersFile,NSheaAckersFiles+1,sizeof(SHEADATA),"ReadSheaAckers.6");
+  read= &SheaAckersFile[NSheaAckersFiles++];
+  memset(read,0,sizeof(SHEADATA));
+  read->Name= (char *) rcalloc(strlen(file)+1,sizeof(char),"ReadSheaAckers.7");
+  strcpy(read->Name,file);
+  read->NSites=   oper->NSites;
+  read->NConfigs= oper->NConfigs;
+  read->DeltaG=   oper->DeltaG;
+  read->CList=    oper->CList;
 }
 
 void MakeConfigList(data,configs)
@@ -1199,13 +1520,13 @@ char     *file;
   
   fp= OpenFile(file,"r");
   
-  NConfigs= Operator[prom->Data].NConfigs;
-  prom->IsoRate= (double *) rcalloc(NConfigs,sizeof(double),"ReadIsoData.1");
+  NConfigs= Sim->Operator[prom->Data].NConfigs;
+  prom->T->IsoRate= (double *) rcalloc(NConfigs,sizeof(double),"ReadIsoData.1");
 
   for(i=0; i<NConfigs; i++)
-    if(fscanf(fp,"%lf",&prom->IsoRate[i])==EOF){
+    if(fscanf(fp,"%lf",&prom->T->IsoRate[i])==EOF){
       fprintf(stderr,"%s: Short IsoFile %s found linked to operator %s.\n",
-	     progid,file,Operator[prom->Data].Name);
+	     progid,file,Sim->Operator[prom->Data].Name);
       exit(-1);
     }
   
@@ -1561,6 +1882,7 @@ char     *params;
   }
 
   tdata->mRNADegradationRate= value;
+  BindParam(token2,PARAM_FIXED,0,1.0);
 
   mult= FindTimeUnit(token3);
   if(mult<0.0){
@@ -1587,6 +1909,7 @@ char     *params;
       fprintf(stderr, "bad format for token '%s': '%s'\n", token1, token3);
       exit(1);
     }
+    BindParam(token2,PARAM_FIXED,0,1.0);
 
     /* Check for each optional value in turn */
     if (strcasecmp(token1, "RibosomeBindingRate") == 0) {
@@ -49,13 +49,17 @@
  #include "Memory.h"
 #endif
 
+#ifndef RANDOM
+ #include "Rng.h"
+#endif
+
 /****************************/
 /**** Calculate States ******/
 /****************************/
 
 #define kcal_per_joule (0.001/4.184)
 #define RT (8.314*310.15*kcal_per_joule)            /* (J/(mol K))*K = J/mol */   
-#define Molec_to_Molar (1.0/(6.023e23*EColi->V))     /* 1 Mole/(6.023*10^23 (molecs) * 1.41e-15 (L)) */
+#define Molec_to_Molar (1.0/(6.023e23*Sim->EColi->V))   /* 1 Mole/(6.023*10^23 (molecs) * 1.41e-15 (L)) */
 
 void CalculateAckersProbabilities(data,prob)
 SHEADATA *data;
@@ -79,7 +83,7 @@ double *prob;
         spec=data->CList[i][1+2*j];
 	cnt =data->CList[i][1+2*j+1];
 
-	prob[i] *= (double) bico(Concentration[spec],cnt);
+	prob[i] *= (double) bico(Sim->Concentration[spec],cnt);
 	if(prob[i]==0.0) break;
 	prob[i] *= (powm[cnt] ? powm[cnt] :
 		    (powm[cnt]=pow(Molec_to_Molar,cnt)));
@@ -98,7 +102,7 @@ double *prob;
   register int i,j;
   double rndm,running_prob;
 
-  rndm= 1.0-drand48(); /* Interval Now (0,1] instead of [0,1) */
+  rndm= 1.0-RngUniform(Sim->Rng); /* Interval Now (0,1] instead of [0,1) */
   running_prob=prob[0];
 
   /**** Roulette Wheel Selection ****/
@@ -123,28 +127,25 @@ return(j);
 void SetAckersState(data)
 SHEADATA *data;
 {
-  static double *prob=NULL;
-  static int MaxConfig=0;
   int i,newstate,species;
+  double *prob;
 
   void CalculateAckersProbabilities();
   int  CalculateAckersState();
+  void UpdateOperatorState();
 
 
   /**** Release Current State *******/ 
   /**** (Rapid Equilibrium is assumed ****/
 
   for(i=0; i<data->CList[data->CurrentState][0]; i++)
-    Concentration[data->CList[data->CurrentState][1+2*i]] += data->CList[data->CurrentState][1+2*i+1]; 
-
-  if(prob==NULL){
-    prob= (double *) rcalloc(data->NConfigs,sizeof(double),"SetSheaAckersState");
-    MaxConfig=data->NConfigs;
-  }else
-    if(data->NConfigs>MaxConfig){
-      prob= (double *) rrealloc((void *) prob,data->NConfigs,sizeof(double),"SetSheaAckersState");
-      MaxConfig=data->NConfigs;
-    }
+    Sim->Concentration[data->CList[data->CurrentState][1+2*i]] += data->CList[data->CurrentState][1+2*i+1]; 
+
+  if(data->NConfigs>Sim->MaxConfigs){
+    Sim->ConfigProb= (double *) rrealloc((void *) Sim->ConfigProb,data->NConfigs,sizeof(double),"SetSheaAckersState");
+    Sim->MaxConfigs=data->NConfigs;
+  }
+  prob= Sim->ConfigProb;
   
   CalculateAckersProbabilities(data,prob);
   newstate=CalculateAckersState(data->NConfigs,prob);
@@ -153,11 +154,410 @@ SHEADATA *data;
   /**** Bind up new molecules ****/
 
   for(i=0; i<data->CList[newstate][0]; i++)
-    Concentration[data->CList[newstate][1+2*i]] -= data->CList[newstate][1+2*i+1]; 
+    Sim->Concentration[data->CList[newstate][1+2*i]] -= data->CList[newstate][1+2*i+1]; 
   
 
   
-  data->CurrentState=newstate;
+  if(newstate!=data->CurrentState) UpdateOperatorState(data,newstate);
+}
+
+/*****************************************
+ *
+ * Set the state of an operator, keeping the
+ * list of promotors that are able to fire 
+ * (FiringPromotor[], see Polymerize()) up to date.
+ *
+ *****************************************/
+
+void UpdateOperatorState(data,state)
+SHEADATA *data;
+int state;
+{
+  int i;
+  PROMOTOR *prom;
+  void StopPromotor();
+
+  data->CurrentState=state;
+
+  for(i=0; i<data->NPromotors; i++){
+    prom= data->Promotors[i];
+
+    /* Idle copies fire through their group (see SubmitIdleInitiations()) */
+    if(prom->T->IsoRate[state]!=0.0 && !OPERATOR_IDLE(data)){
+      if(prom->FiringIndex>=0) continue;
+
+      if(Sim->NFiringPromotors==Sim->MaxFiringPromotors){
+	Sim->MaxFiringPromotors= (Sim->MaxFiringPromotors==0 ? 16 : 2*Sim->MaxFiringPromotors);
+	Sim->FiringPromotor= (PROMOTOR **) rrealloc(Sim->FiringPromotor,Sim->MaxFiringPromotors,sizeof(PROMOTOR *),"UpdateOperatorState");
+      }
+      prom->FiringIndex= Sim->NFiringPromotors;
+      Sim->FiringPromotor[Sim->NFiringPromotors++]= prom;
+
+    } else
+      StopPromotor(prom);
+  }
+}
+
+/* Take a promotor off the FiringPromotor[] list */
+void StopPromotor(prom)
+PROMOTOR *prom;
+{
+  if(prom->FiringIndex<0) return;
+
+  /* Move the last entry into our slot */
+  Sim->FiringPromotor[prom->FiringIndex]= Sim->FiringPromotor[--Sim->NFiringPromotors];
+  Sim->FiringPromotor[prom->FiringIndex]->FiringIndex= prom->FiringIndex;
+  prom->FiringIndex= -1;
+}
+
+/*****************************************
+ *
+ * Operator Groups
+ *
+ * Idle copies of an operator (no RNAPs on their DNA, see 
+ * DataStructures.h) are pooled by group.  Each step the
+ * configurations of the pool are drawn jointly as a 
+ * multinomial, split into conditional binomials, so the
+ * cost does not grow with the number of copies.  The 
+ * copies are treated as binding independently; if the draw
+ * asks for more molecules than are free we fall back to
+ * sampling the copies one after another as SetAckersState()
+ * does.
+ *
+ *****************************************/
+
+void SetGroupState(group)
+OPERGROUP *group;
+{
+  int i,c,n,k,last,spec,cnt,nconfigs,enough;
+  int *need;
+  double *prob;
+  int **clist;
+  double mass;
+  SHEADATA *data;
+
+  void CalculateAckersProbabilities();
+  int  CalculateAckersState();
+
+  data=     group->Template;
+  clist=    data->CList;
+  nconfigs= data->NConfigs;
+
+  /**** Release the pool (Rapid Equilibrium is assumed) ****/
+
+  for(c=0; c<nconfigs; c++){
+    if(group->Count[c]==0) continue;
+    for(i=0; i<clist[c][0]; i++)
+      Sim->Concentration[clist[c][1+2*i]] += group->Count[c]*clist[c][1+2*i+1];
+    group->Count[c]=0;
+  }
+
+  if(group->NIdle==0) return;
+
+  if(nconfigs>Sim->MaxConfigs){
+    Sim->ConfigProb= (double *) rrealloc((void *) Sim->ConfigProb,nconfigs,sizeof(double),"SetGroupState");
+    Sim->MaxConfigs=nconfigs;
+  }
+  if(Sim->SpeciesNeed==NULL)
+    Sim->SpeciesNeed= (int *) rcalloc(NSpecies,sizeof(int),"SetGroupState");
+  prob= Sim->ConfigProb;
+  need= Sim->SpeciesNeed;
+
+  CalculateAckersProbabilities(data,prob);
+
+  /**** Multinomial draw by conditional binomials ****/
+
+  n=    group->NIdle;
+  mass= 1.0;
+  last= 0;
+  for(c=0; c<nconfigs && n>0; c++){
+    if(prob[c]<=0.0) continue;
+    last= c;
+    k= (prob[c]>=mass ? n : RandomBinomial(n,prob[c]/mass));
+    group->Count[c]= k;
+    n    -= k;
+    mass -= prob[c];
+  }
+  group->Count[last] += n; /* Rounding in mass */
+
+  /**** Make sure the molecules are there ****/
+
+  for(c=0; c<nconfigs; c++)
+    if(group->Count[c]>0)
+      for(i=0; i<clist[c][0]; i++)
+	need[clist[c][1+2*i]] += group->Count[c]*clist[c][1+2*i+1];
+
+  enough= TRUE;
+  for(c=0; c<nconfigs; c++)
+    if(group->Count[c]>0)
+      for(i=0; i<clist[c][0]; i++){
+	spec= clist[c][1+2*i];
+	if(need[spec]>Sim->Concentration[spec]) enough= FALSE;
+      }
+
+  for(c=0; c<nconfigs; c++)
+    if(group->Count[c]>0)
+      for(i=0; i<clist[c][0]; i++){
+	spec= clist[c][1+2*i];
+	if(enough) Sim->Concentration[spec] -= need[spec];
+	need[spec]= 0;
+      }
+
+  if(enough) return;
+
+  /**** Not enough to go around: bind up copy by copy ****/
+
+  for(c=0; c<nconfigs; c++) group->Count[c]=0;
+
+  for(n=0; n<group->NIdle; n++){
+    CalculateAckersProbabilities(data,prob);
+    c= CalculateAckersState(nconfigs,prob);
+    for(i=0; i<clist[c][0]; i++){
+      spec= clist[c][1+2*i];
+      cnt=  clist[c][1+2*i+1];
+      Sim->Concentration[spec] -= cnt;
+    }
+    group->Count[c]++;
+  }
+}
+
+/*
+ * Set the states of all operators for this step: one draw for the
+ * idle pool of each group, and one for each explicit copy.  The 
+ * starting point is chosen at random as the order matters for the
+ * molecules left to bind.
+ */
+void SetOperatorStates()
+{
+  int i,j,m,nunits;
+  OPERGROUP **ugroup;
+  SHEADATA  **uoper;
+  OPERGROUP *group;
+
+  void SetAckersState();
+  void SetGroupState();
+
+  /* Copies may have been added since the last step */
+  if(Sim->NOperators+Sim->NOperGroups>Sim->MaxUnits){
+    Sim->MaxUnits= Sim->NOperators+Sim->NOperGroups;
+    Sim->UnitGroup= (OPERGROUP **) rrealloc(Sim->UnitGroup,Sim->MaxUnits,sizeof(OPERGROUP *),"SetOperatorStates");
+    Sim->UnitOper=  (SHEADATA **)  rrealloc(Sim->UnitOper,Sim->MaxUnits,sizeof(SHEADATA *),"SetOperatorStates");
+  }
+  ugroup= Sim->UnitGroup;
+  uoper=  Sim->UnitOper;
+
+  nunits=0;
+  for(i=0; i<Sim->NOperGroups; i++){
+    group= Sim->OperGroup[i];
+    if(group->NIdle>0){
+      ugroup[nunits]= group;
+      uoper[nunits++]= NULL;
+    }
+    for(m=group->NIdle; m<group->NMembers; m++){
+      ugroup[nunits]= NULL;
+      uoper[nunits++]= group->Member[m];
+    }
+  }
+
+  /*** Randomly set operator precedence ***/
+  j= (int) ((double) nunits*RngUniform(Sim->Rng));
+  for(i=0; i<nunits; i++){
+    if(ugroup[j]!=NULL) SetGroupState(ugroup[j]);
+    else                SetAckersState(uoper[j]);
+    j++;
+    if(j==nunits) j=0;
+  }
+}
+
+/* 
+ * Move an idle copy out of the pool, in configuration state
+ * (or in one drawn from the pool if state is negative).
+ */
+void PromoteOperator(data,state)
+SHEADATA *data;
+int state;
+{
+  int c,k,n;
+  SHEADATA  *other;
+  OPERGROUP *group;
+  void UpdateOperatorState();
+
+  group= data->Group;
+
+  if(state<0){
+    k= (int) ((double) group->NIdle*RngUniform(Sim->Rng));
+    for(c=0, n=0; ; c++){
+      n += group->Count[c];
+      if(k<n) break;
+    }
+    state= c;
+  }
+  group->Count[state]--;
+
+  /* Swap with the last idle copy and shrink the pool */
+  k=     data->MemberIndex;
+  other= group->Member[group->NIdle-1];
+  group->Member[k]= other;
+  other->MemberIndex= k;
+  group->Member[group->NIdle-1]= data;
+  data->MemberIndex= group->NIdle-1;
+  group->NIdle--;
+
+  UpdateOperatorState(data,state);
+}
+
+/* Return an explicit copy to the pool of its group */
+void DemoteOperator(data)
+SHEADATA *data;
+{
+  int k;
+  SHEADATA  *other;
+  OPERGROUP *group;
+  void UpdateOperatorState();
+
+  group= data->Group;
+
+  k=     data->MemberIndex;
+  other= group->Member[group->NIdle];
+  group->Member[k]= other;
+  other->MemberIndex= k;
+  group->Member[group->NIdle]= data;
+  data->MemberIndex= group->NIdle;
+  group->NIdle++;
+
+  group->Count[data->CurrentState]++;
+  UpdateOperatorState(data,data->CurrentState);
+}
+
+/* A sequence has picked up its first RNAP: its operators must be explicit */
+void SequenceActive(seq)
+SEQUENCE *seq;
+{
+  int i;
+  SHEADATA *data;
+  void PromoteOperator();
+
+  for(i=0; i<seq->Template->NPromotors; i++){
+    data= &Sim->Operator[seq->Promotor[i].Data];
+    if(OPERATOR_IDLE(data)) PromoteOperator(data,-1);
+  }
+}
+
+/* A sequence has lost its last RNAP: pool any operator that is now idle */
+void SequenceIdle(seq)
+SEQUENCE *seq;
+{
+  int i,j;
+  SHEADATA *data;
+  void DemoteOperator();
+
+  for(i=0; i<seq->Template->NPromotors; i++){
+    data= &Sim->Operator[seq->Promotor[i].Data];
+    if(OPERATOR_IDLE(data)) continue;
+
+    /* The operator may control promotors on other sequences too */
+    for(j=0; j<data->NPromotors; j++)
+      if(data->Promotors[j]->Segment->Seq->RNAPs.NRNAPs>0) break;
+
+    if(j==data->NPromotors) DemoteOperator(data);
+  }
+}
+
+/* 
+ * Give the idle copies definite states for output.  The copies
+ * are interchangeable, so the counts are simply dealt out.
+ */
+void SyncIdleOperatorStates()
+{
+  int i,c,m,n;
+  OPERGROUP *group;
+
+  for(i=0; i<Sim->NOperGroups; i++){
+    group= Sim->OperGroup[i];
+    if(group->NMembers==0) continue;
+    m=0;
+    for(c=0; c<group->Template->NConfigs; c++)
+      for(n=0; n<group->Count[c]; n++)
+	group->Member[m++]->CurrentState= c;
+  }
+}
+
+/*
+ * Initiation from the idle pool: one reaction per promotor of the
+ * group, with the rate summed over the configurations of the pool.
+ * No RNAP can be in the way, as the DNA of idle copies is clear.
+ */
+void SubmitIdleInitiations()
+{
+  int i,p,c;
+  double rate;
+  OPERGROUP *group;
+  PROMOTOR  *prom;
+  REACTION  *reaction;
+
+  void SubmitReaction();
+  void InitiateIdleTranscription();
+
+  for(i=0; i<Sim->NOperGroups; i++){
+    group= Sim->OperGroup[i];
+    if(group->NIdle==0) continue;
+
+    for(p=0; p<group->Template->NPromotors; p++){
+      prom= group->Template->Promotors[p];
+      rate= 0.0;
+      for(c=0; c<group->Template->NConfigs; c++)
+	if(group->Count[c]>0) rate += group->Count[c]*prom->T->IsoRate[c];
+      if(rate==0.0) continue;
+
+      reaction= (REACTION *)  AllocReaction();
+      reaction->Type=         Reaction_Type_TransInit;
+      reaction->ReactionData= (void *) &group->Init[p];
+      reaction->ReactionFunc= InitiateIdleTranscription;
+      reaction->Probability=  rate;
+
+      SubmitReaction(reaction);
+    }
+  }
+}
+
+void InitiateIdleTranscription(reactdata)
+void *reactdata;
+{
+  int c,last,nconfigs;
+  double r,w;
+  IDLEINIT  *init;
+  OPERGROUP *group;
+  PROMOTOR  *prom;
+  SHEADATA  *data;
+
+  void PromoteOperator();
+  void InitiateTranscription();
+
+  init=  (IDLEINIT *) reactdata;
+  group= init->Group;
+  prom=  group->Template->Promotors[init->Promotor];
+
+  /* Configuration of the copy that fired */
+  nconfigs= group->Template->NConfigs;
+  r= 0.0;
+  for(c=0; c<nconfigs; c++)
+    r += group->Count[c]*prom->T->IsoRate[c];
+  r *= RngUniform(Sim->Rng);
+
+  last= 0;
+  for(c=0; c<nconfigs; c++){
+    w= group->Count[c]*prom->T->IsoRate[c];
+    if(w<=0.0) continue;
+    last= c;
+    if(r<w) break;
+    r -= w;
+  }
+  if(c==nconfigs) c= last;
+
+  data= group->Member[group->NIdle-1];
+  PromoteOperator(data,c);
+
+  InitiateTranscription(data->Promotors[init->Promotor]->Segment);
 }
 
 /*****************************************
@@ -180,67 +580,53 @@ DNA *pfragment;
   REACTION *reaction;
   PROMOTOR *promotor;
   DNA      *dna;
-  int       type;
+  RNAPINDEX *index;
+  int       load,slot;
 
   void      SubmitReaction();
   char     *PrintDNAType();
   void      InitiateTranscription();
+  int       AbsolutePosition();
+  int       FindRNAPSlot();
 
-  if(pfragment->Type!= DNA_Type_Promotor){
-    fprintf(stderr,"%s: Promotor Action passed an incorrect Data Type %s named %s.\n",progid,PrintDNAType(pfragment->Type),pfragment->Name);
+  if(pfragment->T->Type!= DNA_Type_Promotor){
+    fprintf(stderr,"%s: Promotor Action passed an incorrect Data Type %s named %s.\n",progid,PrintDNAType(pfragment->T->Type),SegmentName(pfragment));
     exit(-1);
   }
 
-  promotor= (PROMOTOR *) pfragment->DNAStruct;
+  promotor= DNA_PROMOTOR(pfragment);
 
-  pstate= Operator[promotor->Data].CurrentState;
+  pstate= Sim->Operator[promotor->Data].CurrentState;
 
-  if(promotor->IsoRate[pstate]==0.0) return;
+  if(promotor->T->IsoRate[pstate]==0.0) return;
 
   /* Check here if there is a blocking RNAP ahead */
 
-  if(promotor->TranscriptionDirection == LEFT) dna= pfragment->LeftSegment;
-  else dna= pfragment->RightSegment;
+  if(promotor->T->TranscriptionDirection == LEFT) dna= LEFT_SEGMENT(pfragment);
+  else dna= RIGHT_SEGMENT(pfragment);
 
-  type= dna->Type;
-  
-  if(type != DNA_Type_Promotor){
-    SEGMENT *dstruct;
-    RNAP     *queue;
-    
-    dstruct= (SEGMENT *) dna->DNAStruct;
- 
-    queue= dstruct->RNAPQueue;
-    while(queue!=NULL){
+  /*
+   * Look up the polymerases within 17 nucleotides downstream of the
+   * point where new RNAPs are loaded, on whatever segment they are.
+   */
+  index= &dna->Seq->RNAPs;
+  load= AbsolutePosition(dna,(dna->T->Direction == promotor->T->TranscriptionDirection ? 0 : dna->T->Length+1));
 
-      if(queue->Direction == promotor->TranscriptionDirection &&
-	 queue->CurrentPosition<=17)
+  if(promotor->T->TranscriptionDirection == RIGHT){
+    for(slot= FindRNAPSlot(index,load); slot<index->NRNAPs && index->RNAP[slot]->AbsPosition<=load+17; slot++)
+      if(index->RNAP[slot]->Direction == RIGHT)
+	return;                        /* Reaction is Blocked */
+  } else {
+    for(slot= FindRNAPSlot(index,load-1)-1; slot>=0 && index->RNAP[slot]->AbsPosition>=load-17; slot--)
+      if(index->RNAP[slot]->Direction == LEFT)
 	return;                        /* Reaction is Blocked */
-
-      queue= queue->NextRNAP;
-    }
-  }else{
-    PROMOTOR *dstruct;
-    RNAP     *queue;
-
-    dstruct= (PROMOTOR *) dna->DNAStruct;
-
-    queue= dstruct->RNAPQueue;
-    while(queue!=NULL){
-
-      if(queue->Direction == promotor->TranscriptionDirection &&
-	 queue->CurrentPosition<=17)
-	return;                       /* Reaction is blocked */
-
-      queue= queue->NextRNAP;
-    }
   }
 
   reaction= (REACTION *)  AllocReaction();
   reaction->Type=         Reaction_Type_TransInit;
   reaction->ReactionData= (void *) pfragment;
   reaction->ReactionFunc= InitiateTranscription;
-  reaction->Probability=  promotor->IsoRate[pstate];
+  reaction->Probability=  promotor->T->IsoRate[pstate];
 
   SubmitReaction(reaction);
 }
@@ -264,113 +650,53 @@ void *reactdata;
   char *PrintDNAType();
   void  ChangePromotorState();
   void  SimpleRNAPMover();
+  void  InsertRNAP();
 
   /* First we recast the void reactdata into a recognizable form */
 
   pfragment= (DNA *) reactdata;
 
-  type= pfragment->Type;
+  type= pfragment->T->Type;
 
   if(type!= DNA_Type_Promotor){
     fprintf(stderr,"%s: InitiateTranscription() was passed bad reaction data (type= %s)\n",progid,PrintDNAType(type));
     exit(-1);
   }
 
-  promotor= (PROMOTOR *) pfragment->DNAStruct;
+  promotor= DNA_PROMOTOR(pfragment);
 #ifdef RMM_MODS
   /* Keep track of the number of RNA polymerases that have gone by */
   promotor->RNAPCount++;
 
   DEBUG(20) {
     fprintf(stderr, "Initiating transcription on %s, count = %d\n",
-	    promotor->Name, promotor->RNAPCount);
+	    SegmentName(pfragment), promotor->RNAPCount);
   }
 #endif
 
-  if(promotor->TranscriptionDirection == LEFT) dna= pfragment->LeftSegment;
-  else dna= pfragment->RightSegment;
+  if(promotor->T->TranscriptionDirection == LEFT) dna= LEFT_SEGMENT(pfragment);
+  else dna= RIGHT_SEGMENT(pfragment);
 
   
 
   DEBUG(20)
-    fprintf(stderr,"@@@@@ Transcription Initiation to gene %s\n", dna->Name);
+    fprintf(stderr,"@@@@@ Transcription Initiation to gene %s\n", SegmentName(dna));
 
-  type= dna->Type;
-  
-  if(type != DNA_Type_Promotor){
-    SEGMENT *dstruct;
-
-    dstruct= (SEGMENT *) dna->DNAStruct;
-
-    if(dstruct->RNAPQueue!=NULL){
-      tmprnap=(RNAP *) AllocRNAP();
-      dstruct->RNAPQueue->LastRNAP= tmprnap;
-      tmprnap->NextRNAP= dstruct->RNAPQueue;
-      tmprnap->LastRNAP= NULL;
-      tmprnap->Direction=promotor->TranscriptionDirection;
-      dstruct->RNAPQueue=tmprnap;
-  
-      if(dna->Direction == tmprnap->Direction)    /* Make Sure RNAP is at correct end of segment */
-	dstruct->RNAPQueue->CurrentPosition=0;
-      else
-	dstruct->RNAPQueue->CurrentPosition=dna->Length+1; /* This will be decremented by SimpleRNAPMover */
-      
-      /*** Note that Transcript will be inititiated by SimpleRNAPMover() */
-      dstruct->RNAPQueue->Transcript= NULL;      
-      
-      dstruct->RNAPQueue->NBound=0;
-      dstruct->RNAPQueue->SpeciesIndex=NULL;
-      ChangePromotorState(promotor);  
-    }else {
-      tmprnap=dstruct->RNAPQueue= (RNAP *) AllocRNAP();
-      dstruct->RNAPQueue->LastRNAP= NULL;
-      dstruct->RNAPQueue->NextRNAP= NULL;
-      dstruct->RNAPQueue->Direction= promotor->TranscriptionDirection;
-      if(dna->Direction==dstruct->RNAPQueue->Direction)
-	dstruct->RNAPQueue->CurrentPosition=0;
-      else 
-	dstruct->RNAPQueue->CurrentPosition=dna->Length+1;
-      /*** Note that Transcript will be inititiated by SimpleRNAPMover() */
-      dstruct->RNAPQueue->Transcript= NULL;
-      dstruct->RNAPQueue->NBound=0;
-      dstruct->RNAPQueue->SpeciesIndex=NULL;
-      ChangePromotorState(promotor);
-    }
-  }else{
-    PROMOTOR *dstruct;
-
-    dstruct= (PROMOTOR *) dna->DNAStruct;
-    if(dstruct->RNAPQueue!=NULL){
-      tmprnap=(RNAP *) AllocRNAP();
-      dstruct->RNAPQueue->LastRNAP= tmprnap;
-      tmprnap->NextRNAP= dstruct->RNAPQueue;
-      tmprnap->LastRNAP= NULL;
-      tmprnap->Direction=promotor->TranscriptionDirection;
-      dstruct->RNAPQueue=tmprnap;
-      if(dna->Direction==dstruct->RNAPQueue->Direction)
-	dstruct->RNAPQueue->CurrentPosition=0;
-      else 
-	dstruct->RNAPQueue->CurrentPosition=dna->Length+1;
-      dstruct->RNAPQueue->Transcript= NULL;
-      dstruct->RNAPQueue->NBound=0;
-      dstruct->RNAPQueue->SpeciesIndex=NULL;
-      ChangePromotorState(promotor);
-    }else {
-      tmprnap=dstruct->RNAPQueue= (RNAP *) AllocRNAP();
-      dstruct->RNAPQueue->LastRNAP= NULL;
-      dstruct->RNAPQueue->NextRNAP= NULL;
-      dstruct->RNAPQueue->Direction= promotor->TranscriptionDirection;  
-      if(dna->Direction==dstruct->RNAPQueue->Direction)
-	dstruct->RNAPQueue->CurrentPosition=0;
-      else 
-	dstruct->RNAPQueue->CurrentPosition=dna->Length+1;
-      dstruct->RNAPQueue->Transcript= NULL;
-      dstruct->RNAPQueue->NBound=0;
-      dstruct->RNAPQueue->SpeciesIndex=NULL;
-      ChangePromotorState(promotor);
-    }
-  }  
-  
+  tmprnap= (RNAP *) AllocRNAP();
+  tmprnap->Direction= promotor->T->TranscriptionDirection;
+
+  if(dna->T->Direction == tmprnap->Direction)    /* Make Sure RNAP is at correct end of segment */
+    tmprnap->CurrentPosition=0;
+  else
+    tmprnap->CurrentPosition=dna->T->Length+1; /* This will be decremented by SimpleRNAPMover */
+
+  /*** Note that Transcript will be inititiated by SimpleRNAPMover() */
+  tmprnap->Transcript= NULL;
+  tmprnap->NBound=0;
+  tmprnap->SpeciesIndex=NULL;
+
+  InsertRNAP(dna,tmprnap);
+  ChangePromotorState(promotor);
 
 rdata.rnap1=tmprnap;
 rdata.dna=dna;
@@ -383,6 +709,7 @@ PROMOTOR *promotor;
 {
   int ns,nc,cs,i,j,k,spec,cnt,nspec,splist[20],ctlist[20];
   int **clist;
+  void UpdateOperatorState();
 
   /* 
    * 
@@ -396,9 +723,9 @@ PROMOTOR *promotor;
    *
    */
 
-  nc   = Operator[promotor->Data].NConfigs;
-  cs   = Operator[promotor->Data].CurrentState;
-  clist= Operator[promotor->Data].CList;
+  nc   = Sim->Operator[promotor->Data].NConfigs;
+  cs   = Sim->Operator[promotor->Data].CurrentState;
+  clist= Sim->Operator[promotor->Data].CList;
   
   nspec=0;
   for(i=0; i<clist[cs][0]; i++){
@@ -431,7 +758,7 @@ PROMOTOR *promotor;
     fprintf(stderr,"@@@@ No Matching Configuration!");
     exit(-1);
   }
-  Operator[promotor->Data].CurrentState= i;
+  UpdateOperatorState(&Sim->Operator[promotor->Data],i);
 } 
     
 
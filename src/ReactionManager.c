@@ -34,6 +34,10 @@
  #include "Memory.h"
 #endif
 
+#ifndef RANDOM
+ #include "Rng.h"
+#endif
+
 /****************************/
 /** Reaction Queue Manager **/
 /****************************/
@@ -50,19 +54,26 @@ REACTION *reaction;
     return;
   }
 
-  if(NReactions==0){
-    Reaction=reaction;
+  if(Sim->NReactions==0){
+    Sim->Reaction=reaction;
     reaction->LastReaction=NULL;
     reaction->NextReaction=NULL;
   } else {
-    reaction->NextReaction=Reaction;
-    Reaction->LastReaction=reaction;
-    Reaction=reaction;
-    Reaction->LastReaction=NULL;
+    reaction->NextReaction=Sim->Reaction;
+    Sim->Reaction->LastReaction=reaction;
+    Sim->Reaction=reaction;
+    Sim->Reaction->LastReaction=NULL;
+  }
+
+  if(reaction->VolumeOrder<MIN_VOLUME_ORDER || reaction->VolumeOrder>MAX_VOLUME_ORDER){
+    fprintf(stderr,"%s: SubmitReaction() given reaction of volume order %d\n",
+	    progid,reaction->VolumeOrder);
+    exit(-1);
   }
+  Sim->OrderProbability[reaction->VolumeOrder-MIN_VOLUME_ORDER] += reaction->Probability;
 
-  TotalProbability += reaction->Probability;
-  NReactions++;
+  Sim->TotalProbability += reaction->Probability;
+  Sim->NReactions++;
 }
 
 /**********************
@@ -71,27 +82,28 @@ REACTION *reaction;
  *
  ***********************/
 
-#define TINY 1e-16
-
 REACTION *SelectReaction(tau)
 double *tau;
 {
-  double r1,r2,sum;
+  double r2,sum;
   REACTION *reaction, *lastreaction;
+  REACTION *SelectGrowingReaction();
+
+  if(Sim->EColi->Continuous && Sim->EColi->GrowthRate>0.0)
+    return(SelectGrowingReaction(tau));
   
-  r1= drand48();
-  r2= drand48()*TotalProbability;
+  r2= RngUniform(Sim->Rng)*Sim->TotalProbability;
 
-  *tau= (double) (r1 > TINY ? -log(r1) : -log(TINY))/TotalProbability;
+  *tau= RngExponential(Sim->Rng)/Sim->TotalProbability;
   
-  lastreaction=reaction= Reaction;
+  lastreaction=reaction= Sim->Reaction;
   sum= reaction->Probability;
 
   while(sum<r2){
     reaction     = reaction->NextReaction;
 
     if(reaction==NULL){
-      if((TotalProbability-sum)<1e-6) {break;}
+      if((Sim->TotalProbability-sum)<1e-6) {break;}
       fprintf(stderr,"%s: SelectReaction() found inconsistent reaction probabilities. Premature end.\n",
 	      progid);
       exit(-1);
@@ -99,9 +111,9 @@ double *tau;
 
     sum += reaction->Probability;
 
-    if((sum-TotalProbability)>1e-5){
+    if((sum-Sim->TotalProbability)>1e-5){
       fprintf(stderr,"%s: SelectReaction() found inconsistent reaction probabilities (%e, %e). Too Much.\n",
-	      progid,sum,TotalProbability);
+	      progid,sum,Sim->TotalProbability);
       exit(-1);
     }
     lastreaction = reaction;
@@ -110,7 +122,110 @@ double *tau;
   return(lastreaction);
 }
 
-#undef TINY 
+/**********************
+ *
+ * Step 2 for a continuously growing cell
+ *
+ * Between divisions V(t)= V+g*t grows linearly, so a reaction of
+ * volume order k has propensity a*(V/(V+g*t))^k.  The firing time
+ * solves the integrated hazard H(tau) = E exactly, for E a standard
+ * exponential deviate, and the reaction is chosen from the
+ * propensities at that time.  If the cell reaches twice its initial
+ * volume first, NULL is returned and tau is the time to division.
+ *
+ ***********************/
+
+#define MAXITER 100
+
+/* Integral over [0,tau] of (V/(V+g*t))^k, with x= g*tau/V */
+static double VolumeIntegral(k,x,vg)
+int k;
+double x,vg;
+{
+  if(k==0) return(x*vg);
+  if(k==1) return(vg*log1p(x));
+  return(vg*expm1((1-k)*log1p(x))/(1-k));
+}
+
+REACTION *SelectGrowingReaction(tau)
+double *tau;
+{
+  double r2,sum,target,g,vg,tdiv,x,h,dh,lo,hi,t,total;
+  double weight[NVOLUMEORDERS];
+  int k,iter;
+  REACTION *reaction, *lastreaction;
+
+  target= RngExponential(Sim->Rng);
+  r2=     RngUniform(Sim->Rng);
+
+  g=    Sim->EColi->GrowthRate*1e-18;
+  vg=   Sim->EColi->V/g;
+  tdiv= (2.0*Sim->EColi->VI-Sim->EColi->V)/g;
+  if(tdiv<=0.0){
+    *tau= 0.0;
+    return(NULL);
+  }
+
+  /* Does the cell divide before anything happens? */
+  h= 0.0;
+  for(k=MIN_VOLUME_ORDER; k<=MAX_VOLUME_ORDER; k++)
+    if(Sim->OrderProbability[k-MIN_VOLUME_ORDER]>0.0)
+      h += Sim->OrderProbability[k-MIN_VOLUME_ORDER]*VolumeIntegral(k,tdiv/vg,vg);
+  if(h<=target){
+    *tau= tdiv;
+    return(NULL);
+  }
+
+  /* Safeguarded Newton iteration for H(t)=target on [0,tdiv] */
+  lo= 0.0;
+  hi= tdiv;
+  t=  target/Sim->TotalProbability;
+  if(t>=hi) t= 0.5*(lo+hi);
+  for(iter=0; iter<MAXITER; iter++){
+    x=  t/vg;
+    h=  -target;
+    dh= 0.0;
+    for(k=MIN_VOLUME_ORDER; k<=MAX_VOLUME_ORDER; k++)
+      if(Sim->OrderProbability[k-MIN_VOLUME_ORDER]>0.0){
+	h  += Sim->OrderProbability[k-MIN_VOLUME_ORDER]*VolumeIntegral(k,x,vg);
+	dh += Sim->OrderProbability[k-MIN_VOLUME_ORDER]*pow(1.0+x,(double) -k);
+      }
+    if(h>0.0) hi= t; else lo= t;
+    if(fabs(h)<=1e-12*target || (hi-lo)<=1e-15*hi) break;
+    t -= h/dh;
+    if(t<=lo || t>=hi) t= 0.5*(lo+hi);
+  }
+  *tau= t;
+
+  /* Choose the reaction from the propensities at the firing time */
+  total= 0.0;
+  for(k=MIN_VOLUME_ORDER; k<=MAX_VOLUME_ORDER; k++){
+    weight[k-MIN_VOLUME_ORDER]= pow(1.0+t/vg,(double) -k);
+    total += Sim->OrderProbability[k-MIN_VOLUME_ORDER]*weight[k-MIN_VOLUME_ORDER];
+  }
+  r2 *= total;
+
+  lastreaction=reaction= Sim->Reaction;
+  sum= reaction->Probability*weight[reaction->VolumeOrder-MIN_VOLUME_ORDER];
+
+  while(sum<r2){
+    reaction= reaction->NextReaction;
+
+    if(reaction==NULL){
+      if((total-sum)<1e-6) {break;}
+      fprintf(stderr,"%s: SelectGrowingReaction() found inconsistent reaction probabilities. Premature end.\n",
+	      progid);
+      exit(-1);
+    }
+
+    sum += reaction->Probability*weight[reaction->VolumeOrder-MIN_VOLUME_ORDER];
+    lastreaction = reaction;
+  }
+
+  return(lastreaction);
+}
+
+#undef MAXITER
 
 void ExecuteReaction(reaction)
 REACTION *reaction;
@@ -122,20 +237,22 @@ REACTION *reaction;
 
 void FreeReactionQueue()
 {
+  int i;
   REACTION *rptr;
   void FreeReactionData();
 
-  TotalProbability= 0.0;
+  Sim->TotalProbability= 0.0;
+  for(i=0; i<NVOLUMEORDERS; i++) Sim->OrderProbability[i]= 0.0;
 
-  while(Reaction!=NULL){
-    rptr= Reaction->NextReaction;
-    if(Reaction->ReactionData!=NULL)
-      FreeReactionData(Reaction->Type,Reaction->ReactionData);
-    FreeReaction(Reaction);
-    Reaction=rptr;
+  while(Sim->Reaction!=NULL){
+    rptr= Sim->Reaction->NextReaction;
+    if(Sim->Reaction->ReactionData!=NULL)
+      FreeReactionData(Sim->Reaction->Type,Sim->Reaction->ReactionData);
+    FreeReaction(Sim->Reaction);
+    Sim->Reaction=rptr;
   }
 
-  NReactions=0;
+  Sim->NReactions=0;
 
 }
 
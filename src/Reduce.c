@@ -0,0 +1,659 @@
+/*******************
+ *
+ * simulac-reduce - the statistics of a directory of outputs of Simulac
+ *
+ * usage: simulac-reduce [-t threads] [-o name] [-r regexp] [-q quantiles]
+ *                       [-b bins] [-c file] directory
+ *
+ * Reads the files of directory whose names match regexp (\.dat$) and
+ * writes the statistics of their columns, time by time, to name.STAT
+ * (directory.STAT, or reduce.STAT for . and ..), as an ensemble run
+ * with --stats would have: the
+ * mean, variance, least and greatest value, quantiles (0.05,0.5,0.95)
+ * and histograms of bins bins (none), with the number of runs at each
+ * time (see Summary.c).  The row of a fate decided by a stop condition
+ * between printed times is left out, as --stats leaves it out.  Files
+ * with a number of columns other than the first's are passed over.
+ *
+ * With -c the runs are also written to file in binary, a column at a
+ * time (see WriteColumns()), to be mapped into memory rather than
+ * parsed again; simulac.py's readColumns() reads it.
+ *
+ * The files are mapped into memory and their numbers read by hand: a
+ * number of at most 15 digits and an exponent of at most 22 is exactly
+ * a whole number times or over an exact power of ten, which is one
+ * rounding, as strtod() would round it.  Others are left to strtod().
+ * The files are handed out in the natural order of their names (run.2
+ * before run.10) to threads (one per processor) and added to the
+ * statistics in that order, so the statistics are the same however
+ * many threads read them.  A thread reads no further than AHEAD runs
+ * a thread past the first run not yet joined, so that a large or slow
+ * file doesn't leave the rows of all the files after it in memory.  They are those --stats took of the
+ * trajectories output.0, output.1, ... of an ensemble to the digits
+ * the outputs print (all of them, for the counts).
+ *
+ ******************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <regex.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef SUMMARY
+ #include "Summary.h"
+#endif
+
+#define NAMEBYTES    32     /* Of a column name in the columns file */
+#define MAXNUMBER    64     /* Longest number left to strtod() */
+
+typedef struct run RUN;
+
+struct run {
+  char   *Name;
+  double *Value;            /* Row by row */
+  int     NRows,Max;
+  short   Fated;            /* Its last row is the decision of a fate */
+  short   Bad;              /* It isn't read, or is passed over */
+  short   Done;
+};
+
+char progid[80];
+
+static char   *Dir;
+static RUN    *Run;
+static int     NRuns;
+static int     NCols;
+static char   *Header=NULL;       /* The column headings of the first file */
+
+#define AHEAD  8                  /* Runs a thread, past the first not joined */
+
+static pthread_mutex_t Lock=PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t Moved=PTHREAD_COND_INITIALIZER;   /* NJoined did */
+static int     Next=0;            /* Runs [Next,NRuns) are to be read */
+static int     NJoined=0;         /* Runs 0..NJoined-1 are in the statistics */
+static int     Window;            /* Runs are read below NJoined+Window */
+
+static int     ColumnsFd= -1;     /* With -c */
+static off_t   ColumnsEnd;
+static uint64_t *RowIndex;
+
+/* The memory is handled by Util.c, whose random numbers want a context */
+__thread SIMCONTEXT *Sim=NULL;
+
+/****************************/
+/******* Reading ************/
+/****************************/
+
+/* Order of names, with runs of digits by their value */
+static int NaturalOrder(a,b)
+const void *a,*b;
+{
+  const char *p,*q;
+  size_t m,n;
+  int c;
+
+  p= *(char * const *) a;
+  q= *(char * const *) b;
+  while(*p!='\0' && *q!='\0'){
+    if(isdigit((unsigned char) *p) && isdigit((unsigned char) *q)){
+      while(*p=='0') p++;
+      while(*q=='0') q++;
+      for(m=0; isdigit((unsigned char) p[m]); m++);
+      for(n=0; isdigit((unsigned char) q[n]); n++);
+      if(m!=n) return(m<n ? -1 : 1);
+      if((c=strncmp(p,q,m))!=0) return(c);
+      p += m;
+      q += n;
+    }
+    else if(*p!=*q)
+      return((unsigned char) *p-(unsigned char) *q);
+    else {
+      p++;
+      q++;
+    }
+  }
+  return((unsigned char) *p-(unsigned char) *q);
+}
+
+/* The files of Dir whose names match regexp, in their natural order */
+static void ListRuns(regexp)
+char *regexp;
+{
+  int i,max;
+  char **name;
+  DIR *dir;
+  struct dirent *entry;
+  regex_t re;
+
+  if(regcomp(&re,regexp,REG_EXTENDED|REG_NOSUB)!=0){
+    fprintf(stderr,"%s: bad regular expression '%s'\n",progid,regexp);
+    exit(1);
+  }
+  if((dir=opendir(Dir))==NULL){
+    perror(Dir);
+    exit(1);
+  }
+
+  max= 64;
+  name= (char **) rcalloc(max,sizeof(char *),"ListRuns");
+  NRuns= 0;
+  while((entry=readdir(dir))!=NULL){
+    if(regexec(&re,entry->d_name,0,NULL,0)!=0) continue;
+    if(NRuns==max){
+      max *= 2;
+      name= (char **) rrealloc(name,max,sizeof(char *),"ListRuns");
+    }
+    name[NRuns]= (char *) rcalloc(strlen(entry->d_name)+1,sizeof(char),"ListRuns");
+    strcpy(name[NRuns++],entry->d_name);
+  }
+  closedir(dir);
+  regfree(&re);
+
+  qsort(name,NRuns,sizeof(char *),NaturalOrder);
+  Run= (RUN *) rcalloc(NRuns+1,sizeof(RUN),"ListRuns");
+  for(i=0; i<NRuns; i++)
+    Run[i].Name= name[i];
+  free(name);
+}
+
+/* Map the file of run into memory; its size in *size, NULL if empty */
+static char *MapRun(run,size)
+RUN *run;
+size_t *size;
+{
+  int fd;
+  char *path,*data;
+  struct stat st;
+
+  path= (char *) rcalloc(strlen(Dir)+strlen(run->Name)+2,sizeof(char),"MapRun");
+  sprintf(path,"%s/%s",Dir,run->Name);
+  if((fd=open(path,O_RDONLY))<0 || fstat(fd,&st)<0){
+    perror(path);
+    exit(1);
+  }
+  *size= (size_t) st.st_size;
+  data= NULL;
+  if(*size>0 &&
+     (data=(char *) mmap(NULL,*size,PROT_READ,MAP_PRIVATE,fd,0))==MAP_FAILED){
+    perror(path);
+    exit(1);
+  }
+  close(fd);
+  free(path);
+  return(data);
+}
+
+static const double Power10[]= {
+  1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+  1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22
+};
+
+/*
+ * Read the number at p, before end, into *x; the character after it,
+ * or NULL if there is none to read
+ */
+static char *ReadNumber(p,end,x)
+char *p,*end;
+double *x;
+{
+  int digits,scale,e,esign,neg;
+  uint64_t m;
+  char *start,*first,buf[MAXNUMBER];
+
+  start= p;
+  neg= 0;
+  if(p<end && (*p=='-' || *p=='+')) neg= (*p++=='-');
+  first= p;
+
+  /* The digits, to 19 of them; the point shifts them */
+  m= 0;
+  digits= scale= 0;
+  for(; p<end && isdigit((unsigned char) *p); p++)
+    if(digits<19){
+      m= 10*m+(*p-'0');
+      if(m>0) digits++;
+    }
+    else scale++;
+  if(p<end && *p=='.')
+    for(p++; p<end && isdigit((unsigned char) *p); p++)
+      if(digits<19){
+	m= 10*m+(*p-'0');
+	if(m>0) digits++;
+	scale--;
+      }
+  if(p==first || (p==first+1 && *first=='.')) goto slow;
+
+  if(p<end && (*p=='e' || *p=='E')){
+    p++;
+    esign= 1;
+    if(p<end && (*p=='-' || *p=='+')) esign= (*p++=='-' ? -1 : 1);
+    if(p==end || !isdigit((unsigned char) *p)) goto slow;
+    for(e=0; p<end && isdigit((unsigned char) *p); p++)
+      if(e<10000) e= 10*e+(*p-'0');
+    scale += esign*e;
+  }
+  if(p<end && !isspace((unsigned char) *p)) goto slow;
+
+  if(digits<=15 && scale>=-22 && scale<=22){
+    *x= (scale<0 ? (double) m/Power10[-scale] : (double) m*Power10[scale]);
+    if(neg) *x= -*x;
+    return(p);
+  }
+
+ slow:
+  for(p=start; p<end && !isspace((unsigned char) *p); p++);
+  if(p-start>=MAXNUMBER || p==start) return(NULL);
+  memcpy(buf,start,p-start);
+  buf[p-start]= '\0';
+  *x= strtod(buf,&start);
+  return(*start=='\0' ? p : NULL);
+}
+
+/*
+ * Read the line at p, before end, into x[] (if not NULL), up to max
+ * numbers; the numbers on it, -1 if one can't be read, and the start
+ * of the next line in *next
+ */
+static int ReadLine(p,end,x,max,next)
+char *p,*end;
+double *x;
+int max;
+char **next;
+{
+  int n;
+  double y;
+
+  for(n=0; ; n++){
+    while(p<end && (*p==' ' || *p=='\t' || *p=='\r')) p++;
+    if(p==end || *p=='\n') break;
+    if((p=ReadNumber(p,end,(x!=NULL && n<max ? &x[n] : &y)))==NULL){
+      n= -1;
+      break;
+    }
+  }
+  while(p<end && *p!='\n') p++;
+  *next= (p<end ? p+1 : p);
+  return(n);
+}
+
+/*
+ * Take the columns of the output, which of them are whole numbers and
+ * their headings from the first file that has a row
+ */
+static char *FirstRun(whole)
+char **whole;
+{
+  int i,c;
+  size_t size;
+  char *data,*p,*end,*next,*comment;
+
+  *whole= NULL;
+  for(i=0; i<NRuns && *whole==NULL; i++){
+    if((data=MapRun(&Run[i],&size))==NULL) continue;
+    end= data+size;
+    comment= NULL;
+    for(p=data; p<end; p=next){
+      if(*p=='%'){
+	if(comment==NULL) comment= p;
+	for(next=p; next<end && *next!='\n'; next++);
+	if(next<end) next++;
+	continue;
+      }
+      if((NCols=ReadLine(p,end,NULL,0,&next))<=0) continue;
+
+      /* A count is printed without a point or an exponent */
+      *whole= (char *) rcalloc(NCols+1,sizeof(char),"FirstRun");
+      for(c=0; c<NCols; c++){
+	while(*p==' ' || *p=='\t') p++;
+	for((*whole)[c]=1; p<end && !isspace((unsigned char) *p); p++)
+	  if(!isdigit((unsigned char) *p) && *p!='-' && *p!='+') (*whole)[c]= 0;
+      }
+      if(comment!=NULL){
+	for(p=comment; p<end && *p!='\n'; p++);
+	Header= (char *) rcalloc(p-comment+1,sizeof(char),"FirstRun");
+	memcpy(Header,comment,p-comment);
+      }
+      break;
+    }
+    munmap(data,size);
+  }
+  return(*whole);
+}
+
+/* Read the rows of run */
+static void ReadRun(run)
+RUN *run;
+{
+  int n;
+  size_t size;
+  char *data,*p,*end,*next;
+
+  if((data=MapRun(run,&size))==NULL){
+    run->Bad= 1;
+    return;
+  }
+  end= data+size;
+  for(p=data; p<end; p=next){
+    if(*p=='%'){
+      if(end-p>=6 && strncmp(p,"% fate",6)==0) run->Fated= 1;
+      for(next=p; next<end && *next!='\n'; next++);
+      if(next<end) next++;
+      continue;
+    }
+    if(run->NRows==run->Max){
+      run->Max= 2*run->Max+64;
+      run->Value= (double *) rrealloc(run->Value,(size_t) run->Max*NCols,sizeof(double),"ReadRun");
+    }
+    n= ReadLine(p,end,run->Value+(size_t) run->NRows*NCols,NCols,&next);
+    if(n==0) continue;
+    if(n!=NCols){
+      fprintf(stderr,"%s: %s: %s; skipping file\n",progid,run->Name,
+	      (n<0 ? "bad number" : "variable count mismatch"));
+      run->Bad= 1;
+      break;
+    }
+    run->NRows++;
+  }
+  munmap(data,size);
+  if(run->Bad) run->NRows= 0;
+}
+
+/****************************/
+/******* Writing ************/
+/****************************/
+
+static void PutU32(p,v)
+unsigned char *p;
+uint32_t v;
+{
+  p[0]= v; p[1]= v>>8; p[2]= v>>16; p[3]= v>>24;
+}
+
+static void PutU64(p,v)
+unsigned char *p;
+uint64_t v;
+{
+  PutU32(p,(uint32_t) v);
+  PutU32(p+4,(uint32_t) (v>>32));
+}
+
+static void WriteAt(p,n,offset)
+unsigned char *p;
+size_t n;
+off_t offset;
+{
+  ssize_t k;
+
+  for(; n>0; p+=k, n-=k, offset+=k)
+    if((k=pwrite(ColumnsFd,p,n,offset))<=0){
+      perror("simulac-reduce: columns file");
+      exit(1);
+    }
+}
+
+/*
+ * The columns file, all little-endian:
+ *
+ *   "SIMCOLS1"
+ *   u32 columns, u32 runs
+ *   the name of each column, NAMEBYTES bytes padded with NULs
+ *   u64 the row each run starts at, and the rows of them all
+ *   each run in turn, its rows of each column in turn, as doubles
+ *
+ * so that a run that starts at row r of n rows is columns*n doubles
+ * at 8*columns*r past the rows, a column of n at a time.  The runs are
+ * in the natural order of the files, and those passed over have no
+ * rows.  Open file and write all but the row each run starts at.
+ */
+static void StartColumns(file)
+char *file;
+{
+  int c;
+  size_t n;
+  char *name,*copy,*last;
+  unsigned char *head;
+
+  if((ColumnsFd=open(file,O_WRONLY|O_CREAT|O_TRUNC,0666))<0){
+    perror(file);
+    exit(1);
+  }
+  n= 16+(size_t) NAMEBYTES*NCols;
+  head= (unsigned char *) rcalloc(n,sizeof(unsigned char),"StartColumns");
+  memcpy(head,"SIMCOLS1",8);
+  PutU32(head+8,(uint32_t) NCols);
+  PutU32(head+12,(uint32_t) NRuns);
+
+  /* Names from the headings, if they are all there */
+  copy= NULL;
+  if(Header!=NULL){
+    copy= (char *) rcalloc(strlen(Header)+1,sizeof(char),"StartColumns");
+    strcpy(copy,Header+1);
+    for(c=0, name=strtok_r(copy," \t",&last); name!=NULL; name=strtok_r(NULL," \t",&last)) c++;
+    if(c!=NCols){
+      free(copy);
+      copy= NULL;
+    }
+    else
+      strcpy(copy,Header+1);
+  }
+  for(c=0, name=(copy!=NULL ? strtok_r(copy," \t",&last) : NULL); c<NCols; c++){
+    if(name!=NULL){
+      strncpy((char *) head+16+NAMEBYTES*c,name,NAMEBYTES-1);
+      name= strtok_r(NULL," \t",&last);
+    }
+    else
+      sprintf((char *) head+16+NAMEBYTES*c,"column%d",c);
+  }
+  free(copy);
+
+  WriteAt(head,n,(off_t) 0);
+  free(head);
+  RowIndex= (uint64_t *) rcalloc(NRuns+1,sizeof(uint64_t),"StartColumns");
+  ColumnsEnd= (off_t) (n+8*((size_t) NRuns+1));
+}
+
+/* Write run k, the next, to the columns file */
+static void WriteColumns(k)
+int k;
+{
+  int i,c;
+  size_t n;
+  unsigned char *buf,*p;
+  uint64_t u;
+  RUN *run;
+
+  run= &Run[k];
+  RowIndex[k+1]= RowIndex[k]+run->NRows;
+  n= (size_t) 8*NCols*run->NRows;
+  if(n==0) return;
+
+  buf= (unsigned char *) rcalloc(n,sizeof(unsigned char),"WriteColumns");
+  p= buf;
+  for(c=0; c<NCols; c++)
+    for(i=0; i<run->NRows; i++, p+=8){
+      memcpy(&u,&run->Value[(size_t) i*NCols+c],8);
+      PutU64(p,u);
+    }
+  WriteAt(buf,n,ColumnsEnd);
+  ColumnsEnd += n;
+  free(buf);
+}
+
+/* Write the row each run starts at, and close the columns file */
+static void EndColumns()
+{
+  int k;
+  unsigned char *buf;
+
+  buf= (unsigned char *) rcalloc(NRuns+1,8,"EndColumns");
+  for(k=0; k<=NRuns; k++)
+    PutU64(buf+8*k,RowIndex[k]);
+  WriteAt(buf,(size_t) 8*(NRuns+1),(off_t) (16+NAMEBYTES*NCols));
+  free(buf);
+  free(RowIndex);
+  if(close(ColumnsFd)!=0){
+    perror("simulac-reduce: columns file");
+    exit(1);
+  }
+}
+
+/****************************/
+/******* Reducing ***********/
+/****************************/
+
+/* Add run k, the next, to the statistics */
+static void JoinRun(k)
+int k;
+{
+  int i,n;
+  RUN *run;
+
+  run= &Run[k];
+  if(ColumnsFd>=0) WriteColumns(k);
+
+  /* The row at which a stop condition decided the fate is left out */
+  n= run->NRows;
+  if(run->Fated && n>0) n--;
+  for(i=0; i<n; i++)
+    AddSummaryRow(i,run->Value+(size_t) i*NCols);
+
+  free(run->Value);
+  run->Value= NULL;
+}
+
+/*
+ * Read runs in order and join them, in order, until all are read.
+ * Run NJoined is always being read, so the waits end.
+ */
+static void *ReduceWorker(arg)
+void *arg;
+{
+  int k;
+
+  for(;;){
+    pthread_mutex_lock(&Lock);
+    while(Next<NRuns && Next>=NJoined+Window)
+      pthread_cond_wait(&Moved,&Lock);
+    k= (Next<NRuns ? Next++ : -1);
+    pthread_mutex_unlock(&Lock);
+    if(k<0) return(NULL);
+
+    ReadRun(&Run[k]);
+
+    pthread_mutex_lock(&Lock);
+    Run[k].Done= 1;
+    while(NJoined<NRuns && Run[NJoined].Done)
+      JoinRun(NJoined++);
+    pthread_cond_broadcast(&Moved);
+    pthread_mutex_unlock(&Lock);
+  }
+}
+
+static void PrintHeader(fp)
+FILE *fp;
+{
+  fprintf(fp,"%s\n",Header);
+}
+
+static void Usage()
+{
+  fprintf(stderr,"usage: %s [-t threads] [-o name] [-r regexp] [-q quantiles]\n"
+	  "       %*s [-b bins] [-c file] directory\n",progid,(int) strlen(progid),"");
+  exit(1);
+}
+
+int main(argc,argv)
+int argc;
+char **argv;
+{
+  int i,opt,threads,bins,n,bad;
+  char *name,*regexp,*quantiles,*columns,*whole;
+  pthread_t *thread;
+
+  strncpy(progid,argv[0],sizeof(progid)-1);
+  threads= 0;
+  bins= 0;
+  name= columns= NULL;
+  regexp= "\\.dat$";
+  quantiles= "0.05,0.5,0.95";
+  while((opt=getopt(argc,argv,"t:o:r:q:b:c:"))!=-1)
+    switch(opt){
+    case 't': threads= atoi(optarg);  break;
+    case 'o': name= optarg;  break;
+    case 'r': regexp= optarg;  break;
+    case 'q': quantiles= optarg;  break;
+    case 'b': bins= atoi(optarg);  break;
+    case 'c': columns= optarg;  break;
+    default:  Usage();
+    }
+  if(optind!=argc-1) Usage();
+
+  Dir= argv[optind];
+  for(i=strlen(Dir); i>1 && Dir[i-1]=='/'; i--) Dir[i-1]= '\0';
+  if(name==NULL)
+    name= (strcmp(Dir,".")==0 || strcmp(Dir,"..")==0 ||
+	   (i>2 && strcmp(Dir+i-2,"/.")==0) || (i>3 && strcmp(Dir+i-3,"/..")==0) ?
+	   "reduce" : Dir);
+
+  ListRuns(regexp);
+  if(FirstRun(&whole)==NULL){
+    fprintf(stderr,"%s: no rows in the files of %s matching '%s'\n",progid,Dir,regexp);
+    exit(1);
+  }
+  SetupSummary(NCols,whole,quantiles,bins);
+  free(whole);
+  if(columns!=NULL) StartColumns(columns);
+
+  if(threads<=0) threads= (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if(threads<1)  threads= 1;
+  if(threads>NRuns) threads= NRuns;
+  Window= AHEAD*threads;
+  thread= (pthread_t *) rcalloc(threads,sizeof(pthread_t),"main");
+  for(i=0; i<threads; i++)
+    if(pthread_create(&thread[i],NULL,ReduceWorker,NULL)!=0){
+      fprintf(stderr,"%s: can't start thread %d\n",progid,i);
+      exit(-1);
+    }
+  for(i=0; i<threads; i++)
+    pthread_join(thread[i],NULL);
+  free(thread);
+
+  if(columns!=NULL) EndColumns();
+  n= WriteSummary(name,(Header!=NULL ? PrintHeader : NULL));
+
+  for(i=bad=0; i<NRuns; i++){
+    bad += Run[i].Bad;
+    free(Run[i].Name);
+  }
+  fprintf(stderr,"%s: %d runs of %d columns from %s",progid,n,NCols,Dir);
+  if(bad>0) fprintf(stderr,"; %d passed over",bad);
+  fprintf(stderr,"\n");
+  free(Run);
+  free(Header);
+  return(0);
+}
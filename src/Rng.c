@@ -0,0 +1,259 @@
+/*******************
+ *
+ * Counter-based random number streams (see Rng.h)
+ *
+ ******************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_MATH
+   #include <math.h>
+#endif
+
+#ifndef RANDOM
+ #include "Rng.h"
+#endif
+
+static int ZigReady=0;
+static void ZigguratSetup();
+
+/****************************/
+/******* Philox4x32-10 ******/
+/****************************/
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define LANES     8
+
+/*
+ * Refill rng->Word[] from the next RNG_BUFFER/2 blocks.  The blocks
+ * are independent, so they are computed LANES at a time with the
+ * rounds on the outside, which the compiler can vectorize.
+ */
+static void RngGenerate(rng)
+RNG *rng;
+{
+  int b,l,r;
+  uint32_t c0[LANES],c1[LANES],c2[LANES],c3[LANES],k0,k1;
+  uint64_t p0,p1,block;
+
+  for(b=0; b<RNG_BUFFER/2; b+=LANES){
+    for(l=0; l<LANES; l++){
+      block= rng->Block+b+l;
+      c0[l]= (uint32_t) block;
+      c1[l]= (uint32_t) (block >> 32);
+      c2[l]= rng->Stream[0];
+      c3[l]= rng->Stream[1];
+    }
+
+    k0= rng->Key[0];
+    k1= rng->Key[1];
+    for(r=0; r<10; r++){
+      if(r>0){
+	k0 += PHILOX_W0;
+	k1 += PHILOX_W1;
+      }
+      for(l=0; l<LANES; l++){
+	p0= (uint64_t) PHILOX_M0*c0[l];
+	p1= (uint64_t) PHILOX_M1*c2[l];
+	c0[l]= (uint32_t) (p1 >> 32)^c1[l]^k0;
+	c2[l]= (uint32_t) (p0 >> 32)^c3[l]^k1;
+	c1[l]= (uint32_t) p1;
+	c3[l]= (uint32_t) p0;
+      }
+    }
+
+    for(l=0; l<LANES; l++){
+      rng->Word[2*(b+l)]=   ((uint64_t) c1[l] << 32) | c0[l];
+      rng->Word[2*(b+l)+1]= ((uint64_t) c3[l] << 32) | c2[l];
+    }
+  }
+
+  rng->Block += RNG_BUFFER/2;
+  rng->NWords= 0;
+}
+
+#undef PHILOX_M0
+#undef PHILOX_M1
+#undef PHILOX_W0
+#undef PHILOX_W1
+#undef LANES
+
+/****************************/
+/******* Streams ************/
+/****************************/
+
+/* Start the stream of trajectory traj for seed */
+void RngInit(rng,seed,traj)
+RNG *rng;
+unsigned long seed,traj;
+{
+  rng->Key[0]=    (uint32_t) seed;
+  rng->Key[1]=    (uint32_t) ((uint64_t) seed >> 32);
+  rng->Stream[1]= (uint32_t) traj;
+  RngSubstream(rng,0UL);
+
+  if(!ZigReady) ZigguratSetup();
+}
+
+/* Switch to substream sub of the same trajectory, from its start */
+void RngSubstream(rng,sub)
+RNG *rng;
+unsigned long sub;
+{
+  rng->Stream[0]= (uint32_t) sub;
+  rng->Block= 0;
+  rng->NWords= RNG_BUFFER;
+  rng->NExponentials= RNG_BUFFER;
+
+#ifdef RNG_DRAND48
+  /* As srand48(seed), with the trajectory and substream mixed in */
+  rng->Drand[0]= 0x330E;
+  rng->Drand[1]= (unsigned short) (rng->Key[0]^rng->Stream[1]*0x9E37U^rng->Stream[0]*0x7F4BU);
+  rng->Drand[2]= (unsigned short) ((rng->Key[0] >> 16)^rng->Key[1]^rng->Stream[1]>>16);
+#endif
+}
+
+uint64_t RngWord(rng)
+RNG *rng;
+{
+  if(rng->NWords==RNG_BUFFER) RngGenerate(rng);
+  return(rng->Word[rng->NWords++]);
+}
+
+/* Uniform deviate on [0,1) with 53 random bits */
+double RngUniform(rng)
+RNG *rng;
+{
+#ifdef RNG_DRAND48
+  return(erand48(rng->Drand));
+#else
+  if(rng->NWords==RNG_BUFFER) RngGenerate(rng);
+  return((rng->Word[rng->NWords++] >> 11)*(1.0/9007199254740992.0));
+#endif
+}
+
+/*
+ * Skip the next n words of the stream (n uniform deviates).
+ * Exponentials already buffered are kept.
+ */
+void RngSkip(rng,n)
+RNG *rng;
+unsigned long long n;
+{
+  uint64_t pos;
+
+#ifdef RNG_DRAND48
+  for(pos=0; pos<n; pos++) erand48(rng->Drand);
+#else
+  /* Position in words of the next word to hand out */
+  pos= (rng->Block-RNG_BUFFER/2)*2+rng->NWords+(uint64_t) n;
+
+  rng->Block= (pos/RNG_BUFFER)*(RNG_BUFFER/2);
+  RngGenerate(rng);
+  rng->NWords= (int) (pos%RNG_BUFFER);
+#endif
+}
+
+/****************************/
+/******* Exponentials *******/
+/****************************/
+
+/*
+ * Ziggurat method of Marsaglia and Tsang (J. Stat. Softw. 5(8), 2000)
+ * with 256 layers.  The low 8 bits of a word choose the layer and 53
+ * of the others the abscissa, so the two are independent.
+ */
+
+#define ZIG_LAYERS 256
+#define ZIG_R      7.69711747013104972
+#define ZIG_V      3.949659822581572e-3
+#define ZIG_M      9007199254740992.0    /* 2^53 */
+
+static uint64_t ZigK[ZIG_LAYERS];
+static double   ZigW[ZIG_LAYERS],ZigF[ZIG_LAYERS];
+
+static void ZigguratSetup()
+{
+  int i;
+  double de,te,q;
+
+  de= ZIG_R;
+  te= de;
+  q=  ZIG_V/exp(-de);
+
+  ZigK[0]= (uint64_t) ((de/q)*ZIG_M);
+  ZigK[1]= 0;
+  ZigW[0]= q/ZIG_M;
+  ZigW[ZIG_LAYERS-1]= de/ZIG_M;
+  ZigF[0]= 1.0;
+  ZigF[ZIG_LAYERS-1]= exp(-de);
+
+  for(i=ZIG_LAYERS-2; i>=1; i--){
+    de= -log(ZIG_V/de+exp(-de));
+    ZigK[i+1]= (uint64_t) ((de/te)*ZIG_M);
+    te= de;
+    ZigF[i]= exp(-de);
+    ZigW[i]= de/ZIG_M;
+  }
+
+  ZigReady= 1;
+}
+
+/* Refill rng->Exponential[] */
+static void FillExponentials(rng)
+RNG *rng;
+{
+  int i,iz;
+  uint64_t w,jz;
+  double x;
+
+  for(i=0; i<RNG_BUFFER; i++){
+    for(;;){
+      w=  RngWord(rng);
+      iz= (int) (w & (ZIG_LAYERS-1));
+      jz= w >> 11;
+      x=  jz*ZigW[iz];
+      if(jz<ZigK[iz]) break;                  /* Inside the layer */
+
+      if(iz==0){                              /* Tail */
+	x= ZIG_R-log(1.0-RngUniform(rng));
+	break;
+      }
+      if(ZigF[iz]+RngUniform(rng)*(ZigF[iz-1]-ZigF[iz]) < exp(-x))
+	break;                                /* Wedge */
+    }
+    rng->Exponential[i]= x;
+  }
+
+  rng->NExponentials= 0;
+}
+
+#undef ZIG_LAYERS
+#undef ZIG_R
+#undef ZIG_V
+#undef ZIG_M
+
+/* Standard exponential deviate (mean 1) */
+double RngExponential(rng)
+RNG *rng;
+{
+#ifdef RNG_DRAND48
+  return(-log(1.0-erand48(rng->Drand)));
+#else
+  if(rng->NExponentials==RNG_BUFFER) FillExponentials(rng);
+  return(rng->Exponential[rng->NExponentials++]);
+#endif
+}
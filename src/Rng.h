@@ -0,0 +1,50 @@
+/**********************
+ *
+ * Counter-based random numbers for Simulac.
+ *
+ * The generator is Philox4x32-10 (Salmon et al., SC11, 2011):
+ * the n-th block of four 32 bit words is a keyed bijection of
+ * the counter n, so any stream can be positioned anywhere in
+ * O(1).  The key is the seed; the rest of the counter holds the
+ * trajectory index and a substream (the cell of a lineage), so
+ * every trajectory of every run has a stream of its own.
+ *
+ * A stream is read as a sequence of 64 bit words, generated a
+ * buffer at a time.  A uniform deviate takes one word; standard
+ * exponentials are made from the words by the ziggurat method,
+ * also a buffer at a time.
+ *
+ * Built with -DRNG_DRAND48 (Simulac-drand48, for RngBench) the
+ * deviates are drawn from erand48() and -log() as they were before.
+ *
+ **********************/
+#define RANDOM
+
+#include <stdint.h>
+
+#define RNG_BUFFER 256    /* Words (and exponentials) per buffer; a multiple of 16 */
+
+typedef struct rng RNG;
+
+struct rng {
+  uint32_t Key[2];      /* Seed */
+  uint32_t Stream[2];   /* Substream, trajectory index */
+  uint64_t Block;       /* Counter of the next block to generate */
+
+  uint64_t Word[RNG_BUFFER];
+  int      NWords;      /* Words of Word[] already handed out */
+
+  double   Exponential[RNG_BUFFER];
+  int      NExponentials;
+
+#ifdef RNG_DRAND48
+  unsigned short Drand[3];  /* State of erand48() (see Rng.c) */
+#endif
+};
+
+extern void     RngInit(RNG *, unsigned long, unsigned long);
+extern void     RngSubstream(RNG *, unsigned long);
+extern uint64_t RngWord(RNG *);
+extern double   RngUniform(RNG *);
+extern double   RngExponential(RNG *);
+extern void     RngSkip(RNG *, unsigned long long);
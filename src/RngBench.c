@@ -0,0 +1,130 @@
+/*******************
+ *
+ * RngBench - time the random numbers drawn for one step of the
+ * reaction clock (a uniform and an exponential) with the buffered
+ * Philox stream, against drand48() and -log() as used before.
+ *
+ * Given an outline it also runs the simulator on it, as Simulac and
+ * as Simulac-drand48 (the same simulator drawing its numbers from
+ * drand48() and -log()), and reports the events a second of each.
+ * It is run from the directory of the outline.
+ *
+ * usage: RngBench [draws [outline maxtime seeds]]
+ *        (built by "make RngBench Simulac-drand48")
+ *
+ ******************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_MATH
+   #include <math.h>
+#endif
+
+#include <string.h>
+#include <time.h>
+
+#ifndef RANDOM
+ #include "Rng.h"
+#endif
+
+static double Seconds()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return(ts.tv_sec+1e-9*ts.tv_nsec);
+}
+
+/*
+ * Events a second of the simulator prog on an outline, for seeds
+ * 1..seeds: the reactions of the NR column over the wall time
+ */
+static double EventRate(prog,outline,maxtime,seeds)
+char *prog,*outline;
+double maxtime;
+int seeds;
+{
+  char cmd[2048],line[8192];
+  double t,time,nr,events;
+  int s;
+  FILE *fp;
+
+  events= 0.0;
+  t= Seconds();
+  for(s=1; s<=seeds; s++){
+    sprintf(cmd,"%s -d 0 %s %g %g %d 2>/dev/null",prog,outline,maxtime,maxtime/10,s);
+    if((fp=popen(cmd,"r"))==NULL){
+      fprintf(stderr,"RngBench: couldn't run %s\n",prog);
+      exit(1);
+    }
+    while(fgets(line,sizeof(line),fp)!=NULL)
+      if(line[0]!='%' && sscanf(line,"%lf %lf",&time,&nr)==2) events += nr;
+    if(pclose(fp)!=0){
+      fprintf(stderr,"RngBench: %s failed\n",cmd);
+      exit(1);
+    }
+  }
+  return(events/(Seconds()-t));
+}
+
+int main(argc,argv)
+int argc;
+char **argv;
+{
+  long i,n;
+  double t,sum,old,buffered;
+  char dir[1024],prog[1100];
+  RNG rng;
+
+  if(argc!=1 && argc!=2 && argc!=5){
+    fprintf(stderr,"usage: RngBench [draws [outline maxtime seeds]]\n");
+    exit(1);
+  }
+  n= (argc>1 ? (long) atof(argv[1]) : 100000000L);
+
+  srand48(1);
+  sum= 0.0;
+  t= Seconds();
+  for(i=0; i<n; i++){
+    sum += drand48();
+    sum += -log(drand48());
+  }
+  old= (Seconds()-t)/n;
+  printf("drand48 + log:        %6.2f ns/step  (%g)\n",1e9*old,sum/n);
+
+  RngInit(&rng,1UL,0UL);
+  sum= 0.0;
+  t= Seconds();
+  for(i=0; i<n; i++){
+    sum += RngUniform(&rng);
+    sum += RngExponential(&rng);
+  }
+  buffered= (Seconds()-t)/n;
+  printf("Philox + ziggurat:    %6.2f ns/step  (%g)\n",1e9*buffered,sum/n);
+
+  printf("speedup:              %6.2f\n",old/buffered);
+
+  if(argc<5) return(0);
+
+  /* The simulators are next to RngBench */
+  strcpy(dir,argv[0]);
+  if(strrchr(dir,'/')!=NULL) strrchr(dir,'/')[1]= '\0';
+  else                       strcpy(dir,"./");
+
+  sprintf(prog,"%sSimulac-drand48",dir);
+  old= EventRate(prog,argv[2],atof(argv[3]),atoi(argv[4]));
+  printf("%s, drand48 + log:     %8.0f events/s\n",argv[2],old);
+
+  sprintf(prog,"%sSimulac",dir);
+  buffered= EventRate(prog,argv[2],atof(argv[3]),atoi(argv[4]));
+  printf("%s, Philox + ziggurat: %8.0f events/s\n",argv[2],buffered);
+
+  printf("speedup:              %6.2f\n",buffered/old);
+  return(0);
+}
@@ -50,61 +50,57 @@
 
 /***********************
  *
- * This Routine cycles over
- * all Sequences to:
+ * This Routine cycles over the 
+ * active machinery to:
  *
+ * 0) Submit initiations on promotors that are able to fire, and
+ *    on the pools of idle operator copies
  * 1) Move the RNAP's down the genes
  * 2) Move all Ribosomes down the bound transcripts
  * 3) Move all Ribosomes down the free  transcripts
  *
+ * Promotors and sequences are taken from the FiringPromotor and
+ * ActiveSequence worklists, which are maintained as operators change
+ * state and as polymerases load onto and leave the DNA.  Sequences
+ * without RNAPs are never visited.
+ *
  ************************/
 
 
 void Polymerize()
 {
-  int         i;
-  DNA        *dna;
-  RNAP       *queue;
+  int         i,j;
+  RNAPINDEX  *index;
+  RNAP       *rnap;
   mRNA       *trans;
-  SEGMENT    *seg;
   
+  void PromotorAction();
+  void SubmitIdleInitiations();
   void MoveRNAPs();
   void MoveRibosomes();
 
+  for(i=0; i<Sim->NFiringPromotors; i++)
+    PromotorAction(Sim->FiringPromotor[i]->Segment);
 
+  SubmitIdleInitiations();
 
-  for(i=0; i<NSequences; i++){
-    
-    dna= &Sequence[i]; /* Sequences Start with Left-Most Member of Structure */
-    
-    while(dna!=NULL){
-      /* Process RNAP actions for this segment */
-      MoveRNAPs(dna);
-      dna= dna->RightSegment;
-    }
-
-    dna= &Sequence[i]; /* Sequences Start with Left-Most Member of Structure */
-    while(dna!=NULL){ 
+  for(i=0; i<Sim->NActiveSequences; i++){
+    index= Sim->ActiveSequence[i];
 
-      if(dna->Type == DNA_Type_Coding){ /*** Only Coding Segments with have polyribosomes attached ****/
-	seg= (SEGMENT *) dna->DNAStruct;
-	queue= (RNAP *) seg->RNAPQueue;
-   
-	while(queue!=NULL){
+    /* Process RNAP actions for this sequence */
+    MoveRNAPs(index);
 
-	  if(queue->Transcript!=NULL)
-	    if(queue->Transcript->Type== mRNA_Type_Sense) /*** Assume AntiSense doesn't have RBS ? ****/
-	      MoveRibosomes(queue->Transcript);
-
-	  queue= queue->NextRNAP;
-	}
-      }
-      dna= dna->RightSegment;
+    for(j=0; j<index->NRNAPs; j++){
+      rnap= index->RNAP[j];
+      if(rnap->Segment->T->Type != DNA_Type_Coding) continue; /*** Only Coding Segments with have polyribosomes attached ****/
+      if(rnap->Transcript!=NULL)
+	if(rnap->Transcript->Type== mRNA_Type_Sense) /*** Assume AntiSense doesn't have RBS ? ****/
+	  MoveRibosomes(rnap->Transcript);
     }
   }
 
   /* Move ribosomes down the free transcripts */
-  trans = Transcript;
+  trans = Sim->Transcript;
       
   while (trans != NULL) {
     /* Save the next transcript to look at */
@@ -130,130 +126,230 @@ void Polymerize()
  *   2) Collision with a counter-propagating RNAP on the anti-sense strand
  *   3) Possible Movement to next functional segment of DNA
  *
+ * RNAPs are taken from the index of the whole sequence, so blocking
+ * and collisions are seen across segment boundaries.
+ *
  *   (Elongation of mRNA is taken care of by the reaction execution routine)
  **************************/
 
-void MoveRNAPs(dna)
-DNA *dna;
+void MoveRNAPs(index)
+RNAPINDEX *index;
 {
-  RNAP *queue,*rnap1,*rnap2;
-  int   blockflag,eflag;
+  int i;
+  RNAP *rnap1,*rnap2;
+  DNA  *dna;
   SEGMENT  *seg;
-  PROMOTOR *prom;
 
   void SubmitSimpleTranscription();
   void SubmitConvergentTranscription();
   void SubmitSimpleJumpSegment();
-  void PromotorAction();
 
-  /**** First we must look for transcription initiations *****/
+  /**** Transcription initiations are handled by Polymerize() *****/
 
-  if(dna->Type== DNA_Type_Promotor){
-    PromotorAction(dna);
-  }
-    
-  if(dna->Type!= DNA_Type_Promotor){
-    seg= (SEGMENT *) dna->DNAStruct;
-    queue= (RNAP *) seg->RNAPQueue;
-  }else{
-    prom= (PROMOTOR *) dna->DNAStruct;
-    queue= (RNAP *) prom->RNAPQueue;
-  }
+  /**** Loop through RNAP's on this sequence ************/
 
-  if(queue==NULL) return;
+  for(i=0; i<index->NRNAPs; i++){
+    rnap1= index->RNAP[i];
+    dna=   rnap1->Segment;
 
-  /**** Loop through RNAP's on this segment ************/
+    /* 
+     * The index is sorted by position, so the only polymerase that
+     * can block us or collide with us is the neighbor in the
+     * direction of motion, whichever segment it is on.
+     */
+    if(rnap1->Direction==RIGHT) rnap2= (i+1<index->NRNAPs ? index->RNAP[i+1] : NULL);
+    else                        rnap2= (i>0 ? index->RNAP[i-1] : NULL);
+
+    if(rnap2!=NULL && abs(rnap2->AbsPosition - rnap1->AbsPosition) > 17)
+      rnap2= NULL;
 
-  rnap1=queue;
-  while(rnap1!=NULL){
-    
     /***** Check to see if we're at end of Segment *******/
 
     DEBUG(100)
     fprintf(stderr,"@@@@ RNAP: GENE= %s [%s =? %s], cp = %d lp= %d\n",
-	    dna->Name,
+	    SegmentName(dna),
 	    (rnap1->Direction == LEFT ? "LEFT" : "RIGHT"),
-	    (dna->Direction == LEFT ? "LEFT" : "RIGHT"),
-	    rnap1->CurrentPosition,dna->Length);
+	    (dna->T->Direction == LEFT ? "LEFT" : "RIGHT"),
+	    rnap1->CurrentPosition,dna->T->Length);
     
-    eflag=0;
-    if(rnap1->Direction==dna->Direction){ 
-      if(rnap1->CurrentPosition == dna->Length){
-
-	/*################# NEED TO CHECK FOR COLLISIONS BETWEEN RNAPS ON DIFFERENT SEGMENTS ##############*/
-	eflag=1;
-
-	if(dna->Type != DNA_Type_Promotor){	  
-	  seg= (SEGMENT *) dna->DNAStruct;
-	  seg->SegmentFunc(dna,rnap1);
-	  rnap1=rnap1->NextRNAP;
-	  continue;
-	} else {
-	  /* Note, this is for RNAP on strand complementary to actual promotor */
-	  SubmitSimpleJumpSegment(dna,rnap1); 
-	  rnap1=rnap1->NextRNAP;
-	  continue;
-	}
+    if((rnap1->Direction==dna->T->Direction && rnap1->CurrentPosition == dna->T->Length) ||
+       (rnap1->Direction!=dna->T->Direction && rnap1->CurrentPosition == 1)){ 
+
+      /* An RNAP just over the boundary holds us on this segment */
+      if(rnap2!=NULL){
+	if(rnap2->Direction != rnap1->Direction)
+	  SubmitConvergentTranscription(dna,rnap1);
+	continue;
       }
-    } else 
-      if(rnap1->CurrentPosition == 1) { /* Reached End of Wrong-Way Transcription */
-	eflag=1;
-	if(dna->Type != DNA_Type_Promotor){
-	  seg= (SEGMENT *) dna->DNAStruct;
-	  seg->SegmentFunc(dna,rnap1);              /** SegmentFunc also must detect direct of RNAP Motion **/
-	  rnap1=rnap1->NextRNAP;
-	  continue;	  
-	} else {
-	  /* Note, this is for RNAP on strand complementary to actual promotor */
-	  SubmitSimpleJumpSegment(dna,rnap1); 
-	  rnap1=rnap1->NextRNAP;
-	  continue;	  
-	}
+
+      if(dna->T->Type != DNA_Type_Promotor){	  
+	seg= DNA_SEGMENT(dna);
+	seg->SegmentFunc(dna,rnap1);              /** SegmentFunc also must detect direct of RNAP Motion **/
+      } else {
+	/* Note, this is for RNAP on strand complementary to actual promotor */
+	SubmitSimpleJumpSegment(dna,rnap1); 
       }
+      continue;
+    }
 
+    /*** We are in the middle of a segment *****/
 
-    if(eflag==0){ /*** We are in the middle of a segment *****/
+    /***** Check if we are blocked by slow RNAP    *******/
+    /***** Check for counter propagating RNAP      *******/
 
-      /***** Check if we are blocked by slow RNAP    *******/
-      /***** Check for counter propagating RNAP      *******/
+    if(rnap2!=NULL){ 
+      /*###### This assumes we will pick up rnap2 later ###########*/	  
+      /* If counterpropagating then collision, otherwise we are blocked */
+      if(rnap2->Direction != rnap1->Direction)
+	SubmitConvergentTranscription(dna,rnap1);
+    } else
+      SubmitSimpleTranscription(dna,rnap1);
+  }
 
-      blockflag=0;
-      rnap2= queue;
+}
 
-      while(rnap2!=NULL){
-	if(rnap2 == rnap1){
-	  if(rnap2==rnap2->NextRNAP){
-	    fprintf(stderr,"%s: Circular linkage of RNAP on fragment %s\n",progid,dna->Name);
-	    exit(-1);
-	  }
-	  rnap2=rnap2->NextRNAP; 
-	  continue;
-	}
-	
-	if(abs(rnap2->CurrentPosition - rnap1->CurrentPosition) <= 17){ 
-	  /*###### This assumes we will pick up rnap2 later ###########*/	  
-	  /* If counterpropagating then collision */
-	  if(rnap2->Direction != rnap1->Direction){
-	    SubmitConvergentTranscription(dna,rnap1);
-	    blockflag=1;
-	    break;
-	  } 
-	  else 
-	    if(rnap1->CurrentPosition<rnap2->CurrentPosition){
-	      blockflag=1;
-	      break;
-	    }
-	}
-	rnap2= rnap2->NextRNAP;
-      }
-      
-      if(blockflag==0){
-	SubmitSimpleTranscription(dna,rnap1);
-      }
+/*********************************/
+/***** RNAP Index Management *****/
+/*********************************/
+
+/***********************
+ *
+ * These routines keep the RNAPs on each
+ * sequence sorted by absolute position (see
+ * DataStructures.h), and maintain the worklist
+ * of sequences carrying RNAPs.
+ *
+ * Absolute positions run left to right along the
+ * sequence; a segment pointing LEFT counts its own
+ * positions from its right-hand end.  RNAPs only
+ * ever move by one step, so keeping the index in 
+ * order normally costs a single comparison.
+ *
+ ************************/
+
+int AbsolutePosition(dna,pos)
+DNA *dna;
+int pos;
+{
+  if(dna->T->Direction==RIGHT) return(dna->T->Offset+pos);
+
+  return(dna->T->Offset+dna->T->Length+1-pos);
+}
+
+/* First slot holding an RNAP to the right of absolute position pos */
+int FindRNAPSlot(index,pos)
+RNAPINDEX *index;
+int pos;
+{
+  int lo,hi,mid;
+
+  lo=0;
+  hi=index->NRNAPs;
+  while(lo<hi){
+    mid= (lo+hi)/2;
+    if(index->RNAP[mid]->AbsPosition <= pos) lo= mid+1;
+    else                                     hi= mid;
+  }
+
+  return(lo);
+}
+
+void InsertRNAP(dna,rnap)
+DNA  *dna;
+RNAP *rnap;
+{
+  int i,slot;
+  RNAPINDEX *index;
+  void SequenceActive();
+
+  index= &dna->Seq->RNAPs;
+
+  if(index->NRNAPs==0){
+    /* Sequence becomes active; add it to the worklist */
+    if(Sim->NActiveSequences==Sim->MaxActiveSequences){
+      Sim->MaxActiveSequences= (Sim->MaxActiveSequences==0 ? 16 : 2*Sim->MaxActiveSequences);
+      Sim->ActiveSequence= (RNAPINDEX **) rrealloc(Sim->ActiveSequence,Sim->MaxActiveSequences,sizeof(RNAPINDEX *),"InsertRNAP");
     }
-    rnap1= rnap1->NextRNAP;
+    index->ActiveIndex= Sim->NActiveSequences;
+    Sim->ActiveSequence[Sim->NActiveSequences++]= index;
+
+    SequenceActive(dna->Seq);
+  }
+
+  if(index->NRNAPs==index->MaxRNAPs){
+    index->MaxRNAPs= (index->MaxRNAPs==0 ? 16 : 2*index->MaxRNAPs);
+    index->RNAP= (RNAP **) rrealloc(index->RNAP,index->MaxRNAPs,sizeof(RNAP *),"InsertRNAP");
+  }
+
+  rnap->Segment= dna;
+  rnap->AbsPosition= AbsolutePosition(dna,rnap->CurrentPosition);
+
+  slot= FindRNAPSlot(index,rnap->AbsPosition);
+
+  for(i=index->NRNAPs; i>slot; i--){
+    index->RNAP[i]= index->RNAP[i-1];
+    index->RNAP[i]->Slot= i;
+  }
+
+  index->RNAP[slot]= rnap;
+  rnap->Slot= slot;
+  index->NRNAPs++;
+}
+
+void RemoveRNAP(rnap)
+RNAP *rnap;
+{
+  int i;
+  SEQUENCE  *seq;
+  RNAPINDEX *index;
+  void SequenceIdle();
+
+  seq=   rnap->Segment->Seq;
+  index= &seq->RNAPs;
+
+  for(i=rnap->Slot; i<index->NRNAPs-1; i++){
+    index->RNAP[i]= index->RNAP[i+1];
+    index->RNAP[i]->Slot= i;
   }
+  index->NRNAPs--;
+
+  rnap->Segment= NULL;
+  rnap->Slot= -1;
 
+  if(index->NRNAPs==0){
+    /* Sequence is now empty; move the last active sequence into its slot */
+    Sim->ActiveSequence[index->ActiveIndex]= Sim->ActiveSequence[--Sim->NActiveSequences];
+    Sim->ActiveSequence[index->ActiveIndex]->ActiveIndex= index->ActiveIndex;
+    index->ActiveIndex= -1;
+
+    SequenceIdle(seq);
+  }
+}
+
+/* Restore the index ordering after an RNAP has moved, possibly onto segment dna */
+void ResortRNAP(dna,rnap)
+DNA  *dna;
+RNAP *rnap;
+{
+  int i;
+  RNAPINDEX *index;
+
+  index= &dna->Seq->RNAPs;
+
+  rnap->Segment= dna;
+  rnap->AbsPosition= AbsolutePosition(dna,rnap->CurrentPosition);
+
+  for(i=rnap->Slot; i>0 && index->RNAP[i-1]->AbsPosition > rnap->AbsPosition; i--){
+    index->RNAP[i]= index->RNAP[i-1];
+    index->RNAP[i]->Slot= i;
+  }
+  for(; i<index->NRNAPs-1 && index->RNAP[i+1]->AbsPosition < rnap->AbsPosition; i++){
+    index->RNAP[i]= index->RNAP[i+1];
+    index->RNAP[i]->Slot= i;
+  }
+
+  index->RNAP[i]= rnap;
+  rnap->Slot= i;
 }
 
 /*********************************/
@@ -302,8 +398,8 @@ RNAP *rnap;
 /*######## Note that this doesn't allow BOTH RNAP's to fall off at once #########*/
 
   DEBUG(20)
-  fprintf(stderr,"@@@@@@ Collision!!!! Time= %e : %s going Lorax is on %s\n",Time,
-	  (rnap->Direction == LEFT ? "LEFT" : "RIGHT"),dna->Name);
+  fprintf(stderr,"@@@@@@ Collision!!!! Time= %e : %s going Lorax is on %s\n",Sim->Time,
+	  (rnap->Direction == LEFT ? "LEFT" : "RIGHT"),SegmentName(dna));
   
   /**** Makes it through ********/
 
@@ -380,10 +476,10 @@ RNAP *rnap;
   /***** Assumes that Termination only works in ONE direction of transcription *******/
 
 
-  if(rnap->Direction== dna->Direction){
+  if(rnap->Direction== dna->T->Direction){
 
 
-    seg= (SEGMENT *) dna->DNAStruct;
+    seg= DNA_SEGMENT(dna);
     tdata= (TERMDATA *) seg->SegmentData;
     
     /**** Check Termination State of RNAP *****/
@@ -467,7 +563,7 @@ RNAP *rnap;
     }
   } else { /* Propagating a different direction */
     DEBUG(50)
-    fprintf(stderr,"@@@@@@ Wrong Way Terminator:  %s\n",dna->Name);
+    fprintf(stderr,"@@@@@@ Wrong Way Terminator:  %s\n",SegmentName(dna));
     SubmitSimpleJumpSegment(dna,rnap);
   }
     
@@ -490,9 +586,9 @@ RNAP *rnap;
 
   /***** Assumes AntiTermination Only works in One direction *********/
 
-  if(rnap->Direction==dna->Direction){
+  if(rnap->Direction==dna->T->Direction){
 
-    seg= (SEGMENT *) dna->DNAStruct;
+    seg= DNA_SEGMENT(dna);
     tdata= (ANTITERMDATA *) seg->SegmentData;
 
     if(rnap->SpeciesIndex!=NULL){
@@ -536,7 +632,8 @@ RNAP *rnap;
 	   element
 	 */
 	   
-	reaction->Probability=  tdata->BindingRate*Concentration[tdata->SpeciesIndex]*(EColi->V0/EColi->V);
+	reaction->Probability=  tdata->BindingRate*Sim->Concentration[tdata->SpeciesIndex]*(Sim->EColi->V0/Sim->EColi->V);
+	reaction->VolumeOrder=  1;
       
 	SubmitReaction(reaction);  
       }
@@ -599,41 +696,29 @@ RNAP *rnap;
    ***/
 
   if(rnap->Transcript!=NULL){
-    NTranscripts++;
+    Sim->NTranscripts++;
 
     /* Put RNAP Transcript at beginning of Queue */
 
     rnap->Transcript->CurrentLength++; /* Finish making Transcript */
 
 
-    if(Transcript!=NULL){
-      Transcript->LastTranscript=rnap->Transcript;
-      rnap->Transcript->NextTranscript=Transcript;
+    if(Sim->Transcript!=NULL){
+      Sim->Transcript->LastTranscript=rnap->Transcript;
+      rnap->Transcript->NextTranscript=Sim->Transcript;
       rnap->Transcript->LastTranscript=NULL;
-      Transcript=rnap->Transcript;
+      Sim->Transcript=rnap->Transcript;
     } else {  
-      Transcript=rnap->Transcript;
-      Transcript->NextTranscript=NULL;
-      Transcript->LastTranscript=NULL;
+      Sim->Transcript=rnap->Transcript;
+      Sim->Transcript->NextTranscript=NULL;
+      Sim->Transcript->LastTranscript=NULL;
     }
-    Transcript->Rnap=NULL;
+    Sim->Transcript->Rnap=NULL;
     /* Cleave Transcript from RNAP */
 
     rnap->Transcript=NULL;
   }
 
-  /*
-  for(i=0; i<NSequences; i++){
-    DNA *sequence;
-    sequence= &Sequence[i];
-    while(sequence!=NULL){	
-      if(sequence->DNAStruct==NULL)
-	fprintf(stderr,"@@@ Time= %e. Null data in sequence %s\n",Time,sequence->Name);
-	sequence= sequence->RightSegment;
-    }
-  }
-  */
-
   SubmitSimpleJumpSegment(dna,rnap);  
 }
 
@@ -648,6 +733,9 @@ void *rdata;
   MOVERNAP *data;
   RNAP *rnap;
   DNA  *dna;
+  void ResortRNAP();
+
+  mRNA *AllocTranscript();
 
   DEBUG(50)
   fprintf(stderr,"@@@ SimpleRNAPMover()\n");
@@ -656,18 +744,17 @@ void *rdata;
   rnap= data->rnap1;
   dna=  data->dna;
 
-  if(rnap->Direction==dna->Direction)
+  if(rnap->Direction==dna->T->Direction)
     rnap->CurrentPosition += 1;
   else
     rnap->CurrentPosition -= 1;
+
+  ResortRNAP(dna,rnap);
   
-  if(dna->Type == DNA_Type_Coding){
+  if(dna->T->Type == DNA_Type_Coding){
     if(rnap->Transcript== NULL){
-      rnap->Transcript= (mRNA *) rcalloc(1,sizeof(mRNA),"SimpleRNAPMover");
-      rnap->Transcript->Gene=dna;
-      rnap->Transcript->Rnap=rnap;
+      rnap->Transcript= AllocTranscript(dna,rnap);
       rnap->Transcript->CurrentLength=2;
-      rnap->Transcript->Type= (dna->Direction == rnap->Direction ? mRNA_Type_Sense : mRNA_Type_AntiSense);
     } else {
       rnap->Transcript->CurrentLength++;
     }
@@ -680,12 +767,10 @@ void *rdata;
 {
   int i;
   MOVERNAP *data;
-  RNAP *rnap,*queue;
+  RNAP *rnap;
   DNA  *dna;
-  SEGMENT  *seg;
-  PROMOTOR *prom;
-
-
+  void RemoveRNAP();
+  void FreeTranscript();
 
   data= (MOVERNAP *) rdata;
 
@@ -694,72 +779,27 @@ void *rdata;
 
   DEBUG(50)
   fprintf(stderr,"@@@ RNAPFallsOff(): %s going Lorax falls off %s\n",
-	  (rnap->Direction==LEFT ? "LEFT": "RIGHT"), dna->Name);
+	  (rnap->Direction==LEFT ? "LEFT": "RIGHT"), SegmentName(dna));
 
-  Concentration[0] += 1; /* Return Polymerase to Pool */
+  Sim->Concentration[0] += 1; /* Return Polymerase to Pool */
   
   /* Free Memory */
 
-  if(dna->Type!= DNA_Type_Promotor){
-    seg= (SEGMENT *) dna->DNAStruct;
-
-    if(rnap->LastRNAP==NULL){
-      seg->RNAPQueue=rnap->NextRNAP;
-      if(seg->RNAPQueue!=NULL) seg->RNAPQueue->LastRNAP=NULL;
-    }else{
-      queue=rnap->LastRNAP;      
-      queue->NextRNAP= rnap->NextRNAP;
-      if(rnap->NextRNAP!=NULL) rnap->NextRNAP->LastRNAP=queue;
-    }
-    
-  } else {
-    prom= (PROMOTOR *) dna->DNAStruct;
-    if(rnap->LastRNAP==NULL){
-      prom->RNAPQueue=rnap->NextRNAP;
-      if(prom->RNAPQueue!=NULL) prom->RNAPQueue->LastRNAP=NULL;
-    } else{
-      queue=rnap->LastRNAP;      
-      queue->NextRNAP= rnap->NextRNAP;
-      if(rnap->NextRNAP!=NULL) rnap->NextRNAP->LastRNAP=queue;
-    }  
-  }
+  RemoveRNAP(rnap);
 
   if(rnap->SpeciesIndex!=NULL){
   
     /* Return Bound Modifiers to Pool */
     
     for(i=0; i<rnap->NBound; i++)
-      Concentration[rnap->SpeciesIndex[i]]++;
+      Sim->Concentration[rnap->SpeciesIndex[i]]++;
     
     free(rnap->SpeciesIndex);
     rnap->SpeciesIndex = NULL;
   }
 
   if(rnap->Transcript!=NULL){
-    RIBOSOME *rqueue;
-
-    rqueue= (RIBOSOME *) rnap->Transcript->RiboQueue;
-    while(rqueue!=NULL){
-      
-      /* Now free ribosome structure */
-      if(rqueue->SpeciesIndex!=NULL){
-	for(i=0; i<rqueue->NBound; i++)
-	  Concentration[rqueue->SpeciesIndex[i]]++;
-	free(rqueue->SpeciesIndex);
-	rqueue->SpeciesIndex = NULL;
-      }
-
-      if(rqueue->NextRibosome==NULL){
-	rnap->Transcript->RiboQueue= NULL;
-	FreeRibosome(rqueue);
-	break;
-      } else {
-	rnap->Transcript->RiboQueue= rqueue->NextRibosome;
-	FreeRibosome(rqueue);
-      }
-      rqueue= rnap->Transcript->RiboQueue;
-    }   
-    free(rnap->Transcript);
+    FreeTranscript(rnap->Transcript);
     rnap->Transcript = NULL;
   }
 
@@ -772,95 +812,37 @@ void *rdata;
 {
   int i;
   MOVERNAP *data;
-  RNAP *rnap,*queue;
+  RNAP *rnap;
   DNA  *dna;
-  SEGMENT  *seg;
-  PROMOTOR *prom;
-
+  void RemoveRNAP();
+  void FreeTranscript();
 
   data= (MOVERNAP *) rdata;
 
   rnap= data->rnap1;
 
-  /* Remove rnap from the original queue */
-  
   dna= data->dna;
 
   DEBUG(20)
-  fprintf(stderr,"@@@@ RNAP Jumping from %s\n",dna->Name);
-
-  if(dna->Type!= DNA_Type_Promotor){
-    seg= (SEGMENT *) dna->DNAStruct;
-    if(rnap->LastRNAP==NULL){
-      seg->RNAPQueue=rnap->NextRNAP;
-      if(seg->RNAPQueue!=NULL) seg->RNAPQueue->LastRNAP=NULL;
-    } else{
-      queue=rnap->LastRNAP;   
-      queue->NextRNAP= rnap->NextRNAP;
-      if(rnap->NextRNAP!=NULL) rnap->NextRNAP->LastRNAP=queue;
-    }
-  } else {
-    prom= (PROMOTOR *) dna->DNAStruct;
-    if(rnap->LastRNAP==NULL){
-      prom->RNAPQueue=rnap->NextRNAP;
-      if(prom->RNAPQueue!=NULL) prom->RNAPQueue->LastRNAP=NULL;
-    } else{
-      queue=rnap->LastRNAP;      
-      queue->NextRNAP= rnap->NextRNAP;
-      if(rnap->NextRNAP!=NULL) rnap->NextRNAP->LastRNAP=queue;
-    }
-  }
-  
-  /**** Add to Next Queue *******/
+  fprintf(stderr,"@@@@ RNAP Jumping from %s\n",SegmentName(dna));
+
+  /**** Move to Next Segment *******/
 
   if(rnap->Direction == LEFT)
-    dna=  data->dna->LeftSegment;
+    dna=  LEFT_SEGMENT(data->dna);
   else
-    dna=  data->dna->RightSegment;
+    dna=  RIGHT_SEGMENT(data->dna);
   
-  /*** Add RNAP to next segment's RNAP queue *****/
+  /*** RNAP stays in the sequence's index; SimpleRNAPMover() updates it *****/
   if(dna!=NULL){ /* If not at END of segment */
 
     DEBUG(20)
-    fprintf(stderr,"@@@ New RNAP jumped to segment %s\n",dna->Name);
+    fprintf(stderr,"@@@ New RNAP jumped to segment %s\n",SegmentName(dna));
     
-    if(dna->Type!= DNA_Type_Promotor){
-      seg= (SEGMENT *) dna->DNAStruct;
-      if(seg->RNAPQueue != NULL){
-	queue= (RNAP *) seg->RNAPQueue;
-	rnap->NextRNAP=queue;
-	queue->LastRNAP=rnap;
-	seg->RNAPQueue=rnap;
-	rnap->LastRNAP=NULL;
-      } else {
-	rnap->LastRNAP=NULL;
-	rnap->NextRNAP=NULL;
-	seg->RNAPQueue= rnap;
-      }
-    } else {
-
-      prom= (PROMOTOR *) dna->DNAStruct;
-
-      if(prom->RNAPQueue != NULL){
-
-	queue= (RNAP *) prom->RNAPQueue;
-
-	rnap->NextRNAP=queue;
-	queue->LastRNAP=rnap;
-	prom->RNAPQueue=rnap;
-	rnap->LastRNAP=NULL;
-      } else {
-	
-	rnap->LastRNAP=NULL;
-	rnap->NextRNAP=NULL;
-	prom->RNAPQueue=rnap;
-      }
-    }
-          
     /*** Reset Relative Position ****/
     
-    if(rnap->Direction != dna->Direction)
-      rnap->CurrentPosition= dna->Length;
+    if(rnap->Direction != dna->T->Direction)
+      rnap->CurrentPosition= dna->T->Length;
     else 
       rnap->CurrentPosition= 1;
 
@@ -888,44 +870,21 @@ void *rdata;
     DEBUG(20)
       fprintf(stderr,"@@@ Freeing RNAP\n");
 
+     RemoveRNAP(rnap);
+
      if(rnap->SpeciesIndex!=NULL){
        
        for(i=0; i<rnap->NBound; i++)
-	Concentration[rnap->SpeciesIndex[i]]++;
+	Sim->Concentration[rnap->SpeciesIndex[i]]++;
        
        free(rnap->SpeciesIndex);
        rnap->SpeciesIndex = NULL;
      }
     
      if(rnap->Transcript!=NULL){
-       RIBOSOME *rqueue;
-
        fprintf(stderr,"@@@ Removing a weird transcript\n");
-       rqueue= (RIBOSOME *) rnap->Transcript->RiboQueue;
-       while(rqueue!=NULL){
-	 
-	 /* Now free ribosome structure */
-	 if(rqueue->SpeciesIndex!=NULL){
-	   for(i=0; i<rqueue->NBound; i++)
-	     Concentration[rqueue->SpeciesIndex[i]]++;
-	   
-	   if(rqueue->SpeciesIndex!=NULL) {
-	     free(rqueue->SpeciesIndex);
-	     rqueue->SpeciesIndex = NULL;
-	   }
-
-	 }
-	 
-	 if(rqueue->NextRibosome==NULL){
-	   FreeRibosome(rqueue);
-	   break;
-	 } else {
-	   rqueue=rqueue->NextRibosome;
-	   FreeRibosome(rqueue->LastRibosome);
-	 }
-       }         
+       FreeTranscript(rnap->Transcript);
        fprintf(stderr,"%%%%%% Delete Transcript\n");
-       free(rnap->Transcript);
        rnap->Transcript = NULL;
      }
      
@@ -952,7 +911,7 @@ void *rdata;
 
   DEBUG(50)
     fprintf(stderr,"@@@ AntiTerminateRNAP()\n");
-  seg= (SEGMENT *) dna->DNAStruct;
+  seg= DNA_SEGMENT(dna);
   tdata= (ANTITERMDATA *) seg->SegmentData;
 
   /**** Check Termination State of RNAP *****/
@@ -980,7 +939,7 @@ void *rdata;
 
   }    
   
-  Concentration[tdata->SpeciesIndex] -= 1;
+  Sim->Concentration[tdata->SpeciesIndex] -= 1;
   rnap->SpeciesIndex[rnap->NBound]=tdata->SpeciesIndex;
   rnap->NBound++;
 
@@ -1003,7 +962,7 @@ void *rdata;
   dna=  data->dna;
   rnap= data->rnap1;
 
-  seg= (SEGMENT *) dna->DNAStruct;
+  seg= DNA_SEGMENT(dna);
   tdata= (ANTITERMDATA *) seg->SegmentData;
 
   /**** Check Termination State of RNAP *****/
@@ -1039,7 +998,7 @@ void *rdata;
     }
   }
   
-  Concentration[tdata->SpeciesIndex] += 1;
+  Sim->Concentration[tdata->SpeciesIndex] += 1;
   rnap->NBound--;  
 
 }
@@ -1073,92 +1032,221 @@ void *rdata;
 void MoveRibosomes(trans)
 mRNA *trans;
 {
-  int FullLength,CurrLength,cp1;
-  RIBOSOME *queue;
+  int FullLength,CurrLength,cp1,k;
+  RIBOSOME *ribosome;
 
   void SubmitClearRBS();
   void SubmitMoveRibosome();
   void SubmitProduceProtein();
+  void UnlinkTranscript();
+  void FreeTranscript();
+  int  LatticeClear();
   
   if(trans->Type==mRNA_Type_AntiSense) return;
   if(trans->CurrentLength<20) return;
 
-  FullLength= trans->Gene->Length;
+  FullLength= trans->Gene->T->Length;
   CurrLength= trans->CurrentLength;
 
   /***** First take care of possible binding events ******/
 
-  /**** Remember, Riboqueues are ALWAYS in order! *****/
-  queue= trans->RiboQueue;
-
-
-  if(trans->Rnap==NULL && trans->RBSState==mRNA_RBS_Chewed && queue==NULL){ 
+  if(trans->Rnap==NULL && trans->RBSState==mRNA_RBS_Chewed && trans->NRibosomes==0){ 
     /* Its a Free Transcript with no ribosomes bound */
     /* So free it up */
     
-    if(trans->LastTranscript==NULL){
-      Transcript=trans->NextTranscript;
-      if(Transcript!=NULL) Transcript->LastTranscript=NULL;
-    } else{
-      trans->LastTranscript->NextTranscript=trans->NextTranscript;
-      if(trans->NextTranscript!=NULL)
-	trans->NextTranscript->LastTranscript=trans->LastTranscript;
-    }
-    NTranscripts--;
-    free(trans);
+    UnlinkTranscript(trans);
+    FreeTranscript(trans);
     return;
   }
   
   
   if(trans->RBSState!=mRNA_RBS_Chewed){
-    if(queue==NULL || queue->CurrentPosition>14) /**** RBS IS CLEAR!!!!!! *****/
+    if(LatticeClear(trans,1,14)) /**** RBS IS CLEAR!!!!!! *****/
       SubmitClearRBS(trans);
   } 
   
   /**** Move them puppies *****/
 
-  while(queue!=NULL){
+  for(k=0; k<trans->NRibosomes; k++){
     
-    cp1= queue->CurrentPosition;
+    ribosome= RIBOSOME_AT(trans,k);
+    cp1= ribosome->CurrentPosition;
     
-    if(queue->NextRibosome==NULL){ /* Can't collide with next ribosome */
-      
-      /* Check if at end of transcript */
-
-      if(CurrLength<FullLength){ /* Not a free transcript */
-	if(cp1< (CurrLength-5)) /* Not at end of partial transcript */
-	  SubmitMoveRibosome(trans,queue);
-	/* else We are abutting polymerase */
-      } else {                    /* We are a free transcript */
-	if(cp1== FullLength)      /* We have reached end of transcript */
-	  SubmitProduceProtein(trans,queue);
-	else 
-	  SubmitMoveRibosome(trans,queue);
-      }
-    } else { /* Same thing except we check for collisions here */
-
-      if((queue->NextRibosome->CurrentPosition - queue->CurrentPosition)>=10){ /* Then No Collision imminent */
-
-	if(CurrLength<FullLength){ /* Not a free transcript */
-	  if(cp1< (CurrLength-5)) /* Not at end of partial transcript */
-	    SubmitMoveRibosome(trans,queue);
-	  /* else We are abutting polymerase */
-	} else {                    /* We are a free transcript */
-	  
-	  if(cp1== FullLength)      /* We have reached end of transcript */
-	    SubmitProduceProtein(trans,queue);
-	  else 
-	    SubmitMoveRibosome(trans,queue);
-	}
-	
-      }
+    /* Ribosomes cover 10 nucleotides: need the footprint ahead clear */
+    if(!LatticeClear(trans,cp1+1,cp1+9)) continue;
+
+    if(CurrLength<FullLength){ /* Not a free transcript */
+      if(cp1< (CurrLength-5)) /* Not at end of partial transcript */
+	SubmitMoveRibosome(trans,ribosome);
+      /* else We are abutting polymerase */
+    } else {                    /* We are a free transcript */
+      if(cp1== FullLength)      /* We have reached end of transcript */
+	SubmitProduceProtein(trans,ribosome);
+      else 
+	SubmitMoveRibosome(trans,ribosome);
     }
+  }
+
+}
+
+/*****************************
+ *
+ * Transcripts and their ribosome lattice.
+ *
+ * The occupancy bitmap has one bit per nucleotide of the gene
+ * (plus the sites either side of it); a bit is set if a ribosome
+ * sits on that nucleotide.  Ribosomes never get closer than 9
+ * nucleotides, which bounds the size of the ring buffer.
+ *
+ ********************************/
+
+#define LATTICE_WORD_BITS (8*sizeof(unsigned long))
+
+mRNA *AllocTranscript(dna,rnap)
+DNA  *dna;
+RNAP *rnap;
+{
+  mRNA *trans;
+  int   nwords;
+  char *block;
+
+  trans= (mRNA *) rcalloc(1,sizeof(mRNA),"AllocTranscript");
+  trans->Gene=dna;
+  trans->Rnap=rnap;
+  trans->Type= (dna->T->Direction == rnap->Direction ? mRNA_Type_Sense : mRNA_Type_AntiSense);
 
-    /* Next Ribosome */
+  /* Ribosomes never bind AntiSense transcripts */
+  if(trans->Type==mRNA_Type_AntiSense) return(trans);
 
-    queue= queue->NextRibosome;
+  nwords= (dna->T->Length+2+LATTICE_WORD_BITS-1)/LATTICE_WORD_BITS;
+  trans->MaxRibosomes= dna->T->Length/9+2;
+  trans->LatticeSize= trans->MaxRibosomes*sizeof(RIBOSOME)+nwords*sizeof(unsigned long);
+
+  block= (char *) AllocLattice((size_t) trans->LatticeSize);
+  trans->Ribosome= (RIBOSOME *) block;
+  trans->Occupancy= (unsigned long *) (block+trans->MaxRibosomes*sizeof(RIBOSOME));
+
+  return(trans);
+}
+
+void FreeTranscript(trans)
+mRNA *trans;
+{
+  int i,k;
+  RIBOSOME *ribosome;
+
+  for(k=0; k<trans->NRibosomes; k++){
+    ribosome= RIBOSOME_AT(trans,k);
+
+    if(ribosome->SpeciesIndex!=NULL){
+      for(i=0; i<ribosome->NBound; i++)
+	Sim->Concentration[ribosome->SpeciesIndex[i]]++;
+      free(ribosome->SpeciesIndex);
+      ribosome->SpeciesIndex = NULL;
+    }
+  }
+
+  if(trans->Ribosome!=NULL)
+    FreeLattice((void *) trans->Ribosome,(size_t) trans->LatticeSize);
+
+  free(trans);
+}
+
+/* Take a free transcript off the Transcript list */
+void UnlinkTranscript(trans)
+mRNA *trans;
+{
+  if(trans->LastTranscript==NULL){
+    Sim->Transcript=trans->NextTranscript;
+    if(Sim->Transcript!=NULL) Sim->Transcript->LastTranscript=NULL;
+  } else{
+    trans->LastTranscript->NextTranscript=trans->NextTranscript;
+    if(trans->NextTranscript!=NULL)
+      trans->NextTranscript->LastTranscript=trans->LastTranscript;
+  }
+  Sim->NTranscripts--;
+}
+
+/*
+ * Give a transcript to the other daughter at division.  Its ribosomes,
+ * and whatever is bound to them, leave with it and are not returned
+ * to the pool.
+ */
+void GiveAwayTranscript(trans)
+mRNA *trans;
+{
+  int k;
+  RIBOSOME *ribosome;
+
+  for(k=0; k<trans->NRibosomes; k++){
+    ribosome= RIBOSOME_AT(trans,k);
+    if(ribosome->SpeciesIndex!=NULL){
+      free(ribosome->SpeciesIndex);
+      ribosome->SpeciesIndex = NULL;
+    }
   }
 
+  if(trans->Rnap==NULL) UnlinkTranscript(trans);
+  FreeTranscript(trans);
+}
+
+/* Give the RNAPs on a sequence, with their transcripts, to the other daughter */
+void GiveAwayRNAPs(seq)
+SEQUENCE *seq;
+{
+  RNAP *rnap;
+
+  while(seq->RNAPs.NRNAPs>0){
+    rnap= seq->RNAPs.RNAP[seq->RNAPs.NRNAPs-1];
+    RemoveRNAP(rnap);
+
+    if(rnap->SpeciesIndex!=NULL){
+      free(rnap->SpeciesIndex);
+      rnap->SpeciesIndex = NULL;
+    }
+    if(rnap->Transcript!=NULL){
+      GiveAwayTranscript(rnap->Transcript);
+      rnap->Transcript = NULL;
+    }
+    FreeRNAP(rnap);
+  }
+}
+
+void SetLatticeSite(trans,pos,occupied)
+mRNA *trans;
+int   pos,occupied;
+{
+  unsigned long bit;
+
+  bit= 1UL << (pos%LATTICE_WORD_BITS);
+  if(occupied)
+    trans->Occupancy[pos/LATTICE_WORD_BITS] |= bit;
+  else
+    trans->Occupancy[pos/LATTICE_WORD_BITS] &= ~bit;
+}
+
+/* TRUE if no ribosome sits on nucleotides lo..hi of the transcript */
+int LatticeClear(trans,lo,hi)
+mRNA *trans;
+int   lo,hi;
+{
+  int w,wlo,whi;
+  unsigned long mask;
+
+  if(hi>trans->Gene->T->Length+1) hi= trans->Gene->T->Length+1;
+  if(lo>hi) return(TRUE);
+
+  wlo= lo/LATTICE_WORD_BITS;
+  whi= hi/LATTICE_WORD_BITS;
+
+  for(w=wlo; w<=whi; w++){
+    mask= ~0UL;
+    if(w==wlo) mask &= ~0UL << (lo%LATTICE_WORD_BITS);
+    if(w==whi) mask &= ~0UL >> (LATTICE_WORD_BITS-1-hi%LATTICE_WORD_BITS);
+    if(trans->Occupancy[w] & mask) return(FALSE);
+  }
+
+  return(TRUE);
 }
 
 /**************************************************************/
@@ -1190,18 +1278,19 @@ mRNA    *trans;
   reaction->ReactionFunc= BindRibosome;
 # ifdef RMM_MODS
   /* Grab the ribosome binding rate from the coding data */
-  seg = (SEGMENT *) trans->Gene->DNAStruct;
+  seg = DNA_SEGMENT(trans->Gene);
   SegData = (CODINGDATA *) seg->SegmentData;
-  reaction->Probability = SegData->RibosomeBindingRate * Concentration[1] * 
-    (EColi->V0/EColi->V);
+  reaction->Probability = SegData->RibosomeBindingRate * Sim->Concentration[1] * 
+    (Sim->EColi->V0/Sim->EColi->V);
 # else
   /* DeFacto Bimolecular: Volume Element Included */
-  reaction->Probability=  Rate_Of_Ribosome_Binding*Concentration[1]*(EColi->V0/EColi->V);
+  reaction->Probability=  Rate_Of_Ribosome_Binding*Sim->Concentration[1]*(Sim->EColi->V0/Sim->EColi->V);
 # endif
+  reaction->VolumeOrder=  1;
 
   SubmitReaction(reaction);  
 
-  seg= (SEGMENT *) trans->Gene->DNAStruct;
+  seg= DNA_SEGMENT(trans->Gene);
   SegData= (CODINGDATA *) seg->SegmentData;
 
   rdata= (MOVERIBO *) AllocMRibosome();
@@ -1285,7 +1374,9 @@ void *rdata;
 
   ribosome= data->ribosome;
 
+  SetLatticeSite(data->trans,ribosome->CurrentPosition,FALSE);
   ribosome->CurrentPosition += 1;
+  SetLatticeSite(data->trans,ribosome->CurrentPosition,TRUE);
 
 }
 
@@ -1301,16 +1392,23 @@ void *rdata;
   data= (MOVERIBO *) rdata;
 
   trans=    data->trans;
-  ribosome= (RIBOSOME *) AllocRibosome();
 
+  if(trans->NRibosomes>=trans->MaxRibosomes){
+    fprintf(stderr,"%s: Ribosome lattice overflow on %s in BindRibosome().\n",progid,SegmentName(trans->Gene));
+    exit(-1);
+  }
+
+  /* New ribosomes go on the 5' end of the ring */
+  trans->FirstRibosome= (trans->FirstRibosome+trans->MaxRibosomes-1)%trans->MaxRibosomes;
+  trans->NRibosomes++;
+
+  ribosome= RIBOSOME_AT(trans,0);
+  ribosome->NBound=0;
+  ribosome->SpeciesIndex=NULL;
   ribosome->CurrentPosition= 1;
-  ribosome->Transcript=trans;
-  ribosome->LastRibosome=NULL;
-  if(trans->RiboQueue!=NULL) trans->RiboQueue->LastRibosome= ribosome;
-  ribosome->NextRibosome=trans->RiboQueue;
-  trans->RiboQueue=ribosome;
+  SetLatticeSite(trans,1,TRUE);
 
-  Concentration[1]--;  
+  Sim->Concentration[1]--;  
 
 }
 
@@ -1325,7 +1423,7 @@ void *rdata;
 
   trans=    data->trans;
   DEBUG(50)
-    fprintf(stderr,"@@@ EatmRNA %s\n",trans->Gene->Name);
+    fprintf(stderr,"@@@ EatmRNA %s\n",SegmentName(trans->Gene));
   trans->RBSState= mRNA_RBS_Chewed;
 
 }
@@ -1348,37 +1446,33 @@ void *rdata;
   ribosome= data->ribosome;
 
   
-  seg= (SEGMENT *) trans->Gene->DNAStruct;
+  seg= DNA_SEGMENT(trans->Gene);
   SegData= (CODINGDATA *) seg->SegmentData;
 
   /** Produce Protein **/
 
   produced= SegData->SpeciesIndex;
-  Concentration[produced]++;
+  Sim->Concentration[produced]++;
 
  /** Unbind Ribosome **/
 
-  Concentration[1]++; /* Release Ribosome back to pool */
+  Sim->Concentration[1]++; /* Release Ribosome back to pool */
 
-  if(ribosome->LastRibosome!=NULL)
-    ribosome->LastRibosome->NextRibosome= NULL;
-  else 
-    trans->RiboQueue=NULL;
-
-  if(ribosome->NextRibosome!=NULL){
+  if(trans->NRibosomes==0 || ribosome!=RIBOSOME_AT(trans,trans->NRibosomes-1)){
     fprintf(stderr,"%s: Improperly terminated ribosome queue in ProduceNewProtein().\n",progid);
     exit(-1);
   }
+
+  SetLatticeSite(trans,ribosome->CurrentPosition,FALSE);
+  trans->NRibosomes--;
   
   /* Now free ribosome structure */
   
   if(ribosome->SpeciesIndex!=NULL){
     for(i=0; i<ribosome->NBound; i++)
-      Concentration[ribosome->SpeciesIndex[i]]++;
+      Sim->Concentration[ribosome->SpeciesIndex[i]]++;
     
     free(ribosome->SpeciesIndex);
     ribosome->SpeciesIndex = NULL;
   }
-
-  FreeRibosome(ribosome);
 }
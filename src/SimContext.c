@@ -0,0 +1,185 @@
+/**************************
+ *
+ * Simulation contexts (see DataStructures.h)
+ *
+ * The outline is parsed into a first, empty context.  Further
+ * contexts are made from it without reading any file: the parsed
+ * model is shared, and the copies of the sequences, with their
+ * operators, are made again from the templates.
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef MEMORY
+ #include "Memory.h"
+#endif
+
+#ifndef RANDOM
+ #include "Rng.h"
+#endif
+
+__thread SIMCONTEXT *Sim=NULL;
+
+/*
+ * Make a context.  With proto NULL it is empty, ready for the
+ * outline to be parsed into it.  Otherwise it starts in the state
+ * proto started in (proto must not have run yet): the same counts,
+ * cell and copies of every sequence.  The random stream and the
+ * output are left for the caller to set.  The context takes its
+ * objects from pools, which must not be used by another thread at
+ * the same time, or from pools of its own if pools is NULL.
+ */
+SIMCONTEXT *NewSimContext(proto,pools)
+SIMCONTEXT *proto;
+struct mempools *pools;
+{
+  int i,k,p;
+  SIMCONTEXT *sim,*caller;
+  SEQTEMPLATE *tmpl;
+  SEQUENCE *seq;
+
+  SEQUENCE *NewSequenceCopy();
+  void AttachOperator();
+  void LinkSequences();
+
+  sim= (SIMCONTEXT *) rcalloc(1,sizeof(SIMCONTEXT),"NewSimContext.1");
+  sim->Rng= (RNG *) rcalloc(1,sizeof(RNG),"NewSimContext.2");
+
+  /* The routines below work on the current context */
+  caller= Sim;
+  Sim= sim;
+
+  sim->OwnPools= (pools==NULL);
+  sim->Pools= (pools==NULL ? NewMemoryPools() : pools);
+
+  if(proto!=NULL){
+    sim->Concentration= (int *) rcalloc(NSpecies,sizeof(int),"NewSimContext.3");
+    memcpy(sim->Concentration,proto->Concentration,NSpecies*sizeof(int));
+
+    sim->EColi= (CELL *) rcalloc(1,sizeof(CELL),"NewSimContext.4");
+    *sim->EColi= *proto->EColi;
+    sim->Rates= proto->Rates;
+
+    /* Copies are made in the order of the parse, so operators keep their columns */
+    sim->Copies= (SEQCOPIES *) rcalloc(NSeqTemplates+1,sizeof(SEQCOPIES),"NewSimContext.5");
+    for(i=0; i<NSeqTemplates; i++){
+      tmpl= SeqTemplate[i];
+      for(k=0; k<proto->Copies[i].NCopies; k++){
+	seq= NewSequenceCopy(tmpl);
+	for(p=0; p<tmpl->NPromotors; p++)
+	  AttachOperator(&seq->Promotor[p]);
+      }
+    }
+
+    for(i=0; i<sim->NOperators && i<proto->NOperators; i++)
+      sim->Operator[i].CurrentState= proto->Operator[i].CurrentState;
+
+    LinkSequences();
+  }
+
+  Sim= caller;
+
+  return(sim);
+}
+
+/* Release a context and everything in it */
+void FreeSimContext(sim)
+SIMCONTEXT *sim;
+{
+  int i,k;
+  SIMCONTEXT *caller;
+  SEQUENCE  *seq;
+  OPERGROUP *group;
+  mRNA      *trans;
+
+  void FreeReactionQueue();
+  void GiveAwayTranscript();
+  void GiveAwayRNAPs();
+
+  caller= Sim;
+  Sim= sim;
+
+  FreeReactionQueue();
+
+  while((trans=sim->Transcript)!=NULL)
+    GiveAwayTranscript(trans);
+
+  for(i=0; i<NSeqTemplates && sim->Copies!=NULL; i++){
+    for(k=0; k<sim->Copies[i].MaxCopies; k++){
+      seq= sim->Copies[i].Copy[k];
+      GiveAwayRNAPs(seq);
+      free(seq->RNAPs.RNAP);
+      free(seq->Segment);
+      free(seq->Promotor);
+      free(seq);
+    }
+    free(sim->Copies[i].Copy);
+  }
+  free(sim->Copies);
+
+  for(i=0; i<sim->NOperators; i++){
+    free(sim->Operator[i].Name);
+    free(sim->Operator[i].Promotors);
+  }
+  free(sim->Operator);
+
+  for(i=0; i<sim->NOperGroups; i++){
+    group= sim->OperGroup[i];
+    free(group->Member);
+    free(group->Count);
+    free(group->Init);
+    free(group);
+  }
+  free(sim->OperGroup);
+
+  free(sim->Sequence);
+#ifdef RMM_MODS
+  free(sim->Promotor);
+#endif
+  free(sim->FiringPromotor);
+  free(sim->ActiveSequence);
+
+  free(sim->ConfigProb);
+  free(sim->SpeciesNeed);
+  free(sim->UnitGroup);
+  free(sim->UnitOper);
+
+  free(sim->Concentration);
+  free(sim->EColi);
+  if(sim->OwnRates) free(sim->Rates);
+  free(sim->Row.Value);
+  free(sim->Kept.Data);
+  free(sim->Codec.Buffer.Data);
+  free(sim->Codec.Last);
+  free(sim->StopValue);
+  free(sim->StopIntegral);
+
+  if(sim->OwnPools) FreeMemoryPools(sim->Pools);
+  free(sim->Rng);
+
+  Sim= (caller==sim ? NULL : caller);
+  free(sim);
+}
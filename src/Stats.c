@@ -0,0 +1,205 @@
+/**************************
+ *
+ * Ensemble statistics.
+ *
+ * With --stats an ensemble takes the statistics of every column of the
+ * output across its trajectories, time by time, as it runs: rather
+ * than the files of all the trajectories being read back to take them
+ * (as simulac.py's computeStats() does), each trajectory is added to
+ * them once it is done.  They are the mean, variance, least and
+ * greatest value, --stats-quantiles and histograms of --stats-bins
+ * bins (see Summary.c), with the number of trajectories that got to
+ * each time: they all do, but for those a stop condition ended early
+ * (see Fate.c).  The row of a fate decided between the printed times
+ * is not in them.
+ *
+ * A trajectory's rows are kept while it runs (see KeepRow()), and the
+ * trajectories are handed out and added in order, as those of an
+ * adaptive ensemble are (see Target.c): the statistics are those one
+ * thread would take, to the bit, however many take them.  Only the
+ * rows of the trajectories done ahead of one still going are kept,
+ * and no more than AHEAD a thread are handed out past it (see
+ * WindowEnsemble()), so the rows kept don't grow with the ensemble:
+ * a thread that would go further waits for it.
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#include <pthread.h>
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef DISTRIBUTE
+ #include "Distribute.h"
+#endif
+
+#ifndef FATE
+ #include "Fate.h"
+#endif
+
+#ifndef SUMMARY
+ #include "Summary.h"
+#endif
+
+#ifndef STATS
+ #include "Stats.h"
+#endif
+
+#define AHEAD  8           /* Trajectories a thread, past the first not joined */
+
+short           Stats=0;
+
+static pthread_mutex_t Lock=PTHREAD_MUTEX_INITIALIZER;
+static BYTES   *Pending=NULL;     /* Rows of the runs done, by trajectory */
+static char    *Done=NULL;
+static int      NJoined=0;        /* Runs 0..NJoined-1 are in the statistics */
+static int      Budget;
+
+/*
+ * Take statistics of the ensemble of n trajectories; quantiles is a
+ * comma separated list of the quantiles to estimate, and bins the
+ * bins of the histograms (none if 0)
+ */
+void SetupStats(quantiles,bins,n)
+char *quantiles;
+int bins,n;
+{
+  int c,columns;
+  char *whole;
+
+  int SampleColumns();
+
+  /* Time, NR, RPQ, the species, Volume and the rest; all but 3 counts */
+  columns= 4+SampleColumns();
+  whole= (char *) rcalloc(columns,sizeof(char),"SetupStats");
+  for(c=0; c<columns; c++)
+    whole[c]= (c!=0 && c!=2 && c!=3+NSpecies);
+  SetupSummary(columns,whole,quantiles,bins);
+  free(whole);
+
+  void WindowEnsemble();
+
+  Stats= 1;
+  Budget= n;
+  WindowEnsemble(AHEAD);
+  Pending= (BYTES *) rcalloc(n+1,sizeof(BYTES),"SetupStats");
+  Done=    (char *)  rcalloc(n+1,sizeof(char),"SetupStats");
+}
+
+/* Add the rows of a run, packed in rows, to the statistics */
+static void JoinRun(rows)
+BYTES *rows;
+{
+  int i,j,n,columns;
+  double *x;
+  SAMPLE row;
+
+  int SampleColumns();
+
+  columns= SampleColumns();
+  row.Value= (int *) rcalloc(columns+1,sizeof(int),"JoinRun");
+  x= (double *) rcalloc(4+columns,sizeof(double),"JoinRun");
+
+  n= (int) (rows->N/ROWBYTES(columns));
+  for(i=0; i<n; i++){
+    UnpackRow(rows->Data+(size_t) i*ROWBYTES(columns),&row,columns);
+    x[0]= row.Time;
+    x[1]= row.NR;
+    x[2]= row.RPQ;
+    for(j=0; j<NSpecies; j++)
+      x[3+j]= row.Value[j];
+    x[3+NSpecies]= row.Volume;
+    for(; j<columns; j++)
+      x[4+j]= row.Value[j];
+    AddSummaryRow(i,x);
+  }
+
+  free(x);
+  free(row.Value);
+}
+
+/* Add the current run, trajectory k, to the statistics */
+void AddStatsRun(k)
+int k;
+{
+  int columns;
+
+  int SampleColumns();
+  int EnsembleLimit();
+  void JoinedEnsemble();
+
+  /* The row at which a stop condition decided the fate is left out */
+  columns= SampleColumns();
+  if(NStops>0 && Sim->Fate>=0 && Sim->Kept.N>=ROWBYTES(columns))
+    Sim->Kept.N -= ROWBYTES(columns);
+
+  pthread_mutex_lock(&Lock);
+  Pending[k]= Sim->Kept;
+  Done[k]= 1;
+  Sim->Kept.Data= NULL;
+  Sim->Kept.N= Sim->Kept.Max= 0;
+
+  /* Join the runs in order, up to the first that is still going */
+  while(NJoined<EnsembleLimit() && Done[NJoined]){
+    JoinRun(&Pending[NJoined]);
+    free(Pending[NJoined].Data);
+    Pending[NJoined++].Data= NULL;
+  }
+  JoinedEnsemble(NJoined);
+  pthread_mutex_unlock(&Lock);
+}
+
+/* Column headings of the output, on fp */
+static void StatsHeader(fp)
+FILE *fp;
+{
+  FILE *out;
+
+  void WriteHeader();
+
+  out= Sim->Output;
+  Sim->Output= fp;
+  WriteHeader();
+  Sim->Output= out;
+}
+
+/*
+ * Write the statistics to files name.STAT (see WriteSummary()), with
+ * the header of an output if header, and free them
+ */
+void WriteStats(name,header)
+char *name;
+int header;
+{
+  int i,n;
+
+  n= WriteSummary(name,(header ? StatsHeader : NULL));
+  if (DebugLevel > 1)
+    fprintf(logfp,"Statistics of %d trajectories\n",n);
+
+  for(i=NJoined; i<Budget; i++)
+    free(Pending[i].Data);
+  free(Pending);
+  free(Done);
+}
@@ -0,0 +1,11 @@
+/**********************
+ *
+ * Ensemble statistics, taken as the trajectories are run (see Stats.c)
+ *
+ **********************/
+#define STATS
+
+extern short Stats;
+extern void  SetupStats(char *, int, int);
+extern void  AddStatsRun(int);
+extern void  WriteStats(char *, int);
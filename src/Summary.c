@@ -0,0 +1,362 @@
+/**************************
+ *
+ * Statistics of the columns of many runs, time by time.
+ *
+ * The rows of the runs are added one at a time, row i of each run to
+ * the statistics at the i-th time, and they are never kept.  At each
+ * time there are, for every column,
+ *
+ *   the number of runs that got that far
+ *   the mean and variance, by Welford's update
+ *   the least and greatest value
+ *   quantiles, by the P-square estimate of Jain and Chlamtac, which
+ *     keeps five markers rather than the values
+ *   a histogram of a fixed number of bins from 0; the bins start 1
+ *     wide (DOUBLEWIDTH for columns that aren't whole numbers) and
+ *     double in width as a value falls past the last
+ *
+ * and they are written to files shaped like the output of a run, one
+ * a statistic (see WriteSummary()).  The statistics of the same rows
+ * added in the same order are the same to the bit; the callers, the
+ * ensembles of the simulator (see Stats.c) and simulac-reduce (see
+ * Reduce.c), add their runs in order.  Nothing here is locked.
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#ifndef _H_MATH
+   #include <math.h>
+#endif
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef SUMMARY
+ #include "Summary.h"
+#endif
+
+#define MAXQUANTILES  16
+#define DOUBLEWIDTH   (1.0/1024)
+
+typedef struct p2 P2;
+typedef struct statrow STATROW;
+
+struct p2 {                 /* The P-square estimate of a quantile */
+  double  Q[5];             /* Heights of the markers; the values, sorted, */
+  double  N[5];             /*   while there are fewer than 5 */
+  double  NP[5];            /* Positions of the markers, and where they */
+};                          /*   should be */
+
+struct statrow {            /* Statistics of the columns at one time */
+  double  Time;
+  int     N;                /* Runs in them */
+  double *Mean,*M2,*Min,*Max;
+  P2     *Quant;            /* By column, then quantile */
+  double *Width;            /* Of the bins of a column */
+  int    *Bin;              /* By column, then bin */
+};
+
+static int      NCols;            /* The first is the time */
+static char    *Whole;            /* Columns of whole numbers */
+static int      NQuant;
+static double   Quantile[MAXQUANTILES];
+static int      NBins;
+
+static STATROW *Row=NULL;
+static int      NRows=0;
+static int      NRuns=0;
+
+/*
+ * Take statistics of columns columns, whole[c] TRUE if column c is
+ * whole numbers; quantiles is a comma separated list of the quantiles
+ * to estimate, and bins the bins of the histograms (none if 0)
+ */
+void SetupSummary(columns,whole,quantiles,bins)
+int columns;
+char *whole,*quantiles;
+int bins;
+{
+  char *p,*end;
+
+  NCols= columns;
+  Whole= (char *) rcalloc(NCols+1,sizeof(char),"SetupSummary");
+  memcpy(Whole,whole,NCols);
+  NBins= (bins > 0 ? bins : 0);
+
+  NQuant= 0;
+  for(p=quantiles; *p!='\0'; p=end+(*end==',')){
+    if(NQuant==MAXQUANTILES){
+      fprintf(stderr,"%s: at most %d quantiles\n",progid,MAXQUANTILES);
+      exit(1);
+    }
+    Quantile[NQuant]= strtod(p,&end);
+    if(end==p || (*end!=',' && *end!='\0') ||
+       Quantile[NQuant]<=0.0 || Quantile[NQuant]>=1.0){
+      fprintf(stderr,"%s: quantiles are between 0 and 1, not '%s'\n",
+	      progid,quantiles);
+      exit(1);
+    }
+    NQuant++;
+  }
+}
+
+static STATROW *NewRow(t)
+double t;
+{
+  int c,b;
+  STATROW *r;
+
+  Row= (STATROW *) rrealloc(Row,NRows+1,sizeof(STATROW),"NewRow");
+  r= &Row[NRows++];
+  r->Time=  t;
+  r->N=     0;
+  r->Mean=  (double *) rcalloc(NCols,sizeof(double),"NewRow");
+  r->M2=    (double *) rcalloc(NCols,sizeof(double),"NewRow");
+  r->Min=   (double *) rcalloc(NCols,sizeof(double),"NewRow");
+  r->Max=   (double *) rcalloc(NCols,sizeof(double),"NewRow");
+  r->Quant= (P2 *)     rcalloc(NCols*NQuant+1,sizeof(P2),"NewRow");
+  r->Width= (double *) rcalloc(NCols,sizeof(double),"NewRow");
+  r->Bin=   (int *)    rcalloc(NCols*NBins+1,sizeof(int),"NewRow");
+  for(c=0; c<NCols; c++){
+    r->Width[c]= (Whole[c] ? 1.0 : DOUBLEWIDTH);
+    for(b=0; b<NQuant; b++){
+      r->Quant[c*NQuant+b].NP[1]= 1.0+2.0*Quantile[b];
+      r->Quant[c*NQuant+b].NP[2]= 1.0+4.0*Quantile[b];
+      r->Quant[c*NQuant+b].NP[3]= 3.0+2.0*Quantile[b];
+    }
+  }
+  return(r);
+}
+
+/* Add x, the n-th value (from 0), to the estimate q of quantile p */
+static void AddQuantile(q,p,x,n)
+P2 *q;
+double p,x;
+int n;
+{
+  int i,k,s;
+  double d,h;
+
+  if(n<5){
+    for(i=n; i>0 && q->Q[i-1]>x; i--) q->Q[i]= q->Q[i-1];
+    q->Q[i]= x;
+    if(n==4)
+      for(i=0; i<5; i++){
+	q->N[i]= i+1;
+	if(i==0 || i==4) q->NP[i]= i+1;
+      }
+    return;
+  }
+
+  /* The cell of x, stretched to hold it at either end */
+  if(x<q->Q[0]){
+    q->Q[0]= x;
+    k= 0;
+  }
+  else if(x>=q->Q[4]){
+    q->Q[4]= x;
+    k= 3;
+  }
+  else
+    for(k=0; x>=q->Q[k+1]; k++);
+
+  for(i=k+1; i<5; i++) q->N[i] += 1.0;
+  q->NP[1] += p/2.0;
+  q->NP[2] += p;
+  q->NP[3] += (1.0+p)/2.0;
+  q->NP[4] += 1.0;
+
+  /* Move the middle markers toward where they should be */
+  for(i=1; i<4; i++){
+    d= q->NP[i]-q->N[i];
+    if((d>=1.0 && q->N[i+1]-q->N[i]>1.0) || (d<=-1.0 && q->N[i-1]-q->N[i]<-1.0)){
+      s= (d>0.0 ? 1 : -1);
+      h= q->Q[i]+s/(q->N[i+1]-q->N[i-1])*
+	((q->N[i]-q->N[i-1]+s)*(q->Q[i+1]-q->Q[i])/(q->N[i+1]-q->N[i])+
+	 (q->N[i+1]-q->N[i]-s)*(q->Q[i]-q->Q[i-1])/(q->N[i]-q->N[i-1]));
+      if(h<=q->Q[i-1] || h>=q->Q[i+1])
+	h= q->Q[i]+s*(q->Q[i+s]-q->Q[i])/(q->N[i+s]-q->N[i]);
+      q->Q[i]= h;
+      q->N[i] += s;
+    }
+  }
+}
+
+/* Estimate of quantile p from q, of n values */
+static double GetQuantile(q,p,n)
+P2 *q;
+double p;
+int n;
+{
+  if(n>=5) return(q->Q[2]);
+  return(q->Q[(int) floor(p*(n-1)+0.5)]);
+}
+
+/* Add x to the histogram bin[] of bins of width *width */
+static void AddBin(bin,width,x)
+int *bin;
+double *width,x;
+{
+  int b;
+
+  while(x>=NBins*(*width)){
+    for(b=0; b<NBins; b++)
+      bin[b]= (2*b<NBins ? bin[2*b] : 0)+(2*b+1<NBins ? bin[2*b+1] : 0);
+    *width *= 2.0;
+  }
+  b= (x>0.0 ? (int) (x/(*width)) : 0);
+  bin[b]++;
+}
+
+/* Add x[], row i of a run (from 0), to the statistics; x[0] is its time */
+void AddSummaryRow(i,x)
+int i;
+double *x;
+{
+  int c,b,n;
+  double delta;
+  STATROW *r;
+
+  r= (i<NRows ? &Row[i] : NewRow(x[0]));
+  n= r->N++;
+  if(i==0) NRuns++;
+  for(c=0; c<NCols; c++){
+    delta= x[c]-r->Mean[c];
+    r->Mean[c] += delta/r->N;
+    r->M2[c] += delta*(x[c]-r->Mean[c]);
+    if(n==0 || x[c]<r->Min[c]) r->Min[c]= x[c];
+    if(n==0 || x[c]>r->Max[c]) r->Max[c]= x[c];
+    for(b=0; b<NQuant; b++)
+      AddQuantile(&r->Quant[c*NQuant+b],Quantile[b],x[c],n);
+    if(NBins>0)
+      AddBin(&r->Bin[c*NBins],&r->Width[c],x[c]);
+  }
+}
+
+/* Open the file of statistic stat for the statistics of name */
+static FILE *OpenSummary(name,stat)
+char *name,*stat;
+{
+  char *file;
+  FILE *fp;
+
+  file= (char *) rcalloc(strlen(name)+strlen(stat)+2,sizeof(char),"OpenSummary");
+  sprintf(file,"%s.%s",name,stat);
+  if((fp=fopen(file,"w"))==NULL){
+    perror(file);
+    exit(1);
+  }
+  free(file);
+  return(fp);
+}
+
+/* Print a row of statistic stat (see WriteSummary()) for r on fp */
+static void PrintSummary(fp,r,stat)
+FILE *fp;
+STATROW *r;
+int stat;
+{
+  int c;
+  double x;
+
+  fprintf(fp,"%e\t",r->Time);
+  for(c=1; c<NCols; c++){
+    switch(stat){
+    case 0:  x= r->Mean[c];  break;
+    case 1:  x= (r->N>1 ? r->M2[c]/(r->N-1) : 0.0);  break;
+    case 2:  x= r->Min[c];  break;
+    case 3:  x= r->Max[c];  break;
+    default: x= GetQuantile(&r->Quant[c*NQuant+stat-4],Quantile[stat-4],r->N);
+    }
+    fprintf(fp,"%e\t",x);
+  }
+  fprintf(fp,"\n");
+}
+
+/*
+ * Write the statistics to files name.STAT, each starting with the
+ * column headings header() prints, if header isn't NULL: STAT is mean,
+ * var (the sample variance), min, max and qP for the quantiles, P in
+ * percent (q50 for the median).  Their first column is the time, and
+ * the others are the statistic of the column.  name.n has the time
+ * and the number of runs at it, and name.hist the histograms, a line
+ * for each column at each time:
+ *
+ *   TIME COLUMN WIDTH COUNT...
+ *
+ * with the columns from 0, for the time.  Returns the number of runs;
+ * the statistics are freed.
+ */
+int WriteSummary(name,header)
+char *name;
+void (*header)();
+{
+  int i,c,b,stat,n;
+  char suffix[32];
+  FILE *fp;
+
+  for(stat=0; stat<4+NQuant; stat++){
+    if(stat<4)
+      strcpy(suffix,(stat==0 ? "mean" : stat==1 ? "var" : stat==2 ? "min" : "max"));
+    else
+      sprintf(suffix,"q%g",100.0*Quantile[stat-4]);
+    fp= OpenSummary(name,suffix);
+    if(header!=NULL) (*header)(fp);
+    for(i=0; i<NRows; i++)
+      PrintSummary(fp,&Row[i],stat);
+    fclose(fp);
+  }
+
+  fp= OpenSummary(name,"n");
+  for(i=0; i<NRows; i++)
+    fprintf(fp,"%e\t%d\n",Row[i].Time,Row[i].N);
+  fclose(fp);
+
+  if(NBins>0){
+    fp= OpenSummary(name,"hist");
+    fprintf(fp,"%% Time\tColumn\tWidth\tCounts from 0, in bins that double in"
+	    " width as values outgrow them\n");
+    for(i=0; i<NRows; i++)
+      for(c=0; c<NCols; c++){
+	fprintf(fp,"%e\t%d\t%e",Row[i].Time,c,Row[i].Width[c]);
+	for(b=0; b<NBins; b++)
+	  fprintf(fp,"\t%d",Row[i].Bin[c*NBins+b]);
+	fprintf(fp,"\n");
+      }
+    fclose(fp);
+  }
+
+  for(i=0; i<NRows; i++){
+    free(Row[i].Mean);  free(Row[i].M2);
+    free(Row[i].Min);   free(Row[i].Max);
+    free(Row[i].Quant); free(Row[i].Width);
+    free(Row[i].Bin);
+  }
+  free(Row);
+  free(Whole);
+  Row= NULL;
+  NRows= 0;
+  n= NRuns;
+  NRuns= 0;
+  return(n);
+}
@@ -0,0 +1,10 @@
+/**********************
+ *
+ * Statistics of the columns of many runs, time by time (see Summary.c)
+ *
+ **********************/
+#define SUMMARY
+
+extern void SetupSummary(int, char *, char *, int);
+extern void AddSummaryRow(int, double *);
+extern int  WriteSummary(char *, void (*)());
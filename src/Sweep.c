@@ -0,0 +1,399 @@
+/**************************
+ *
+ * Parameter sweeps.
+ *
+ * A sweep is given by axes, each a quantity and its values:
+ *
+ *   volume VALUES         initial cell volume, as --volume
+ *   growth VALUES         cell growth rate, as --growth
+ *   moi VALUES            multiplicity of infection, as --moi
+ *   rate kN VALUES        probability of reaction N, as --rate
+ *   init NAME VALUES      initial count of species NAME, as --init
+ *   param NAME VALUES     the %NAME parameter of the outline, as --param
+ *
+ * VALUES is either a list "v1 v2 ..." or a range "from:to:n" of n
+ * evenly spaced values.  The points of the sweep are all the
+ * combinations of the values of the axes (the last axis varies
+ * fastest), or with --sweep-list the first values of every axis,
+ * the second values, and so on.
+ *
+ * The outline is read once.  The places each %name parameter went
+ * to are recorded as it is read (BindParam()), so that a point can
+ * give them other values in a context of its own (ApplySweepPoint())
+ * without reading any file again.  Parameters of the sequence data
+ * files are read into the templates, which all contexts share, and
+ * can't be swept.
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef SWEEP
+ #include "Sweep.h"
+#endif
+
+#define SWEEP_VOLUME 0
+#define SWEEP_GROWTH 1
+#define SWEEP_MOI    2
+#define SWEEP_RATE   3
+#define SWEEP_INIT   4
+#define SWEEP_PARAM  5
+
+typedef struct parambinding PARAMBINDING;
+typedef struct sweepaxis    SWEEPAXIS;
+
+struct parambinding {
+  char   *Name;
+  int     Kind;         /* PARAM_RATE, ... */
+  int     Index;
+  double  Scale;
+};
+
+struct sweepaxis {
+  int     Kind;         /* SWEEP_VOLUME, ... */
+  int     Index;        /* Reaction or species */
+  char   *Label;        /* Column of the run index */
+  int     NValues;
+  double *Value;
+};
+
+static int           NBindings=0;
+static PARAMBINDING *Binding=NULL;
+
+static int           NAxes=0;
+static SWEEPAXIS    *Axis=NULL;
+static int           NPoints=0;
+static short         ListMode=0,ScaleInit=0;
+
+static double      **PointRates=NULL;   /* Reaction probabilities of every point, if swept */
+
+/* Record that value (a token of the outline) was used as given by kind and index */
+void BindParam(value,kind,index,scale)
+char *value;
+int kind,index;
+double scale;
+{
+  char name[80];
+
+  if(value[0]!='%' || sscanf(value,"%%%79[^:]",name)!=1) return;
+
+  Binding= (PARAMBINDING *) rrealloc(Binding,NBindings+1,sizeof(PARAMBINDING),"BindParam");
+  Binding[NBindings].Name= (char *) rcalloc(strlen(name)+1,sizeof(char),"BindParam");
+  strcpy(Binding[NBindings].Name,name);
+  Binding[NBindings].Kind=  kind;
+  Binding[NBindings].Index= index;
+  Binding[NBindings].Scale= scale;
+  NBindings++;
+
+  DEBUG(2) fprintf(logfp,"@@@ Parameter %s bound as %d/%d\n",name,kind,index);
+}
+
+/* Value of axis a at point p */
+static double AxisValue(a,p)
+int a,p;
+{
+  int b;
+
+  if(!ListMode)
+    for(b=NAxes-1; b>a; b--) p /= Axis[b].NValues;
+  return(Axis[a].Value[p%Axis[a].NValues]);
+}
+
+/* Read the values of an axis from the words of its specification */
+static void ReadAxisValues(axis,nwords,word,spec)
+SWEEPAXIS *axis;
+int nwords;
+char **word,*spec;
+{
+  int i,n;
+  double from,to;
+  char *end,c;
+
+  if(nwords==1 && sscanf(word[0],"%lf:%lf:%d%c",&from,&to,&n,&c)==3){
+    if(n<1){
+      fprintf(stderr,"%s: empty range in sweep '%s'\n",progid,spec);
+      exit(-1);
+    }
+    axis->NValues= n;
+    axis->Value= (double *) rcalloc(n,sizeof(double),"ReadAxisValues");
+    for(i=0; i<n; i++)
+      axis->Value[i]= (n==1 ? from : from+i*(to-from)/(n-1));
+    return;
+  }
+
+  if(nwords<1){
+    fprintf(stderr,"%s: no values in sweep '%s'\n",progid,spec);
+    exit(-1);
+  }
+  axis->NValues= nwords;
+  axis->Value= (double *) rcalloc(nwords,sizeof(double),"ReadAxisValues");
+  for(i=0; i<nwords; i++){
+    axis->Value[i]= strtod(word[i],&end);
+    if(end==word[i] || *end!='\0'){
+      fprintf(stderr,"%s: bad value '%s' in sweep '%s'\n",progid,word[i],spec);
+      exit(-1);
+    }
+  }
+}
+
+/*
+ * Read the axes of a sweep, from the nspecs strings spec[] (after the
+ * outline and the common options); list is --sweep-list and scaleinit
+ * --scale-init.
+ */
+void SetupSweep(nspecs,spec,list,scaleinit)
+int nspecs;
+char **spec;
+int list,scaleinit;
+{
+  int a,b,i,p,nwords,nbound,fixed;
+  char *copy,*w,*save,**word;
+  SWEEPAXIS *axis;
+
+  int FindSpecies();
+
+  ListMode=  list;
+  ScaleInit= scaleinit;
+  NAxes=     nspecs;
+  Axis=      (SWEEPAXIS *) rcalloc(NAxes,sizeof(SWEEPAXIS),"SetupSweep.1");
+
+  for(a=0; a<NAxes; a++){
+    axis= &Axis[a];
+
+    copy= (char *) rcalloc(strlen(spec[a])+1,sizeof(char),"SetupSweep.2");
+    strcpy(copy,spec[a]);
+    word= (char **) rcalloc(strlen(spec[a])+1,sizeof(char *),"SetupSweep.3");
+    nwords= 0;
+    for(w=strtok_r(copy," \t",&save); w!=NULL; w=strtok_r(NULL," \t",&save))
+      word[nwords++]= w;
+
+    if(nwords<2){
+      fprintf(stderr,"%s: can't parse sweep '%s'\n",progid,spec[a]);
+      exit(-1);
+    }
+
+    if(strcmp(word[0],"volume")==0)      axis->Kind= SWEEP_VOLUME;
+    else if(strcmp(word[0],"growth")==0) axis->Kind= SWEEP_GROWTH;
+    else if(strcmp(word[0],"moi")==0)    axis->Kind= SWEEP_MOI;
+    else if(strcmp(word[0],"rate")==0)   axis->Kind= SWEEP_RATE;
+    else if(strcmp(word[0],"init")==0)   axis->Kind= SWEEP_INIT;
+    else if(strcmp(word[0],"param")==0)  axis->Kind= SWEEP_PARAM;
+    else {
+      fprintf(stderr,"%s: unknown quantity %s in sweep '%s'\n",progid,word[0],spec[a]);
+      exit(-1);
+    }
+
+    axis->Label= (char *) rcalloc(strlen(spec[a])+2,sizeof(char),"SetupSweep.4");
+    switch(axis->Kind){
+    case SWEEP_VOLUME:
+    case SWEEP_GROWTH:
+    case SWEEP_MOI:
+      strcpy(axis->Label,word[0]);
+      ReadAxisValues(axis,nwords-1,&word[1],spec[a]);
+      break;
+
+    case SWEEP_RATE:
+      if(nwords<3 || sscanf(word[1],"k%d",&axis->Index)!=1 ||
+	 axis->Index<0 || axis->Index>=NMassAction){
+	fprintf(stderr,"%s: no reaction %s for sweep '%s'\n",progid,word[1],spec[a]);
+	exit(-1);
+      }
+      strcpy(axis->Label,word[1]);
+      ReadAxisValues(axis,nwords-2,&word[2],spec[a]);
+      break;
+
+    case SWEEP_INIT:
+      if(nwords<3 || (axis->Index=FindSpecies(word[1]))==NSpecies){
+	fprintf(stderr,"%s: no species %s for sweep '%s'\n",progid,word[1],spec[a]);
+	exit(-1);
+      }
+      strcpy(axis->Label,word[1]);
+      ReadAxisValues(axis,nwords-2,&word[2],spec[a]);
+      break;
+
+    case SWEEP_PARAM:
+      sprintf(axis->Label,"%%%s",(nwords>2 ? word[1] : ""));
+      nbound= fixed= 0;
+      for(b=0; b<NBindings; b++)
+	if(strcmp(Binding[b].Name,&axis->Label[1])==0){
+	  nbound++;
+	  if(Binding[b].Kind==PARAM_FIXED) fixed++;
+	}
+      if(nwords<3 || nbound==0){
+	fprintf(stderr,"%s: the outline has no parameter %s for sweep '%s'\n",
+		progid,axis->Label,spec[a]);
+	exit(-1);
+      }
+      if(fixed>0){
+	fprintf(stderr,"%s: parameter %s is sequence data, which can't be swept; use --param\n",
+		progid,axis->Label);
+	exit(-1);
+      }
+      ReadAxisValues(axis,nwords-2,&word[2],spec[a]);
+      break;
+    }
+
+    free(word);
+    free(copy);
+  }
+
+  /* Points */
+  NPoints= 1;
+  for(a=0; a<NAxes; a++){
+    if(ListMode && Axis[a].NValues!=Axis[0].NValues){
+      fprintf(stderr,"%s: the axes of a --sweep-list must have as many values each\n",progid);
+      exit(-1);
+    }
+    NPoints= (ListMode ? Axis[a].NValues : NPoints*Axis[a].NValues);
+  }
+
+  /* Reaction probabilities, made once for every point if they change */
+  for(a=0; a<NAxes; a++){
+    if(Axis[a].Kind==SWEEP_RATE) break;
+    if(Axis[a].Kind==SWEEP_PARAM){
+      for(b=0; b<NBindings; b++)
+	if(Binding[b].Kind==PARAM_RATE && strcmp(Binding[b].Name,&Axis[a].Label[1])==0) break;
+      if(b<NBindings) break;
+    }
+  }
+  if(a==NAxes) return;
+
+  PointRates= (double **) rcalloc(NPoints,sizeof(double *),"SetupSweep.5");
+  for(p=0; p<NPoints; p++){
+    PointRates[p]= (double *) rcalloc(NMassAction+1,sizeof(double),"SetupSweep.6");
+    for(i=0; i<NMassAction; i++) PointRates[p][i]= ReactionProbability[i];
+
+    for(a=0; a<NAxes; a++){
+      if(Axis[a].Kind==SWEEP_RATE)           /* A float, as --rate is read */
+	PointRates[p][Axis[a].Index]= (float) AxisValue(a,p);
+      else if(Axis[a].Kind==SWEEP_PARAM)
+	for(b=0; b<NBindings; b++)
+	  if(Binding[b].Kind==PARAM_RATE && strcmp(Binding[b].Name,&Axis[a].Label[1])==0)
+	    PointRates[p][Binding[b].Index]= AxisValue(a,p)*Binding[b].Scale;
+    }
+  }
+}
+
+int NSweepPoints()
+{
+  return(NPoints);
+}
+
+/* Set the copies of a sequence in a context that has not run yet */
+static void SetCopies(tmpl,n)
+SEQTEMPLATE *tmpl;
+int n;
+{
+  SEQUENCE *AddSequenceCopy();
+  short RemoveSequenceCopy();
+
+  while(SEQ_COPIES(tmpl)->NCopies<n)
+    AddSequenceCopy(tmpl);
+  while(SEQ_COPIES(tmpl)->NCopies>n)
+    RemoveSequenceCopy(tmpl);
+}
+
+/*
+ * Give the current context the values of point p.  They are applied
+ * in the order main() applies the options, and replace those of the
+ * options: parameters of the outline, then the volume (scaling the
+ * counts with --scale-init) and growth rate, then the counts and MOI.
+ */
+void ApplySweepPoint(p)
+int p;
+{
+  int a,b,i,moi;
+  double v;
+  float f;
+
+  if(PointRates!=NULL) Sim->Rates= PointRates[p];
+
+  for(a=0; a<NAxes; a++){
+    if(Axis[a].Kind!=SWEEP_PARAM) continue;
+    v= AxisValue(a,p);
+    for(b=0; b<NBindings; b++){
+      if(strcmp(Binding[b].Name,&Axis[a].Label[1])!=0) continue;
+      if(Binding[b].Kind==PARAM_INIT)
+	Sim->Concentration[Binding[b].Index]= (int) v;
+      else if(Binding[b].Kind==PARAM_MOI)
+	SetCopies(SeqTemplate[Binding[b].Index],(int) v);
+    }
+  }
+
+  /* Floats, as --volume and --growth are read */
+  for(a=0; a<NAxes; a++){
+    f= (float) AxisValue(a,p);
+    if(Axis[a].Kind==SWEEP_VOLUME){
+      Sim->EColi->V  *= f;
+      Sim->EColi->VI *= f;
+      if(ScaleInit)
+	for(i=0; i<NSpecies; i++) Sim->Concentration[i] *= f;
+    }
+    else if(Axis[a].Kind==SWEEP_GROWTH)
+      Sim->EColi->GrowthRate *= f;
+  }
+
+  for(a=0; a<NAxes; a++){
+    v= AxisValue(a,p);
+    if(Axis[a].Kind==SWEEP_INIT)
+      Sim->Concentration[Axis[a].Index]= (int) v;
+    else if(Axis[a].Kind==SWEEP_MOI){
+      moi= (int) v;
+      for(i=0; i<NSeqTemplates; i++)
+	if(SeqTemplate[i]->FollowsMOI) SetCopies(SeqTemplate[i],moi);
+    }
+  }
+}
+
+/*
+ * Write the index of the runs of the sweep to file: run k of the
+ * ensemble, written to output.k, is trial k%trials of point
+ * k/trials.
+ */
+void WriteSweepIndex(file,output,trials)
+char *file,*output;
+int trials;
+{
+  int a,p,t;
+  FILE *fp;
+
+  if((fp=fopen(file,"w"))==NULL){
+    perror(file);
+    exit(1);
+  }
+
+  fprintf(fp,"%% run\tpoint\ttrial\tfile");
+  for(a=0; a<NAxes; a++) fprintf(fp,"\t%s",Axis[a].Label);
+  fprintf(fp,"\n");
+
+  for(p=0; p<NPoints; p++)
+    for(t=0; t<trials; t++){
+      fprintf(fp,"%d\t%d\t%d\t%s.%d",p*trials+t,p,t,output,p*trials+t);
+      for(a=0; a<NAxes; a++) fprintf(fp,"\t%g",AxisValue(a,p));
+      fprintf(fp,"\n");
+    }
+
+  fclose(fp);
+}
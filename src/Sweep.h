@@ -0,0 +1,18 @@
+/**********************
+ *
+ * Parameter sweeps: many points from one parse (see Sweep.c)
+ *
+ **********************/
+#define SWEEP
+
+/* Where a %name parameter of the outline was used */
+#define PARAM_RATE   0    /* Probability of reaction Index, times Scale */
+#define PARAM_INIT   1    /* Initial count of species Index */
+#define PARAM_MOI    2    /* Copies of SeqTemplate[Index] */
+#define PARAM_FIXED  3    /* Sequence data, read into the templates */
+
+extern void BindParam(char *, int, int, double);
+extern void SetupSweep(int, char **, int, int);
+extern int  NSweepPoints();
+extern void ApplySweepPoint(int);
+extern void WriteSweepIndex(char *, char *, int);
@@ -0,0 +1,213 @@
+/**************************
+ *
+ * Adaptive ensembles.
+ *
+ * With --target=STAT and --half-width=H an ensemble runs trajectories
+ * only until the 95% confidence interval of STAT is within +-H, or
+ * until the --ensemble trajectories it may run are spent.  STAT is
+ *
+ *   fate:FATE     the fraction of runs that end with FATE (see Fate.c)
+ *   NAME@T        the mean count of species NAME at time T
+ *   NAME/V@T      the mean of its count over the cell volume at time T
+ *
+ * The value of a run at T is that of its first row at or after T, or
+ * of its last row if it ends before T.  A fraction has the Wilson
+ * score interval, which keeps its width at 0 and 1; a mean has the
+ * normal interval of its standard error.  Nothing is decided on
+ * fewer than MINTRIALS runs.
+ *
+ * Trajectories are handed out in order (see LimitEnsemble()), and the
+ * interval is taken as each is joined to the ones before it: the
+ * ensemble is the first n that meet the target however the threads
+ * went through them, so it is what one thread would have run.  The
+ * trajectories past n that were started meanwhile are left out.
+ *
+ **************************/
+
+/****************************/
+/******* Includes ***********/
+/****************************/
+
+#ifndef _H_STDIO
+   #include <stdio.h>
+#endif
+
+#ifndef _H_STDLIB
+   #include <stdlib.h>
+#endif
+
+#ifndef _H_STRING
+   #include <string.h>
+#endif
+
+#ifndef _H_MATH
+   #include <math.h>
+#endif
+
+#include <pthread.h>
+
+#ifndef DataStructures
+   #include "DataStructures.h"
+#endif
+
+#ifndef UTILS
+ #include "Util.h"
+#endif
+
+#ifndef FATE
+ #include "Fate.h"
+#endif
+
+#ifndef TARGET
+ #include "Target.h"
+#endif
+
+#define MINTRIALS  10
+#define Z95        1.959964
+
+int           Adaptive=0;
+
+static char  *TargetFate=NULL;    /* A fraction of runs with this fate, */
+static int    TargetSpecies;      /* or the mean of this species */
+static short  TargetConc;         /* over the volume */
+static double TargetTime;         /* at this time */
+static double HalfWidth;
+static int    Budget;
+
+static pthread_mutex_t Lock=PTHREAD_MUTEX_INITIALIZER;
+static double *Value=NULL;        /* Of the runs done, by trajectory */
+static char   *Done=NULL;
+static int     NJoined=0;         /* Runs 0..NJoined-1 are in the statistic */
+static int     Decided=0;         /* Runs the target was met with */
+static double  Mean=0.0,M2=0.0;
+
+/* Read STAT, to be within +-halfwidth in at most budget runs */
+void SetupTarget(stat,halfwidth,budget)
+char *stat;
+double halfwidth;
+int budget;
+{
+  int i;
+  char *name,*at,*slash,*end;
+
+  int FindSpecies();
+
+  Adaptive=  1;
+  HalfWidth= halfwidth;
+  Budget=    budget;
+  Value= (double *) rcalloc(Budget+1,sizeof(double),"SetupTarget");
+  Done=  (char *)   rcalloc(Budget+1,sizeof(char),"SetupTarget");
+
+  name= (char *) rcalloc(strlen(stat)+1,sizeof(char),"SetupTarget");
+  strcpy(name,stat);
+
+  if(strncmp(name,"fate:",5)==0){
+    TargetFate= name+5;
+    for(i=0; i<NStops && strcmp(FateName(i),TargetFate)!=0; i++);
+    if(i==NStops){
+      fprintf(stderr,"%s: no --stop decides the fate '%s' of --target\n",progid,TargetFate);
+      exit(1);
+    }
+    return;
+  }
+
+  if((at=strrchr(name,'@'))==NULL){
+    fprintf(stderr,"%s: --target is fate:FATE, NAME@T or NAME/V@T, not '%s'\n",progid,stat);
+    exit(1);
+  }
+  *at++= '\0';
+  TargetTime= strtod(at,&end);
+  if(end==at || *end!='\0'){
+    fprintf(stderr,"%s: bad time in --target '%s'\n",progid,stat);
+    exit(1);
+  }
+  if((slash=strrchr(name,'/'))!=NULL && strcmp(slash,"/V")==0){
+    TargetConc= 1;
+    *slash= '\0';
+  }
+  if((TargetSpecies=FindSpecies(name))<0 || TargetSpecies==NSpecies){
+    fprintf(stderr,"%s: no species '%s' for --target '%s'\n",progid,name,stat);
+    exit(1);
+  }
+  free(name);
+}
+
+/* Take the value of the current run from row, a row of its output */
+void TakeTarget(row)
+SAMPLE *row;
+{
+  if(TargetFate!=NULL || Sim->TargetTaken) return;
+
+  Sim->TargetValue= row->Value[TargetSpecies];
+  if(TargetConc) Sim->TargetValue /= row->Volume;
+  if(row->Time>=TargetTime) Sim->TargetTaken= 1;
+}
+
+/* Half width of the interval of the first n runs */
+static double Width(n)
+int n;
+{
+  double z2;
+
+  if(TargetFate!=NULL){
+    z2= Z95*Z95;
+    return(Z95*sqrt(Mean*(1.0-Mean)/n+z2/(4.0*n*n))/(1.0+z2/n));
+  }
+  return(n>1 ? Z95*sqrt(M2/(n-1)/n) : HUGE_VAL);
+}
+
+/* Add the current run, trajectory k, to the ensemble */
+void AddTargetRun(k)
+int k;
+{
+  double x,delta;
+
+  void LimitEnsemble();
+
+  if(TargetFate!=NULL)
+    x= (Sim->Fate>=0 && strcmp(FateName(Sim->Fate),TargetFate)==0);
+  else
+    x= Sim->TargetValue;
+
+  pthread_mutex_lock(&Lock);
+  Value[k]= x;
+  Done[k]= 1;
+
+  /* Join the runs in order, up to the first that is still going */
+  while(!Decided && NJoined<Budget && Done[NJoined]){
+    x= Value[NJoined++];
+    delta= x-Mean;
+    Mean += delta/NJoined;
+    M2 += delta*(x-Mean);
+
+    if(NJoined>=MINTRIALS && Width(NJoined)<=HalfWidth){
+      Decided= NJoined;
+      LimitEnsemble(Decided);
+      if (DebugLevel > 1)
+	fprintf(logfp,"Target met after %d trajectories\n",Decided);
+    }
+  }
+  pthread_mutex_unlock(&Lock);
+}
+
+/* Print the statistic of the ensemble on fp; the number of runs in it */
+int ReportTarget(fp)
+FILE *fp;
+{
+  int n;
+
+  n= (Decided>0 ? Decided : NJoined);
+  if(TargetFate!=NULL)
+    fprintf(fp,"fate %s: %g +- %g (95%%) from %d trajectories",
+	    TargetFate,Mean,(n>0 ? Width(n) : HUGE_VAL),n);
+  else
+    fprintf(fp,"%s%s at %g: %g +- %g (95%%) from %d trajectories",
+	    SpeciesName[TargetSpecies],(TargetConc ? "/V" : ""),TargetTime,
+	    Mean,(n>0 ? Width(n) : HUGE_VAL),n);
+  if(Decided==0) fprintf(fp,"; +- %g not reached",HalfWidth);
+  fprintf(fp,"\n");
+
+  free(Value);
+  free(Done);
+  return(n);
+}
@@ -0,0 +1,12 @@
+/**********************
+ *
+ * Adaptive ensembles: as many runs as a confidence interval needs (see Target.c)
+ *
+ **********************/
+#define TARGET
+
+extern int  Adaptive;
+extern void SetupTarget(char *, double, int);
+extern void TakeTarget(SAMPLE *);
+extern void AddTargetRun(int);
+extern int  ReportTarget(FILE *);
@@ -28,6 +28,10 @@
  #include "DataStructures.h"
 #endif
 
+#ifndef RANDOM
+ #include "Rng.h"
+#endif
+
 /*** These are needed because AIX is brain-dead ***/
 
 extern int strcasecmp();
@@ -100,6 +104,22 @@ int type;
   }
 }
 
+/*
+ * Name of a segment, with the copy number appended for all but the
+ * first copy.  The result is only good until the next call from
+ * the same thread.
+ */
+char *SegmentName(dna)
+DNA *dna;
+{
+  static __thread char name[128];
+
+  if(dna->Seq->Copy==0) return(dna->T->Name);
+
+  sprintf(name,"%s%c%d",dna->T->Name,COPY_SEPARATOR,dna->Seq->Copy);
+  return(name);
+}
+
 char *FindReactionType(type)
 int type;
 {
@@ -161,22 +181,23 @@ double xx;
 	return -tmp+log(2.5066282746310005*ser/x);
 }
 
+/*
+ * The tables are filled by FillBicoTable() before any simulation
+ * context runs, and only read afterwards, so the threads running
+ * the contexts can share them.
+ */
+
+static short  TablesFilled=0;
+static double FactlnTable[101];
+static double BicoTable[1000][4];
+
 double factln(n)
 int n;
 {
-        static short flag=0;
 	double gammln();
-	static double a[101];
-	
-	if(flag==0){
-	  int i;
-	  for(i=0; i<101; i++)
-	    a[i]=0.0;
-	  flag=1;
-	}
 
 	if (n <= 1) return 0.0;
-	if (n <= 100) return a[n] ? a[n] : (a[n]=gammln(n+1.0));
+	if (n <= 100 && TablesFilled) return FactlnTable[n];
 	else return gammln(n+1.0);
 }
 
@@ -184,23 +205,13 @@ int n;
 double bico(n,k)
 int k,n;
 {
-  static short flag=0;
   double factln();
-  static double table[1000][4];
-  
-  if(flag==0){
-    int i,j;
-    for(i=1; i<=1000; i++)
-      for(j=1; j<=4; j++)
-	table[i-1][j-1] = floor(0.5+exp(factln(i)-factln(j)-factln(i-j)));
-    flag=1;
-  }
   
   if(k==0)                return(1.0);
   if(n==0 || k>n)         return(0.0);    
   if(k==n)                return(1.0);
   
-  if(n<=1000 && k<=4) return(table[n-1][k-1]);
+  if(n<=1000 && k<=4 && TablesFilled) return(BicoTable[n-1][k-1]);
     
   return floor(0.5+exp(factln(n)-factln(k)-factln(n-k)));
 }
@@ -208,11 +219,19 @@ int k,n;
 void FillBicoTable()
 {
   int i,j;
-  double bico();
+  double gammln();
+  double factln();
+
+  if(TablesFilled) return;
+
+  FactlnTable[0]= FactlnTable[1]= 0.0;
+  for(i=2; i<=100; i++)
+    FactlnTable[i]= gammln(i+1.0);
+  TablesFilled=1;
 
-  for(i=1; i<=20; i++)
+  for(i=1; i<=1000; i++)
     for(j=1; j<=4; j++)
-      (void) bico(i,j);  
+      BicoTable[i-1][j-1] = (j>i ? 0.0 : floor(0.5+exp(factln(i)-factln(j)-factln(i-j))));
 }
 
 unsigned long choose(nn,mm)
@@ -241,3 +260,147 @@ int nn,t;
 
 return(i);
 }
+
+/**********
+ *
+ * Binomial deviate drawn from the simulation stream (Rng).  Small
+ * means, such as the gene copy numbers, are drawn by inversion
+ * of the cumulative distribution, whose cost grows with
+ * n*min(p,1-p).  Larger ones, such as the species counts
+ * partitioned at division, use the BTPE rejection method of
+ * Kachitvichyanukul and Schmeiser (Comm. ACM 31:216, 1988),
+ * whose cost does not depend on n.
+ *
+ **********/
+
+#define BTPE_MIN_MEAN 30.0
+
+/* BTPE for p <= 0.5 and n*p >= BTPE_MIN_MEAN */
+static int BinomialBTPE(n,p)
+int n;
+double p;
+{
+  int m,y,k,i;
+  double q,fm,npq,p1,p2,p3,p4,xm,xl,xr,c,a,laml,lamr;
+  double u,v,x,s,f,rho,t,A,x1,f1,z,w,x2,f2,z2,w2;
+
+  q=   1.0-p;
+  npq= n*p*q;
+  fm=  n*p+p;
+  m=   (int) floor(fm);
+  p1=  floor(2.195*sqrt(npq)-4.6*q)+0.5;
+  xm=  m+0.5;
+  xl=  xm-p1;
+  xr=  xm+p1;
+  c=   0.134+20.5/(15.3+m);
+  a=   (fm-xl)/(fm-xl*p);
+  laml= a*(1.0+a/2.0);
+  a=   (xr-fm)/(xr*q);
+  lamr= a*(1.0+a/2.0);
+  p2=  p1*(1.0+2.0*c);
+  p3=  p2+c/laml;
+  p4=  p3+c/lamr;
+
+  for(;;){
+    u= RngUniform(Sim->Rng)*p4;
+    v= RngUniform(Sim->Rng);
+
+    if(u<=p1){                          /* Triangular region: accept */
+      y= (int) floor(xm-p1*v+u);
+      return(y);
+    }
+
+    if(u<=p2){                          /* Parallelograms */
+      x= xl+(u-p1)/c;
+      v= v*c+1.0-fabs(m-x+0.5)/p1;
+      if(v>1.0) continue;
+      y= (int) floor(x);
+    } else if(u<=p3){                   /* Left exponential tail */
+      y= (int) floor(xl+log(v)/laml);
+      if(y<0 || v==0.0) continue;
+      v= v*(u-p2)*laml;
+    } else {                            /* Right exponential tail */
+      y= (int) floor(xr-log(v)/lamr);
+      if(y>n || v==0.0) continue;
+      v= v*(u-p3)*lamr;
+    }
+
+    k= abs(y-m);
+    if(k<=20 || k>=npq/2.0-1.0){
+      /* Explicit evaluation of f(y)/f(m) */
+      s= p/q;
+      a= s*(n+1);
+      f= 1.0;
+      if(m<y)
+	for(i=m+1; i<=y; i++) f *= (a/i-s);
+      else if(m>y)
+	for(i=y+1; i<=m; i++) f /= (a/i-s);
+      if(v<=f) return(y);
+      continue;
+    }
+
+    /* Squeeze on log(f(y)/f(m)), then the Stirling bound */
+    rho= (k/npq)*((k*(k/3.0+0.625)+0.1666666666666667)/npq+0.5);
+    t=   -k*k/(2.0*npq);
+    A=   log(v);
+    if(A<t-rho) return(y);
+    if(A>t+rho) continue;
+
+    x1= y+1;  f1= m+1;  z= n+1-m;  w= n-y+1;
+    x2= x1*x1; f2= f1*f1; z2= z*z; w2= w*w;
+    if(A<= xm*log(f1/x1)+(n-m+0.5)*log(z/w)+(y-m)*log(w*p/(x1*q))
+       +(13680.-(462.-(132.-(99.-140./f2)/f2)/f2)/f2)/f1/166320.
+       +(13680.-(462.-(132.-(99.-140./z2)/z2)/z2)/z2)/z/166320.
+       +(13680.-(462.-(132.-(99.-140./x2)/x2)/x2)/x2)/x1/166320.
+       +(13680.-(462.-(132.-(99.-140./w2)/w2)/w2)/w2)/w/166320.)
+      return(y);
+  }
+}
+
+int RandomBinomial(n,p)
+int n;
+double p;
+{
+  int k,flip;
+  double q,r,f,u;
+
+  if(n<=0 || p<=0.0) return(0);
+  if(p>=1.0)         return(n);
+
+  flip= (p>0.5);
+  if(flip) p= 1.0-p;
+
+  if(n*p>=BTPE_MIN_MEAN){
+    k= BinomialBTPE(n,p);
+    return(flip ? n-k : k);
+  }
+
+  q= 1.0-p;
+  r= p/q;
+  f= pow(q,(double) n);
+  u= RngUniform(Sim->Rng);
+
+  k=0;
+  while(u>f && k<n){
+    u -= f;
+    k++;
+    f *= r*(n-k+1)/k;
+  }
+
+  return(flip ? n-k : k);
+}
+
+#undef BTPE_MIN_MEAN
+
+/* Draw keep[i] ~ Binomial(count[i],p) for a whole vector of counts */
+void RandomPartition(n,count,p,keep)
+int n;
+int *count;
+double p;
+int *keep;
+{
+  int i;
+
+  for(i=0; i<n; i++)
+    keep[i]= (count[i]>0 ? RandomBinomial(count[i],p) : 0);
+}
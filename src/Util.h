@@ -51,6 +51,7 @@ extern FILE *logfp;
 extern void *rcalloc(size_t,size_t,char[]);
 extern void *rrealloc(void *,size_t,size_t,char *);
 extern char *PrintDNAType(int);
+extern char *SegmentName();
 extern char *FindReactionType(int);
 
 /**********
@@ -66,3 +67,12 @@ extern double bico(int,int);
 extern void FillBicoTable();
 extern unsigned long choose(int,int);
 extern unsigned long factorial(int,int);
+
+/**********
+ *
+ * Random Deviates
+ *
+ **********/
+
+extern int RandomBinomial(int,double);
+extern void RandomPartition(int,int *,double,int *);
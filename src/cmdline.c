@@ -51,6 +51,30 @@ const char *gengetopt_args_info_help[] = {
   "      --seed=LONG            Seed for random number generator",
   "  -o, --output-file=STRING   Output file name",
   "  -l, --log-file=STRING      Log file name",
+  "      --superinfect=DOUBLE   Time at which further phage infect the cell",
+  "      --superinfect-moi=INT  Number of phage added by --superinfect  \n                               (default=`1')",
+  "      --continuous-growth    grow the cell volume continuously between  \n                               divisions  (default=off)",
+  "      --lineage=INT          Follow both daughters for this many generations  \n                               (at most 20: n generations run 2^n cells, each  \n                               with its own output file)",
+  "      --trajectory=INT       Index of this trajectory among runs with the same  \n                               seed  (default=`0')",
+  "      --ensemble=INT         Run this many trajectories from one parse, to  \n                               output-file.N",
+  "      --threads=INT          Threads for --ensemble and --worker, processes for  \n                               --fork-server and cells running at once for  \n                               --lineage (0 = one per processor)  (default=`0')",
+  "      --sweep=STRING         Sweep axis: volume|growth|moi VALUES, rate kN  \n                               VALUES, init NAME VALUES or param NAME VALUES",
+  "      --sweep-list           Take the sweep axes together as a list of points,  \n                               not as a grid  (default=off)",
+  "      --fork-server=STRING   Read run specs from this pipe or Unix socket (-  \n                               for stdin) and fork a process for each",
+  "      --coordinator=STRING   Hand out the run specs read from stdin to workers  \n                               connecting at [HOST:]PORT",
+  "      --worker=STRING        Make runs for the coordinator at HOST:PORT",
+  "      --stop=STRING          End the run with fate FATE when QUANTITY>X or <X  \n                               (FATE:QUANTITY>X), QUANTITY a species NAME,  \n                               NAME/V, int(NAME), int(NAME/V) or time",
+  "      --target=STRING        Run the --ensemble only until this statistic is  \n                               known to --half-width: fate:FATE, NAME@T or  \n                               NAME/V@T",
+  "      --half-width=DOUBLE    Half width of the 95% confidence interval of  \n                               --target  (default=`0')",
+  "      --stats                Take statistics of the columns across the  \n                               --ensemble, written to files output-file.STAT  \n                               (default=off)",
+  "      --stats-only           With --stats, write no file for each trajectory  \n                               (default=off)",
+  "      --stats-quantiles=STRING  Quantiles estimated by --stats  \n                               (default=`0.05,0.5,0.95')",
+  "      --stats-bins=INT       Bins of the histograms of --stats, from 0,  \n                               doubling in width as values outgrow them (none  \n                               if 0)  (default=`0')",
+  "      --output-format=STRING  Write the output as text, binary records that  \n                               can be mapped into memory, or compressed deltas  \n                               (default=`text')",
+  "      --flush=INT            Flush the output every this many rows, at the end  \n                               only if 0, or as the format does if -1: every  \n                               row for text, at the end for binary  \n                               (default=`-1')",
+  "      --writer               Format and write the output on a thread of its  \n                               own, fed the rows of every run through a ring  \n                               for each thread  (default=off)",
+  "      --writer-rows=INT      Rows each thread may queue for --writer before it  \n                               waits  (default=`1024')",
+  "      --keyframe=INT         Rows between the keyframes of  \n                               --output-format=delta  (default=`64')",
     0
 };
 
@@ -126,6 +150,30 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->seed_given = 0 ;
   args_info->output_file_given = 0 ;
   args_info->log_file_given = 0 ;
+  args_info->superinfect_given = 0 ;
+  args_info->superinfect_moi_given = 0 ;
+  args_info->continuous_growth_given = 0 ;
+  args_info->lineage_given = 0 ;
+  args_info->trajectory_given = 0 ;
+  args_info->ensemble_given = 0 ;
+  args_info->threads_given = 0 ;
+  args_info->sweep_given = 0 ;
+  args_info->sweep_list_given = 0 ;
+  args_info->fork_server_given = 0 ;
+  args_info->coordinator_given = 0 ;
+  args_info->worker_given = 0 ;
+  args_info->stop_given = 0 ;
+  args_info->target_given = 0 ;
+  args_info->half_width_given = 0 ;
+  args_info->stats_given = 0 ;
+  args_info->stats_only_given = 0 ;
+  args_info->stats_quantiles_given = 0 ;
+  args_info->stats_bins_given = 0 ;
+  args_info->output_format_given = 0 ;
+  args_info->flush_given = 0 ;
+  args_info->writer_given = 0 ;
+  args_info->writer_rows_given = 0 ;
+  args_info->keyframe_given = 0 ;
 }
 
 static
@@ -165,6 +213,46 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->output_file_orig = NULL;
   args_info->log_file_arg = NULL;
   args_info->log_file_orig = NULL;
+  args_info->superinfect_orig = NULL;
+  args_info->superinfect_moi_arg = 1;
+  args_info->superinfect_moi_orig = NULL;
+  args_info->continuous_growth_flag = 0;
+  args_info->lineage_orig = NULL;
+  args_info->trajectory_arg = 0;
+  args_info->trajectory_orig = NULL;
+  args_info->ensemble_orig = NULL;
+  args_info->threads_arg = 0;
+  args_info->threads_orig = NULL;
+  args_info->sweep_arg = NULL;
+  args_info->sweep_orig = NULL;
+  args_info->sweep_list_flag = 0;
+  args_info->fork_server_arg = NULL;
+  args_info->fork_server_orig = NULL;
+  args_info->coordinator_arg = NULL;
+  args_info->coordinator_orig = NULL;
+  args_info->worker_arg = NULL;
+  args_info->worker_orig = NULL;
+  args_info->stop_arg = NULL;
+  args_info->stop_orig = NULL;
+  args_info->target_arg = NULL;
+  args_info->target_orig = NULL;
+  args_info->half_width_arg = 0;
+  args_info->half_width_orig = NULL;
+  args_info->stats_flag = 0;
+  args_info->stats_only_flag = 0;
+  args_info->stats_quantiles_arg = gengetopt_strdup ("0.05,0.5,0.95");
+  args_info->stats_quantiles_orig = NULL;
+  args_info->stats_bins_arg = 0;
+  args_info->stats_bins_orig = NULL;
+  args_info->output_format_arg = gengetopt_strdup ("text");
+  args_info->output_format_orig = NULL;
+  args_info->flush_arg = -1;
+  args_info->flush_orig = NULL;
+  args_info->writer_flag = 0;
+  args_info->writer_rows_arg = 1024;
+  args_info->writer_rows_orig = NULL;
+  args_info->keyframe_arg = 64;
+  args_info->keyframe_orig = NULL;
   
 }
 
@@ -200,6 +288,34 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->seed_help = gengetopt_args_info_help[20] ;
   args_info->output_file_help = gengetopt_args_info_help[21] ;
   args_info->log_file_help = gengetopt_args_info_help[22] ;
+  args_info->superinfect_help = gengetopt_args_info_help[23] ;
+  args_info->superinfect_moi_help = gengetopt_args_info_help[24] ;
+  args_info->continuous_growth_help = gengetopt_args_info_help[25] ;
+  args_info->lineage_help = gengetopt_args_info_help[26] ;
+  args_info->trajectory_help = gengetopt_args_info_help[27] ;
+  args_info->ensemble_help = gengetopt_args_info_help[28] ;
+  args_info->threads_help = gengetopt_args_info_help[29] ;
+  args_info->sweep_help = gengetopt_args_info_help[30] ;
+  args_info->sweep_min = -1;
+  args_info->sweep_max = -1;
+  args_info->sweep_list_help = gengetopt_args_info_help[31] ;
+  args_info->fork_server_help = gengetopt_args_info_help[32] ;
+  args_info->coordinator_help = gengetopt_args_info_help[33] ;
+  args_info->worker_help = gengetopt_args_info_help[34] ;
+  args_info->stop_help = gengetopt_args_info_help[35] ;
+  args_info->stop_min = -1;
+  args_info->stop_max = -1;
+  args_info->target_help = gengetopt_args_info_help[36] ;
+  args_info->half_width_help = gengetopt_args_info_help[37] ;
+  args_info->stats_help = gengetopt_args_info_help[38] ;
+  args_info->stats_only_help = gengetopt_args_info_help[39] ;
+  args_info->stats_quantiles_help = gengetopt_args_info_help[40] ;
+  args_info->stats_bins_help = gengetopt_args_info_help[41] ;
+  args_info->output_format_help = gengetopt_args_info_help[42] ;
+  args_info->flush_help = gengetopt_args_info_help[43] ;
+  args_info->writer_help = gengetopt_args_info_help[44] ;
+  args_info->writer_rows_help = gengetopt_args_info_help[45] ;
+  args_info->keyframe_help = gengetopt_args_info_help[46] ;
   
 }
 
@@ -431,6 +547,165 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->log_file_orig); /* free previous argument */
       args_info->log_file_orig = 0;
     }
+  if (args_info->superinfect_orig)
+    {
+      free (args_info->superinfect_orig); /* free previous argument */
+      args_info->superinfect_orig = 0;
+    }
+  if (args_info->superinfect_moi_orig)
+    {
+      free (args_info->superinfect_moi_orig); /* free previous argument */
+      args_info->superinfect_moi_orig = 0;
+    }
+  if (args_info->lineage_orig)
+    {
+      free (args_info->lineage_orig); /* free previous argument */
+      args_info->lineage_orig = 0;
+    }
+  if (args_info->trajectory_orig)
+    {
+      free (args_info->trajectory_orig); /* free previous argument */
+      args_info->trajectory_orig = 0;
+    }
+  if (args_info->ensemble_orig)
+    {
+      free (args_info->ensemble_orig); /* free previous argument */
+      args_info->ensemble_orig = 0;
+    }
+  if (args_info->threads_orig)
+    {
+      free (args_info->threads_orig); /* free previous argument */
+      args_info->threads_orig = 0;
+    }
+  if (args_info->sweep_arg)
+    {
+      for (i = 0; i < args_info->sweep_given; ++i)
+        {
+          if (args_info->sweep_arg [i])
+            {
+              free (args_info->sweep_arg [i]); /* free previous argument */
+              args_info->sweep_arg [i] = 0;
+            }
+          if (args_info->sweep_orig [i])
+            {
+              free (args_info->sweep_orig [i]); /* free previous argument */
+              args_info->sweep_orig [i] = 0;
+            }
+        }
+      if (args_info->sweep_arg [0])
+        free (args_info->sweep_arg [0]); /* free default string */
+      free (args_info->sweep_arg); /* free previous argument */
+      args_info->sweep_arg = 0;
+      free (args_info->sweep_orig); /* free previous argument */
+      args_info->sweep_orig = 0;
+    }
+  if (args_info->fork_server_arg)
+    {
+      free (args_info->fork_server_arg); /* free previous argument */
+      args_info->fork_server_arg = 0;
+    }
+  if (args_info->fork_server_orig)
+    {
+      free (args_info->fork_server_orig); /* free previous argument */
+      args_info->fork_server_orig = 0;
+    }
+  if (args_info->coordinator_arg)
+    {
+      free (args_info->coordinator_arg); /* free previous argument */
+      args_info->coordinator_arg = 0;
+    }
+  if (args_info->coordinator_orig)
+    {
+      free (args_info->coordinator_orig); /* free previous argument */
+      args_info->coordinator_orig = 0;
+    }
+  if (args_info->worker_arg)
+    {
+      free (args_info->worker_arg); /* free previous argument */
+      args_info->worker_arg = 0;
+    }
+  if (args_info->worker_orig)
+    {
+      free (args_info->worker_orig); /* free previous argument */
+      args_info->worker_orig = 0;
+    }
+  if (args_info->stop_arg)
+    {
+      for (i = 0; i < args_info->stop_given; ++i)
+        {
+          if (args_info->stop_arg [i])
+            {
+              free (args_info->stop_arg [i]); /* free previous argument */
+              args_info->stop_arg [i] = 0;
+            }
+          if (args_info->stop_orig [i])
+            {
+              free (args_info->stop_orig [i]); /* free previous argument */
+              args_info->stop_orig [i] = 0;
+            }
+        }
+      if (args_info->stop_arg [0])
+        free (args_info->stop_arg [0]); /* free default string */
+      free (args_info->stop_arg); /* free previous argument */
+      args_info->stop_arg = 0;
+      free (args_info->stop_orig); /* free previous argument */
+      args_info->stop_orig = 0;
+    }
+  if (args_info->target_arg)
+    {
+      free (args_info->target_arg); /* free previous argument */
+      args_info->target_arg = 0;
+    }
+  if (args_info->target_orig)
+    {
+      free (args_info->target_orig); /* free previous argument */
+      args_info->target_orig = 0;
+    }
+  if (args_info->half_width_orig)
+    {
+      free (args_info->half_width_orig); /* free previous argument */
+      args_info->half_width_orig = 0;
+    }
+  if (args_info->stats_quantiles_arg)
+    {
+      free (args_info->stats_quantiles_arg); /* free previous argument */
+      args_info->stats_quantiles_arg = 0;
+    }
+  if (args_info->stats_quantiles_orig)
+    {
+      free (args_info->stats_quantiles_orig); /* free previous argument */
+      args_info->stats_quantiles_orig = 0;
+    }
+  if (args_info->stats_bins_orig)
+    {
+      free (args_info->stats_bins_orig); /* free previous argument */
+      args_info->stats_bins_orig = 0;
+    }
+  if (args_info->output_format_arg)
+    {
+      free (args_info->output_format_arg); /* free previous argument */
+      args_info->output_format_arg = 0;
+    }
+  if (args_info->output_format_orig)
+    {
+      free (args_info->output_format_orig); /* free previous argument */
+      args_info->output_format_orig = 0;
+    }
+  if (args_info->flush_orig)
+    {
+      free (args_info->flush_orig); /* free previous argument */
+      args_info->flush_orig = 0;
+    }
+  if (args_info->writer_rows_orig)
+    {
+      free (args_info->writer_rows_orig); /* free previous argument */
+      args_info->writer_rows_orig = 0;
+    }
+  if (args_info->keyframe_orig)
+    {
+      free (args_info->keyframe_orig); /* free previous argument */
+      args_info->keyframe_orig = 0;
+    }
   
   for (i = 0; i < args_info->inputs_num; ++i)
     free (args_info->inputs [i]);
@@ -601,6 +876,160 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "log-file");
     }
   }
+  if (args_info->superinfect_given) {
+    if (args_info->superinfect_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "superinfect", args_info->superinfect_orig);
+    } else {
+      fprintf(outfile, "%s\n", "superinfect");
+    }
+  }
+  if (args_info->superinfect_moi_given) {
+    if (args_info->superinfect_moi_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "superinfect-moi", args_info->superinfect_moi_orig);
+    } else {
+      fprintf(outfile, "%s\n", "superinfect-moi");
+    }
+  }
+  if (args_info->continuous_growth_given) {
+    fprintf(outfile, "%s\n", "continuous-growth");
+  }
+  if (args_info->lineage_given) {
+    if (args_info->lineage_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "lineage", args_info->lineage_orig);
+    } else {
+      fprintf(outfile, "%s\n", "lineage");
+    }
+  }
+  if (args_info->trajectory_given) {
+    if (args_info->trajectory_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "trajectory", args_info->trajectory_orig);
+    } else {
+      fprintf(outfile, "%s\n", "trajectory");
+    }
+  }
+  if (args_info->ensemble_given) {
+    if (args_info->ensemble_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ensemble", args_info->ensemble_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ensemble");
+    }
+  }
+  if (args_info->threads_given) {
+    if (args_info->threads_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "threads", args_info->threads_orig);
+    } else {
+      fprintf(outfile, "%s\n", "threads");
+    }
+  }
+  if (args_info->sweep_orig)
+    {
+      for (i = 0; i < args_info->sweep_given; ++i)
+        {
+          if (args_info->sweep_orig [i])
+            {
+              fprintf(outfile, "%s=\"%s\"\n", "sweep", args_info->sweep_orig [i]);
+            }
+        }
+    }
+  if (args_info->sweep_list_given) {
+    fprintf(outfile, "%s\n", "sweep-list");
+  }
+  if (args_info->fork_server_given) {
+    if (args_info->fork_server_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "fork-server", args_info->fork_server_orig);
+    } else {
+      fprintf(outfile, "%s\n", "fork-server");
+    }
+  }
+  if (args_info->coordinator_given) {
+    if (args_info->coordinator_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "coordinator", args_info->coordinator_orig);
+    } else {
+      fprintf(outfile, "%s\n", "coordinator");
+    }
+  }
+  if (args_info->worker_given) {
+    if (args_info->worker_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "worker", args_info->worker_orig);
+    } else {
+      fprintf(outfile, "%s\n", "worker");
+    }
+  }
+  if (args_info->stop_orig)
+    {
+      for (i = 0; i < args_info->stop_given; ++i)
+        {
+          if (args_info->stop_orig [i])
+            {
+              fprintf(outfile, "%s=\"%s\"\n", "stop", args_info->stop_orig [i]);
+            }
+        }
+    }
+  if (args_info->target_given) {
+    if (args_info->target_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "target", args_info->target_orig);
+    } else {
+      fprintf(outfile, "%s\n", "target");
+    }
+  }
+  if (args_info->half_width_given) {
+    if (args_info->half_width_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "half-width", args_info->half_width_orig);
+    } else {
+      fprintf(outfile, "%s\n", "half-width");
+    }
+  }
+  if (args_info->stats_given) {
+    fprintf(outfile, "%s\n", "stats");
+  }
+  if (args_info->stats_only_given) {
+    fprintf(outfile, "%s\n", "stats-only");
+  }
+  if (args_info->stats_quantiles_given) {
+    if (args_info->stats_quantiles_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "stats-quantiles", args_info->stats_quantiles_orig);
+    } else {
+      fprintf(outfile, "%s\n", "stats-quantiles");
+    }
+  }
+  if (args_info->stats_bins_given) {
+    if (args_info->stats_bins_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "stats-bins", args_info->stats_bins_orig);
+    } else {
+      fprintf(outfile, "%s\n", "stats-bins");
+    }
+  }
+  if (args_info->output_format_given) {
+    if (args_info->output_format_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "output-format", args_info->output_format_orig);
+    } else {
+      fprintf(outfile, "%s\n", "output-format");
+    }
+  }
+  if (args_info->flush_given) {
+    if (args_info->flush_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "flush", args_info->flush_orig);
+    } else {
+      fprintf(outfile, "%s\n", "flush");
+    }
+  }
+  if (args_info->writer_given) {
+    fprintf(outfile, "%s\n", "writer");
+  }
+  if (args_info->writer_rows_given) {
+    if (args_info->writer_rows_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "writer-rows", args_info->writer_rows_orig);
+    } else {
+      fprintf(outfile, "%s\n", "writer-rows");
+    }
+  }
+  if (args_info->keyframe_given) {
+    if (args_info->keyframe_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "keyframe", args_info->keyframe_orig);
+    } else {
+      fprintf(outfile, "%s\n", "keyframe");
+    }
+  }
   
   fclose (outfile);
 
@@ -842,6 +1271,12 @@ cmdline_parser_required2 (struct gengetopt_args_info *args_info, const char *pro
   if (check_multiple_option_occurrences(prog_name, args_info->param_given, args_info->param_min, args_info->param_max, "'--param' ('-P')"))
      error = 1;
   
+  if (check_multiple_option_occurrences(prog_name, args_info->stop_given, args_info->stop_min, args_info->stop_max, "'--stop'"))
+     error = 1;
+  
+  if (check_multiple_option_occurrences(prog_name, args_info->sweep_given, args_info->sweep_min, args_info->sweep_max, "'--sweep'"))
+     error = 1;
+  
   
   /* checks for dependences among options */
 
@@ -860,6 +1295,8 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
   struct string_list * init_list = NULL,* init_new = NULL;
   struct string_list * rate_list = NULL,* rate_new = NULL;
   struct string_list * param_list = NULL,* param_new = NULL;
+  struct string_list * stop_list = NULL,* stop_new = NULL;
+  struct string_list * sweep_list = NULL,* sweep_new = NULL;
   int error = 0;
   struct gengetopt_args_info local_args_info;
   
@@ -912,6 +1349,30 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "seed",	1, NULL, 0 },
         { "output-file",	1, NULL, 'o' },
         { "log-file",	1, NULL, 'l' },
+        { "superinfect",	1, NULL, 0 },
+        { "superinfect-moi",	1, NULL, 0 },
+        { "continuous-growth",	0, NULL, 0 },
+        { "lineage",	1, NULL, 0 },
+        { "trajectory",	1, NULL, 0 },
+        { "ensemble",	1, NULL, 0 },
+        { "threads",	1, NULL, 0 },
+        { "sweep",	1, NULL, 0 },
+        { "sweep-list",	0, NULL, 0 },
+        { "fork-server",	1, NULL, 0 },
+        { "coordinator",	1, NULL, 0 },
+        { "worker",	1, NULL, 0 },
+        { "stop",	1, NULL, 0 },
+        { "target",	1, NULL, 0 },
+        { "half-width",	1, NULL, 0 },
+        { "stats",	0, NULL, 0 },
+        { "stats-only",	0, NULL, 0 },
+        { "stats-quantiles",	1, NULL, 0 },
+        { "stats-bins",	1, NULL, 0 },
+        { "output-format",	1, NULL, 0 },
+        { "flush",	1, NULL, 0 },
+        { "writer",	0, NULL, 0 },
+        { "writer-rows",	1, NULL, 0 },
+        { "keyframe",	1, NULL, 0 },
         { NULL,	0, NULL, 0 }
       };
 
@@ -1344,6 +1805,473 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->seed_orig); /* free previous string */
             args_info->seed_orig = gengetopt_strdup (optarg);
           }
+          /* Time at which further phage infect the cell.  */
+          else if (strcmp (long_options[option_index].name, "superinfect") == 0)
+          {
+            if (local_args_info.superinfect_given || (check_ambiguity && args_info->superinfect_given))
+              {
+                fprintf (stderr, "%s: `--superinfect' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->superinfect_given && ! override)
+              continue;
+            local_args_info.superinfect_given = 1;
+            args_info->superinfect_given = 1;
+            args_info->superinfect_arg = strtod (optarg, &stop_char);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->superinfect_orig)
+              free (args_info->superinfect_orig); /* free previous string */
+            args_info->superinfect_orig = gengetopt_strdup (optarg);
+          }
+          /* Number of phage added by --superinfect.  */
+          else if (strcmp (long_options[option_index].name, "superinfect-moi") == 0)
+          {
+            if (local_args_info.superinfect_moi_given || (check_ambiguity && args_info->superinfect_moi_given))
+              {
+                fprintf (stderr, "%s: `--superinfect-moi' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->superinfect_moi_given && ! override)
+              continue;
+            local_args_info.superinfect_moi_given = 1;
+            args_info->superinfect_moi_given = 1;
+            args_info->superinfect_moi_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->superinfect_moi_orig)
+              free (args_info->superinfect_moi_orig); /* free previous string */
+            args_info->superinfect_moi_orig = gengetopt_strdup (optarg);
+          }
+          /* grow the cell volume continuously between divisions.  */
+          else if (strcmp (long_options[option_index].name, "continuous-growth") == 0)
+          {
+            if (local_args_info.continuous_growth_given || (check_ambiguity && args_info->continuous_growth_given))
+              {
+                fprintf (stderr, "%s: `--continuous-growth' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->continuous_growth_given && ! override)
+              continue;
+            local_args_info.continuous_growth_given = 1;
+            args_info->continuous_growth_given = 1;
+            args_info->continuous_growth_flag = !(args_info->continuous_growth_flag);
+          }
+          /* Follow both daughters for this many generations.  */
+          else if (strcmp (long_options[option_index].name, "lineage") == 0)
+          {
+            if (local_args_info.lineage_given || (check_ambiguity && args_info->lineage_given))
+              {
+                fprintf (stderr, "%s: `--lineage' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->lineage_given && ! override)
+              continue;
+            local_args_info.lineage_given = 1;
+            args_info->lineage_given = 1;
+            args_info->lineage_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->lineage_orig)
+              free (args_info->lineage_orig); /* free previous string */
+            args_info->lineage_orig = gengetopt_strdup (optarg);
+          }
+          /* Index of this trajectory among runs with the same seed.  */
+          else if (strcmp (long_options[option_index].name, "trajectory") == 0)
+          {
+            if (local_args_info.trajectory_given || (check_ambiguity && args_info->trajectory_given))
+              {
+                fprintf (stderr, "%s: `--trajectory' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->trajectory_given && ! override)
+              continue;
+            local_args_info.trajectory_given = 1;
+            args_info->trajectory_given = 1;
+            args_info->trajectory_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->trajectory_orig)
+              free (args_info->trajectory_orig); /* free previous string */
+            args_info->trajectory_orig = gengetopt_strdup (optarg);
+          }
+          /* Run this many trajectories from one parse, to output-file.N.  */
+          else if (strcmp (long_options[option_index].name, "ensemble") == 0)
+          {
+            if (local_args_info.ensemble_given || (check_ambiguity && args_info->ensemble_given))
+              {
+                fprintf (stderr, "%s: `--ensemble' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ensemble_given && ! override)
+              continue;
+            local_args_info.ensemble_given = 1;
+            args_info->ensemble_given = 1;
+            args_info->ensemble_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ensemble_orig)
+              free (args_info->ensemble_orig); /* free previous string */
+            args_info->ensemble_orig = gengetopt_strdup (optarg);
+          }
+          /* Threads for --ensemble and --worker, processes for --fork-server (0 = one per processor).  */
+          else if (strcmp (long_options[option_index].name, "threads") == 0)
+          {
+            if (local_args_info.threads_given || (check_ambiguity && args_info->threads_given))
+              {
+                fprintf (stderr, "%s: `--threads' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->threads_given && ! override)
+              continue;
+            local_args_info.threads_given = 1;
+            args_info->threads_given = 1;
+            args_info->threads_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->threads_orig)
+              free (args_info->threads_orig); /* free previous string */
+            args_info->threads_orig = gengetopt_strdup (optarg);
+          }
+          /* Sweep axis: volume|growth|moi VALUES, rate kN VALUES, init NAME VALUES or param NAME VALUES.  */
+          else if (strcmp (long_options[option_index].name, "sweep") == 0)
+          {
+            local_args_info.sweep_given++;
+        
+            multi_token = get_multiple_arg_token(optarg);
+            multi_next = get_multiple_arg_token_next (optarg);
+        
+            while (1)
+              {
+                sweep_new = (struct string_list *) malloc (sizeof (struct string_list));
+                sweep_new->next = sweep_list;
+                sweep_list = sweep_new;
+                sweep_new->arg = gengetopt_strdup (multi_token);
+                sweep_new->orig = multi_token;
+        
+                if (multi_next)
+                  {
+                    multi_token = get_multiple_arg_token(multi_next);
+                    multi_next = get_multiple_arg_token_next (multi_next);
+                    local_args_info.sweep_given++;
+                  }
+                else
+                  break;
+              }
+          }
+          /* Take the sweep axes together as a list of points, not as a grid.  */
+          else if (strcmp (long_options[option_index].name, "sweep-list") == 0)
+          {
+            if (local_args_info.sweep_list_given || (check_ambiguity && args_info->sweep_list_given))
+              {
+                fprintf (stderr, "%s: `--sweep-list' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->sweep_list_given && ! override)
+              continue;
+            local_args_info.sweep_list_given = 1;
+            args_info->sweep_list_given = 1;
+            args_info->sweep_list_flag = !(args_info->sweep_list_flag);
+          }
+          /* Read run specs from this pipe or Unix socket (- for stdin) and fork a process for each.  */
+          else if (strcmp (long_options[option_index].name, "fork-server") == 0)
+          {
+            if (local_args_info.fork_server_given || (check_ambiguity && args_info->fork_server_given))
+              {
+                fprintf (stderr, "%s: `--fork-server' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->fork_server_given && ! override)
+              continue;
+            local_args_info.fork_server_given = 1;
+            args_info->fork_server_given = 1;
+            if (args_info->fork_server_arg)
+              free (args_info->fork_server_arg); /* free previous string */
+            args_info->fork_server_arg = gengetopt_strdup (optarg);
+            if (args_info->fork_server_orig)
+              free (args_info->fork_server_orig); /* free previous string */
+            args_info->fork_server_orig = gengetopt_strdup (optarg);
+          }
+          /* Hand out the run specs read from stdin to workers connecting at [HOST:]PORT.  */
+          else if (strcmp (long_options[option_index].name, "coordinator") == 0)
+          {
+            if (local_args_info.coordinator_given || (check_ambiguity && args_info->coordinator_given))
+              {
+                fprintf (stderr, "%s: `--coordinator' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->coordinator_given && ! override)
+              continue;
+            local_args_info.coordinator_given = 1;
+            args_info->coordinator_given = 1;
+            if (args_info->coordinator_arg)
+              free (args_info->coordinator_arg); /* free previous string */
+            args_info->coordinator_arg = gengetopt_strdup (optarg);
+            if (args_info->coordinator_orig)
+              free (args_info->coordinator_orig); /* free previous string */
+            args_info->coordinator_orig = gengetopt_strdup (optarg);
+          }
+          /* Make runs for the coordinator at HOST:PORT.  */
+          else if (strcmp (long_options[option_index].name, "worker") == 0)
+          {
+            if (local_args_info.worker_given || (check_ambiguity && args_info->worker_given))
+              {
+                fprintf (stderr, "%s: `--worker' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->worker_given && ! override)
+              continue;
+            local_args_info.worker_given = 1;
+            args_info->worker_given = 1;
+            if (args_info->worker_arg)
+              free (args_info->worker_arg); /* free previous string */
+            args_info->worker_arg = gengetopt_strdup (optarg);
+            if (args_info->worker_orig)
+              free (args_info->worker_orig); /* free previous string */
+            args_info->worker_orig = gengetopt_strdup (optarg);
+          }
+          /* End the run with fate FATE when QUANTITY>X or <X (FATE:QUANTITY>X), QUANTITY a species NAME, NAME/V, int(NAME), int(NAME/V) or time.  */
+          else if (strcmp (long_options[option_index].name, "stop") == 0)
+          {
+            local_args_info.stop_given++;
+        
+            multi_token = get_multiple_arg_token(optarg);
+            multi_next = get_multiple_arg_token_next (optarg);
+        
+            while (1)
+              {
+                stop_new = (struct string_list *) malloc (sizeof (struct string_list));
+                stop_new->next = stop_list;
+                stop_list = stop_new;
+                stop_new->arg = gengetopt_strdup (multi_token);
+                stop_new->orig = multi_token;
+        
+                if (multi_next)
+                  {
+                    multi_token = get_multiple_arg_token(multi_next);
+                    multi_next = get_multiple_arg_token_next (multi_next);
+                    local_args_info.stop_given++;
+                  }
+                else
+                  break;
+              }
+          }
+          /* Run the --ensemble only until this statistic is known to --half-width: fate:FATE, NAME@T or NAME/V@T.  */
+          else if (strcmp (long_options[option_index].name, "target") == 0)
+          {
+            if (local_args_info.target_given || (check_ambiguity && args_info->target_given))
+              {
+                fprintf (stderr, "%s: `--target' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->target_given && ! override)
+              continue;
+            local_args_info.target_given = 1;
+            args_info->target_given = 1;
+            if (args_info->target_arg)
+              free (args_info->target_arg); /* free previous string */
+            args_info->target_arg = gengetopt_strdup (optarg);
+            if (args_info->target_orig)
+              free (args_info->target_orig); /* free previous string */
+            args_info->target_orig = gengetopt_strdup (optarg);
+          }
+          /* Half width of the 95% confidence interval of --target.  */
+          else if (strcmp (long_options[option_index].name, "half-width") == 0)
+          {
+            if (local_args_info.half_width_given || (check_ambiguity && args_info->half_width_given))
+              {
+                fprintf (stderr, "%s: `--half-width' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->half_width_given && ! override)
+              continue;
+            local_args_info.half_width_given = 1;
+            args_info->half_width_given = 1;
+            args_info->half_width_arg = strtod (optarg, &stop_char);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->half_width_orig)
+              free (args_info->half_width_orig); /* free previous string */
+            args_info->half_width_orig = gengetopt_strdup (optarg);
+          }
+          /* Take statistics of the columns across the --ensemble, written to files output-file.STAT.  */
+          else if (strcmp (long_options[option_index].name, "stats") == 0)
+          {
+            if (local_args_info.stats_given || (check_ambiguity && args_info->stats_given))
+              {
+                fprintf (stderr, "%s: `--stats' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->stats_given && ! override)
+              continue;
+            local_args_info.stats_given = 1;
+            args_info->stats_given = 1;
+            args_info->stats_flag = !(args_info->stats_flag);
+          }
+          /* With --stats, write no file for each trajectory.  */
+          else if (strcmp (long_options[option_index].name, "stats-only") == 0)
+          {
+            if (local_args_info.stats_only_given || (check_ambiguity && args_info->stats_only_given))
+              {
+                fprintf (stderr, "%s: `--stats-only' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->stats_only_given && ! override)
+              continue;
+            local_args_info.stats_only_given = 1;
+            args_info->stats_only_given = 1;
+            args_info->stats_only_flag = !(args_info->stats_only_flag);
+          }
+          /* Quantiles estimated by --stats.  */
+          else if (strcmp (long_options[option_index].name, "stats-quantiles") == 0)
+          {
+            if (local_args_info.stats_quantiles_given || (check_ambiguity && args_info->stats_quantiles_given))
+              {
+                fprintf (stderr, "%s: `--stats-quantiles' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->stats_quantiles_given && ! override)
+              continue;
+            local_args_info.stats_quantiles_given = 1;
+            args_info->stats_quantiles_given = 1;
+            if (args_info->stats_quantiles_arg)
+              free (args_info->stats_quantiles_arg); /* free previous string */
+            args_info->stats_quantiles_arg = gengetopt_strdup (optarg);
+            if (args_info->stats_quantiles_orig)
+              free (args_info->stats_quantiles_orig); /* free previous string */
+            args_info->stats_quantiles_orig = gengetopt_strdup (optarg);
+          }
+          /* Bins of the histograms of --stats, from 0, doubling in width as values outgrow them (none if 0).  */
+          else if (strcmp (long_options[option_index].name, "stats-bins") == 0)
+          {
+            if (local_args_info.stats_bins_given || (check_ambiguity && args_info->stats_bins_given))
+              {
+                fprintf (stderr, "%s: `--stats-bins' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->stats_bins_given && ! override)
+              continue;
+            local_args_info.stats_bins_given = 1;
+            args_info->stats_bins_given = 1;
+            args_info->stats_bins_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->stats_bins_orig)
+              free (args_info->stats_bins_orig); /* free previous string */
+            args_info->stats_bins_orig = gengetopt_strdup (optarg);
+          }
+          /* Write the output as text, binary records that can be mapped into memory, or compressed deltas.  */
+          else if (strcmp (long_options[option_index].name, "output-format") == 0)
+          {
+            if (local_args_info.output_format_given || (check_ambiguity && args_info->output_format_given))
+              {
+                fprintf (stderr, "%s: `--output-format' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->output_format_given && ! override)
+              continue;
+            local_args_info.output_format_given = 1;
+            args_info->output_format_given = 1;
+            if (args_info->output_format_arg)
+              free (args_info->output_format_arg); /* free previous string */
+            args_info->output_format_arg = gengetopt_strdup (optarg);
+            if (args_info->output_format_orig)
+              free (args_info->output_format_orig); /* free previous string */
+            args_info->output_format_orig = gengetopt_strdup (optarg);
+          }
+          /* Flush the output every this many rows, at the end only if 0, or as the format does if -1: every row for text, at the end for binary.  */
+          else if (strcmp (long_options[option_index].name, "flush") == 0)
+          {
+            if (local_args_info.flush_given || (check_ambiguity && args_info->flush_given))
+              {
+                fprintf (stderr, "%s: `--flush' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->flush_given && ! override)
+              continue;
+            local_args_info.flush_given = 1;
+            args_info->flush_given = 1;
+            args_info->flush_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->flush_orig)
+              free (args_info->flush_orig); /* free previous string */
+            args_info->flush_orig = gengetopt_strdup (optarg);
+          }
+          /* Format and write the output on a thread of its own, fed the rows of every run through a ring for each thread.  */
+          else if (strcmp (long_options[option_index].name, "writer") == 0)
+          {
+            if (local_args_info.writer_given || (check_ambiguity && args_info->writer_given))
+              {
+                fprintf (stderr, "%s: `--writer' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->writer_given && ! override)
+              continue;
+            local_args_info.writer_given = 1;
+            args_info->writer_given = 1;
+            args_info->writer_flag = !(args_info->writer_flag);
+          }
+          /* Rows each thread may queue for --writer before it waits.  */
+          else if (strcmp (long_options[option_index].name, "writer-rows") == 0)
+          {
+            if (local_args_info.writer_rows_given || (check_ambiguity && args_info->writer_rows_given))
+              {
+                fprintf (stderr, "%s: `--writer-rows' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->writer_rows_given && ! override)
+              continue;
+            local_args_info.writer_rows_given = 1;
+            args_info->writer_rows_given = 1;
+            args_info->writer_rows_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->writer_rows_orig)
+              free (args_info->writer_rows_orig); /* free previous string */
+            args_info->writer_rows_orig = gengetopt_strdup (optarg);
+          }
+          /* Rows between the keyframes of --output-format=delta.  */
+          else if (strcmp (long_options[option_index].name, "keyframe") == 0)
+          {
+            if (local_args_info.keyframe_given || (check_ambiguity && args_info->keyframe_given))
+              {
+                fprintf (stderr, "%s: `--keyframe' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->keyframe_given && ! override)
+              continue;
+            local_args_info.keyframe_given = 1;
+            args_info->keyframe_given = 1;
+            args_info->keyframe_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->keyframe_orig)
+              free (args_info->keyframe_orig); /* free previous string */
+            args_info->keyframe_orig = gengetopt_strdup (optarg);
+          }
           
           break;
         case '?':	/* Invalid option.  */
@@ -1401,6 +2329,34 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
           free (tmp);
         }
     }
+  if (local_args_info.stop_given && stop_list)
+    {
+      struct string_list *tmp;
+      args_info->stop_arg = (char * *) realloc (args_info->stop_arg, (args_info->stop_given + local_args_info.stop_given) * sizeof (char *));
+      args_info->stop_orig = (char **) realloc (args_info->stop_orig, (args_info->stop_given + local_args_info.stop_given) * sizeof (char *));
+      for (i = (local_args_info.stop_given - 1); i >= 0; --i)
+        {
+          tmp = stop_list;
+          args_info->stop_arg [i + args_info->stop_given] = stop_list->arg;
+          args_info->stop_orig [i + args_info->stop_given] = stop_list->orig;
+          stop_list = stop_list->next;
+          free (tmp);
+        }
+    }
+  if (local_args_info.sweep_given && sweep_list)
+    {
+      struct string_list *tmp;
+      args_info->sweep_arg = (char * *) realloc (args_info->sweep_arg, (args_info->sweep_given + local_args_info.sweep_given) * sizeof (char *));
+      args_info->sweep_orig = (char **) realloc (args_info->sweep_orig, (args_info->sweep_given + local_args_info.sweep_given) * sizeof (char *));
+      for (i = (local_args_info.sweep_given - 1); i >= 0; --i)
+        {
+          tmp = sweep_list;
+          args_info->sweep_arg [i + args_info->sweep_given] = sweep_list->arg;
+          args_info->sweep_orig [i + args_info->sweep_given] = sweep_list->orig;
+          sweep_list = sweep_list->next;
+          free (tmp);
+        }
+    }
   
 
   args_info->init_given += local_args_info.init_given;
@@ -1409,6 +2365,10 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
   local_args_info.rate_given = 0;
   args_info->param_given += local_args_info.param_given;
   local_args_info.param_given = 0;
+  args_info->stop_given += local_args_info.stop_given;
+  local_args_info.stop_given = 0;
+  args_info->sweep_given += local_args_info.sweep_given;
+  local_args_info.sweep_given = 0;
   
   if (check_required)
     {
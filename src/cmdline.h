@@ -98,6 +98,77 @@ struct gengetopt_args_info
   char * log_file_arg;	/**< @brief Log file name.  */
   char * log_file_orig;	/**< @brief Log file name original value given at command line.  */
   const char *log_file_help; /**< @brief Log file name help description.  */
+  double superinfect_arg;	/**< @brief Time at which further phage infect the cell.  */
+  char * superinfect_orig;	/**< @brief Time at which further phage infect the cell original value given at command line.  */
+  const char *superinfect_help; /**< @brief Time at which further phage infect the cell help description.  */
+  int superinfect_moi_arg;	/**< @brief Number of phage added by --superinfect (default='1').  */
+  char * superinfect_moi_orig;	/**< @brief Number of phage added by --superinfect original value given at command line.  */
+  const char *superinfect_moi_help; /**< @brief Number of phage added by --superinfect help description.  */
+  int continuous_growth_flag;	/**< @brief grow the cell volume continuously between divisions (default=off).  */
+  const char *continuous_growth_help; /**< @brief grow the cell volume continuously between divisions help description.  */
+  int lineage_arg;	/**< @brief Follow both daughters for this many generations (at most 20: n generations run 2^n cells, each with its own output file).  */
+  char * lineage_orig;	/**< @brief Follow both daughters for this many generations (at most 20: n generations run 2^n cells, each with its own output file) original value given at command line.  */
+  const char *lineage_help; /**< @brief Follow both daughters for this many generations (at most 20: n generations run 2^n cells, each with its own output file) help description.  */
+  int trajectory_arg;	/**< @brief Index of this trajectory among runs with the same seed (default='0').  */
+  char * trajectory_orig;	/**< @brief Index of this trajectory among runs with the same seed original value given at command line.  */
+  const char *trajectory_help; /**< @brief Index of this trajectory among runs with the same seed help description.  */
+  int ensemble_arg;	/**< @brief Run this many trajectories from one parse, to output-file.N.  */
+  char * ensemble_orig;	/**< @brief Run this many trajectories from one parse, to output-file.N original value given at command line.  */
+  const char *ensemble_help; /**< @brief Run this many trajectories from one parse, to output-file.N help description.  */
+  int threads_arg;	/**< @brief Threads for --ensemble and --worker, processes for --fork-server and cells running at once for --lineage (0 = one per processor) (default='0').  */
+  char * threads_orig;	/**< @brief Threads for --ensemble and --worker, processes for --fork-server and cells running at once for --lineage (0 = one per processor) original value given at command line.  */
+  const char *threads_help; /**< @brief Threads for --ensemble and --worker, processes for --fork-server and cells running at once for --lineage (0 = one per processor) help description.  */
+  char ** sweep_arg;	/**< @brief Sweep axis: volume|growth|moi VALUES, rate kN VALUES, init NAME VALUES or param NAME VALUES.  */
+  char ** sweep_orig;	/**< @brief Sweep axis: volume|growth|moi VALUES, rate kN VALUES, init NAME VALUES or param NAME VALUES original value given at command line.  */
+  int sweep_min; /**< @brief Sweep axis: volume|growth|moi VALUES, rate kN VALUES, init NAME VALUES or param NAME VALUES's minimum occurreces */
+  int sweep_max; /**< @brief Sweep axis: volume|growth|moi VALUES, rate kN VALUES, init NAME VALUES or param NAME VALUES's maximum occurreces */
+  const char *sweep_help; /**< @brief Sweep axis: volume|growth|moi VALUES, rate kN VALUES, init NAME VALUES or param NAME VALUES help description.  */
+  int sweep_list_flag;	/**< @brief Take the sweep axes together as a list of points, not as a grid (default=off).  */
+  const char *sweep_list_help; /**< @brief Take the sweep axes together as a list of points, not as a grid help description.  */
+  char * fork_server_arg;	/**< @brief Read run specs from this pipe or Unix socket (- for stdin) and fork a process for each.  */
+  char * fork_server_orig;	/**< @brief Read run specs from this pipe or Unix socket (- for stdin) and fork a process for each original value given at command line.  */
+  const char *fork_server_help; /**< @brief Read run specs from this pipe or Unix socket (- for stdin) and fork a process for each help description.  */
+  char * coordinator_arg;	/**< @brief Hand out the run specs read from stdin to workers connecting at [HOST:]PORT.  */
+  char * coordinator_orig;	/**< @brief Hand out the run specs read from stdin to workers connecting at [HOST:]PORT original value given at command line.  */
+  const char *coordinator_help; /**< @brief Hand out the run specs read from stdin to workers connecting at [HOST:]PORT help description.  */
+  char * worker_arg;	/**< @brief Make runs for the coordinator at HOST:PORT.  */
+  char * worker_orig;	/**< @brief Make runs for the coordinator at HOST:PORT original value given at command line.  */
+  const char *worker_help; /**< @brief Make runs for the coordinator at HOST:PORT help description.  */
+  char ** stop_arg;	/**< @brief End the run with fate FATE when QUANTITY>X or <X (FATE:QUANTITY>X), QUANTITY a species NAME, NAME/V, int(NAME), int(NAME/V) or time.  */
+  char ** stop_orig;	/**< @brief End the run with fate FATE when QUANTITY>X or <X (FATE:QUANTITY>X), QUANTITY a species NAME, NAME/V, int(NAME), int(NAME/V) or time original value given at command line.  */
+  int stop_min; /**< @brief End the run with fate FATE when QUANTITY>X or <X (FATE:QUANTITY>X), QUANTITY a species NAME, NAME/V, int(NAME), int(NAME/V) or time's minimum occurreces */
+  int stop_max; /**< @brief End the run with fate FATE when QUANTITY>X or <X (FATE:QUANTITY>X), QUANTITY a species NAME, NAME/V, int(NAME), int(NAME/V) or time's maximum occurreces */
+  const char *stop_help; /**< @brief End the run with fate FATE when QUANTITY>X or <X (FATE:QUANTITY>X), QUANTITY a species NAME, NAME/V, int(NAME), int(NAME/V) or time help description.  */
+  char * target_arg;	/**< @brief Run the --ensemble only until this statistic is known to --half-width: fate:FATE, NAME@T or NAME/V@T.  */
+  char * target_orig;	/**< @brief Run the --ensemble only until this statistic is known to --half-width: fate:FATE, NAME@T or NAME/V@T original value given at command line.  */
+  const char *target_help; /**< @brief Run the --ensemble only until this statistic is known to --half-width: fate:FATE, NAME@T or NAME/V@T help description.  */
+  double half_width_arg;	/**< @brief Half width of the 95% confidence interval of --target (default='0').  */
+  char * half_width_orig;	/**< @brief Half width of the 95% confidence interval of --target original value given at command line.  */
+  const char *half_width_help; /**< @brief Half width of the 95% confidence interval of --target help description.  */
+  int stats_flag;	/**< @brief Take statistics of the columns across the --ensemble, written to files output-file.STAT (default=off).  */
+  const char *stats_help; /**< @brief Take statistics of the columns across the --ensemble, written to files output-file.STAT help description.  */
+  int stats_only_flag;	/**< @brief With --stats, write no file for each trajectory (default=off).  */
+  const char *stats_only_help; /**< @brief With --stats, write no file for each trajectory help description.  */
+  char * stats_quantiles_arg;	/**< @brief Quantiles estimated by --stats (default='0.05,0.5,0.95').  */
+  char * stats_quantiles_orig;	/**< @brief Quantiles estimated by --stats original value given at command line.  */
+  const char *stats_quantiles_help; /**< @brief Quantiles estimated by --stats help description.  */
+  int stats_bins_arg;	/**< @brief Bins of the histograms of --stats, from 0, doubling in width as values outgrow them (none if 0) (default='0').  */
+  char * stats_bins_orig;	/**< @brief Bins of the histograms of --stats, from 0, doubling in width as values outgrow them (none if 0) original value given at command line.  */
+  const char *stats_bins_help; /**< @brief Bins of the histograms of --stats, from 0, doubling in width as values outgrow them (none if 0) help description.  */
+  char * output_format_arg;	/**< @brief Write the output as text, binary records that can be mapped into memory, or compressed deltas (default='text').  */
+  char * output_format_orig;	/**< @brief Write the output as text, binary records that can be mapped into memory, or compressed deltas original value given at command line.  */
+  const char *output_format_help; /**< @brief Write the output as text, binary records that can be mapped into memory, or compressed deltas help description.  */
+  int flush_arg;	/**< @brief Flush the output every this many rows, at the end only if 0, or as the format does if -1: every row for text, at the end for binary (default='-1').  */
+  char * flush_orig;	/**< @brief Flush the output every this many rows, at the end only if 0, or as the format does if -1: every row for text, at the end for binary original value given at command line.  */
+  const char *flush_help; /**< @brief Flush the output every this many rows, at the end only if 0, or as the format does if -1: every row for text, at the end for binary help description.  */
+  int writer_flag;	/**< @brief Format and write the output on a thread of its own, fed the rows of every run through a ring for each thread (default=off).  */
+  const char *writer_help; /**< @brief Format and write the output on a thread of its own, fed the rows of every run through a ring for each thread help description.  */
+  int writer_rows_arg;	/**< @brief Rows each thread may queue for --writer before it waits (default='1024').  */
+  char * writer_rows_orig;	/**< @brief Rows each thread may queue for --writer before it waits original value given at command line.  */
+  const char *writer_rows_help; /**< @brief Rows each thread may queue for --writer before it waits help description.  */
+  int keyframe_arg;	/**< @brief Rows between the keyframes of --output-format=delta (default='64').  */
+  char * keyframe_orig;	/**< @brief Rows between the keyframes of --output-format=delta original value given at command line.  */
+  const char *keyframe_help; /**< @brief Rows between the keyframes of --output-format=delta help description.  */
   
   int version_given ;	/**< @brief Whether version was given.  */
   int help_given ;	/**< @brief Whether help was given.  */
@@ -122,6 +193,30 @@ struct gengetopt_args_info
   int seed_given ;	/**< @brief Whether seed was given.  */
   int output_file_given ;	/**< @brief Whether output-file was given.  */
   int log_file_given ;	/**< @brief Whether log-file was given.  */
+  int superinfect_given ;	/**< @brief Whether superinfect was given.  */
+  int superinfect_moi_given ;	/**< @brief Whether superinfect-moi was given.  */
+  int continuous_growth_given ;	/**< @brief Whether continuous-growth was given.  */
+  int lineage_given ;	/**< @brief Whether lineage was given.  */
+  int trajectory_given ;	/**< @brief Whether trajectory was given.  */
+  int ensemble_given ;	/**< @brief Whether ensemble was given.  */
+  int threads_given ;	/**< @brief Whether threads was given.  */
+  unsigned int sweep_given ;	/**< @brief Whether sweep was given.  */
+  int sweep_list_given ;	/**< @brief Whether sweep-list was given.  */
+  int fork_server_given ;	/**< @brief Whether fork-server was given.  */
+  int coordinator_given ;	/**< @brief Whether coordinator was given.  */
+  int worker_given ;	/**< @brief Whether worker was given.  */
+  unsigned int stop_given ;	/**< @brief Whether stop was given.  */
+  int target_given ;	/**< @brief Whether target was given.  */
+  int half_width_given ;	/**< @brief Whether half-width was given.  */
+  int stats_given ;	/**< @brief Whether stats was given.  */
+  int stats_only_given ;	/**< @brief Whether stats-only was given.  */
+  int stats_quantiles_given ;	/**< @brief Whether stats-quantiles was given.  */
+  int stats_bins_given ;	/**< @brief Whether stats-bins was given.  */
+  int output_format_given ;	/**< @brief Whether output-format was given.  */
+  int flush_given ;	/**< @brief Whether flush was given.  */
+  int writer_given ;	/**< @brief Whether writer was given.  */
+  int writer_rows_given ;	/**< @brief Whether writer-rows was given.  */
+  int keyframe_given ;	/**< @brief Whether keyframe was given.  */
 
   char **inputs ; /**< @brief unamed options (options without names) */
   unsigned inputs_num ; /**< @brief unamed options number */